@@ -11,8 +11,14 @@
 #include <vnx/File.h>
 #include <vnx/ThreadPool.h>
 
+#include <map>
+#include <list>
+#include <vector>
+#include <memory>
+#include <atomic>
 #include <fstream>
 #include <mutex>
+#include <condition_variable>
 
 #ifdef _MSC_VER
 #include <mmx_db_export.h>
@@ -83,9 +89,162 @@ struct db_val_t {
 	}
 };
 
+/*
+ * Non-owning reference to a key or value, used for lookups and inside the memtable.
+ * The referenced memory must outlive the view.
+ */
+struct db_val_view {
+	const uint8_t* data = nullptr;
+	uint32_t size = 0;
+
+	db_val_view() = default;
+	db_val_view(const void* data, const uint32_t size) : data((const uint8_t*)data), size(size) {}
+	db_val_view(const db_val_t& value) : data(value.data), size(value.size) {}
+	db_val_view(const std::vector<uint8_t>& value) : data(value.data()), size(value.size()) {}
+	db_val_view(const std::string& value) : data((const uint8_t*)value.data()), size(value.size()) {}
+
+	bool operator==(const db_val_view& other) const {
+		if(other.size == size) {
+			return ::memcmp(other.data, data, size) == 0;
+		}
+		return false;
+	}
+	bool operator!=(const db_val_view& other) const {
+		return !(*this == other);
+	}
+
+	template<typename T>
+	T to() const {
+		if(size != sizeof(T)) {
+			throw std::logic_error("data size mismatch");
+		}
+		T out;
+		::memcpy(&out, data, sizeof(T));
+		return out;
+	}
+	std::string to_string() const {
+		return std::string((const char*)data, size);
+	}
+};
+
+/*
+ * Bump allocator for the memtable, memory is only released via clear().
+ */
+class db_arena_t {
+public:
+	db_arena_t(const size_t slab_size = 1024 * 1024) : slab_size(slab_size) {}
+
+	db_arena_t(const db_arena_t&) = delete;
+	db_arena_t& operator=(const db_arena_t&) = delete;
+
+	void* allocate(const size_t size, const size_t align = alignof(std::max_align_t))
+	{
+		auto offset = (slab_offset + align - 1) & ~(align - 1);
+		if(!num_used || offset + size > slabs[num_used - 1].second) {
+			if(num_used >= slabs.size() || slabs[num_used].second < size) {
+				const auto new_size = std::max(size, slab_size);
+				slabs.emplace(slabs.begin() + num_used, std::unique_ptr<uint8_t[]>(new uint8_t[new_size]), new_size);
+			}
+			num_used++;
+			offset = 0;
+		}
+		slab_offset = offset + size;
+		total_size += size;
+		return slabs[num_used - 1].first.get() + offset;
+	}
+
+	db_val_view copy(const db_val_view& value)
+	{
+		auto* data = (uint8_t*)allocate(value.size, 1);
+		::memcpy(data, value.data, value.size);
+		return db_val_view(data, value.size);
+	}
+
+	// keeps regular sized slabs for re-use
+	void clear()
+	{
+		for(auto iter = slabs.begin(); iter != slabs.end();) {
+			if(iter->second > slab_size) {
+				iter = slabs.erase(iter);
+			} else {
+				iter++;
+			}
+		}
+		num_used = 0;
+		slab_offset = 0;
+		total_size = 0;
+	}
+
+	size_t get_size() const {
+		return total_size;
+	}
+
+private:
+	const size_t slab_size;
+	size_t num_used = 0;
+	size_t slab_offset = 0;
+	size_t total_size = 0;
+	std::vector<std::pair<std::unique_ptr<uint8_t[]>, size_t>> slabs;
+
+};
+
+template<typename T>
+struct db_arena_allocator_t {
+	typedef T value_type;
+
+	db_arena_t* arena = nullptr;
+
+	db_arena_allocator_t(db_arena_t* arena) : arena(arena) {}
+
+	template<typename U>
+	db_arena_allocator_t(const db_arena_allocator_t<U>& other) : arena(other.arena) {}
+
+	T* allocate(const size_t n) {
+		return (T*)arena->allocate(n * sizeof(T), alignof(T));
+	}
+	void deallocate(T* ptr, const size_t n) {}
+
+	template<typename U>
+	bool operator==(const db_arena_allocator_t<U>& other) const {
+		return arena == other.arena;
+	}
+	template<typename U>
+	bool operator!=(const db_arena_allocator_t<U>& other) const {
+		return arena != other.arena;
+	}
+};
+
+struct db_codec_t;
+
 class Table {
+public:
+	enum class compression_t : uint32_t {
+		NONE = 0,
+		ZSTD = 1,
+	};
+
 protected:
+	/*
+	 * Blocked Bloom filter, each key maps to a single 512-bit block (one cache line).
+	 */
+	struct bloom_filter_t {
+		uint32_t num_hashes = 0;
+		std::vector<uint64_t> data;
+
+		void init(const size_t num_keys, const size_t bits_per_key);
+		void add(const uint64_t hash);
+		bool contains(const uint64_t hash) const;		// true when empty
+	};
+
+	struct chunk_t {
+		int64_t offset = 0;				// logical offset of first entry
+		int64_t file_offset = 0;		// offset of compressed data in file
+		uint32_t size = 0;				// compressed size
+		uint32_t raw_size = 0;
+	};
+
 	struct block_t {
+		uint64_t uid = 0;				// unique in process, for caching
 		uint32_t level = 0;
 		uint32_t min_version = 0;
 		uint32_t max_version = 0;
@@ -93,7 +252,95 @@ protected:
 		int64_t index_offset = 0;
 		vnx::File file;
 		std::string name;
-		std::vector<int64_t> index;
+		std::vector<int64_t> index;			// empty when mapped
+		bloom_filter_t bloom;
+
+		const uint8_t* map_data = nullptr;		// whole file, read-only
+		const uint8_t* map_index = nullptr;		// index inside map_data
+		uint64_t map_size = 0;
+		uint64_t map_index_size = 0;
+
+		std::atomic_bool remove_on_close {false};		// set when replaced by compaction
+
+		// for compressed blocks: index contains logical offsets into the concatenated chunks
+		compression_t codec = compression_t::NONE;
+		uint32_t dict_id = 0;
+		int64_t data_end = 0;						// logical end of entries
+		std::vector<chunk_t> chunks;
+		std::shared_ptr<const db_codec_t> codec_impl;
+
+		block_t();
+		block_t(const block_t&) = delete;
+		block_t& operator=(const block_t&) = delete;
+
+		~block_t();
+
+		size_t index_size() const {
+			return map_index ? map_index_size : index.size();
+		}
+
+		int64_t get_index(const size_t pos) const {
+			if(map_index) {
+				int64_t offset = 0;
+				::memcpy(&offset, map_index + pos * 8, 8);
+				return offset;
+			}
+			return index[pos];
+		}
+
+		// maps finished block into memory (no-op if not supported)
+		void map();
+		void unmap();
+
+		// returns view into mapping, chunk cache, or into buffer if not mapped
+		db_val_view read_key_at(const int64_t offset, uint32_t& version, std::vector<uint8_t>& buffer) const;
+		db_val_view read_value_at(const int64_t offset, const uint32_t key_size, std::vector<uint8_t>& buffer) const;
+
+		// decompresses chunk, handle is used instead of file if given
+		void read_chunk(const size_t index, std::vector<uint8_t>& out, FILE* handle = nullptr) const;
+
+		// returns decompressed chunk from thread local cache
+		const std::vector<uint8_t>& get_chunk(const size_t index) const;
+
+		// returns decompressed chunk and relative offset of entry
+		const uint8_t* find_entry(const int64_t offset, size_t& avail) const;
+	};
+
+	// writes entries of a new block, compressed or not
+	class block_writer_t {
+	public:
+		block_writer_t(std::shared_ptr<block_t> block, std::shared_ptr<const db_codec_t> codec, const size_t chunk_size);
+
+		int64_t get_pos() const;
+
+		void write(uint32_t version, const db_val_view& key, const db_val_view& value);
+
+		void finish();
+
+	private:
+		void write_chunk();
+
+		std::shared_ptr<block_t> block;
+		std::shared_ptr<const db_codec_t> codec;
+		const size_t chunk_size;
+		int64_t chunk_offset = 0;
+		std::vector<uint8_t> chunk;
+		std::vector<uint8_t> buffer;
+	};
+
+	// reads all entries of a block in order
+	class block_reader_t {
+	public:
+		block_reader_t(std::shared_ptr<block_t> block, std::shared_ptr<vnx::File> file = nullptr);
+
+		void read(uint32_t& version, std::shared_ptr<db_val_t>& key, std::shared_ptr<db_val_t>& value);
+
+	private:
+		std::shared_ptr<block_t> block;
+		std::shared_ptr<vnx::File> file;
+		size_t chunk_index = 0;
+		size_t chunk_pos = 0;
+		std::vector<uint8_t> chunk;
 	};
 
 	struct key_compare_t {
@@ -103,6 +350,9 @@ protected:
 		bool operator()(const std::shared_ptr<db_val_t>& lhs, const std::shared_ptr<db_val_t>& rhs) const {
 			return table->options.comparator(*lhs, *rhs) < 0;
 		}
+		bool operator()(const db_val_view& lhs, const db_val_view& rhs) const {
+			return table->options.comparator(lhs, rhs) < 0;
+		}
 	};
 
 	struct mem_compare_t {
@@ -116,14 +366,49 @@ protected:
 			}
 			return res < 0;
 		}
+		bool operator()(const std::pair<db_val_view, uint32_t>& lhs, const std::pair<db_val_view, uint32_t>& rhs) const {
+			const auto res = table->options.comparator(lhs.first, rhs.first);
+			if(res == 0) {
+				return lhs.second > rhs.second;
+			}
+			return res < 0;
+		}
 	};
 
+	typedef std::list<std::shared_ptr<block_t>> block_list_t;
+
+	typedef std::map<db_val_view, std::pair<db_val_view, uint32_t>, key_compare_t,
+			db_arena_allocator_t<std::pair<const db_val_view, std::pair<db_val_view, uint32_t>>>> mem_index_t;
+
+	typedef std::map<std::pair<db_val_view, uint32_t>, db_val_view, mem_compare_t,
+			db_arena_allocator_t<std::pair<const std::pair<db_val_view, uint32_t>, db_val_view>>> mem_block_t;
+
 public:
 	struct options_t {
 		size_t level_factor = 4;
 		size_t max_block_size = 4 * 1024 * 1024;
 		size_t force_flush_threshold = 100000;
-		std::function<int(const db_val_t&, const db_val_t&)> comparator = default_comparator;
+		size_t bloom_bits_per_key = 10;			// 0 = disable Bloom filter for new blocks
+		bool use_mmap = true;					// read finished blocks via memory mapping
+		bool background_compaction = true;		// rewrite levels in background threads
+		size_t compaction_rate_limit = 0;		// max bytes / sec written by background compaction (0 = unlimited)
+		compression_t compression = compression_t::NONE;	// for new blocks (ignored if not supported)
+		int compression_level = 3;
+		size_t compression_chunk_size = 16 * 1024;		// uncompressed size per chunk
+		size_t dictionary_size = 64 * 1024;			// 0 = no dictionary
+		std::function<int(const db_val_view&, const db_val_view&)> comparator = default_comparator;
+	};
+
+	struct compaction_stats_t {
+		bool is_running = false;
+		uint32_t max_level = 0;
+		uint64_t num_rewrites = 0;
+		uint64_t num_aborted = 0;
+		uint64_t num_entries = 0;		// total entries written
+		uint64_t num_bytes = 0;			// total bytes written
+		int64_t total_time_ms = 0;
+		int64_t max_time_ms = 0;
+		int64_t last_time_ms = 0;
 	};
 
 	const options_t options;
@@ -131,10 +416,27 @@ public:
 
 	Table(const std::string& file_path, const options_t& options = default_options);
 
+	~Table();
+
+	Table(const Table&) = delete;
+	Table& operator=(const Table&) = delete;
+
 	void insert(std::shared_ptr<db_val_t> key, std::shared_ptr<db_val_t> value);
 
+	// key and value are copied, no references are kept
+	void insert(const db_val_view& key, const db_val_view& value);
+
 	std::shared_ptr<db_val_t> find(std::shared_ptr<db_val_t> key, const uint32_t max_version = -1) const;
 
+	// allocation free lookup (when value has enough capacity)
+	bool find(const db_val_view& key, std::vector<uint8_t>& value, const uint32_t max_version = -1) const;
+
+	// batched lookup, keys are sorted internally to share one pass per block, result[i] = nullptr if keys[i] not found
+	std::vector<std::shared_ptr<db_val_t>> find_many(const std::vector<std::shared_ptr<db_val_t>>& keys, const uint32_t max_version = -1) const;
+
+	// false if key is definitely not in any block on disk (checks Bloom filters only)
+	bool bloom_contains(const db_val_view& key) const;
+
 	bool commit(const uint32_t new_version, const bool auto_flush = true);
 
 	void revert(const uint32_t new_version);
@@ -147,6 +449,11 @@ public:
 		return curr_version;
 	}
 
+	// waits for background compaction to finish
+	void wait_compaction();
+
+	compaction_stats_t get_compaction_stats() const;
+
 	class Iterator {
 	public:
 		Iterator() = default;
@@ -172,7 +479,7 @@ public:
 			size_t pos = -1;
 			std::shared_ptr<const block_t> block;
 			std::shared_ptr<db_val_t> value;
-			std::map<std::shared_ptr<db_val_t>, std::pair<std::shared_ptr<db_val_t>, uint32_t>, key_compare_t>::const_iterator iter;
+			mem_index_t::const_iterator iter;
 		};
 
 		struct compare_t {
@@ -182,7 +489,7 @@ public:
 		};
 
 		void seek(std::shared_ptr<db_val_t> key, const int mode);
-		void seek(const std::list<std::shared_ptr<block_t>>& blocks, std::shared_ptr<db_val_t> key, const int mode);
+		void seek(const block_list_t& blocks, std::shared_ptr<db_val_t> key, const int mode);
 		std::map<std::pair<std::shared_ptr<db_val_t>, uint32_t>, pointer_t, key_compare_t>::const_iterator current() const;
 
 		int direction = 0;
@@ -192,7 +499,7 @@ public:
 	};
 
 	MMX_DB_EXPORT
-	static const std::function<int(const db_val_t&, const db_val_t&)> default_comparator;
+	static const std::function<int(const db_val_view&, const db_val_view&)> default_comparator;
 
 	MMX_DB_EXPORT
 	static const options_t default_options;
@@ -201,22 +508,50 @@ private:
 	static constexpr uint32_t entry_overhead = 20;
 	static constexpr uint32_t block_header_size = 30;
 
-	void insert_entry(uint32_t version, std::shared_ptr<db_val_t> key, std::shared_ptr<db_val_t> value);
+	void insert_entry(uint32_t version, const db_val_view& key, const db_val_view& value);
 
 	std::shared_ptr<block_t> read_block(const std::string& name) const;
 
-	std::shared_ptr<db_val_t> find(std::shared_ptr<const block_t> block, std::shared_ptr<db_val_t> key, const uint32_t max_version = -1) const;
+	bool find_mem(const db_val_view& key, std::vector<uint8_t>& value, const uint32_t max_version) const;
+
+	bool find(std::shared_ptr<const block_t> block, const db_val_view& key, std::vector<uint8_t>& value, const uint32_t max_version = -1) const;
+
+	// pos and version as returned by lower_bound() with is_match = true
+	bool find_at(std::shared_ptr<const block_t> block, const size_t pos, const db_val_view& key, uint32_t version,
+			std::vector<uint8_t>& value, std::vector<uint8_t>& buffer, const uint32_t max_version) const;
 
 	size_t lower_bound(std::shared_ptr<const block_t> block, uint32_t& version, std::shared_ptr<db_val_t>& key, bool& is_match) const;
 
-	std::shared_ptr<block_t> rewrite(std::list<std::shared_ptr<block_t>> blocks, const uint32_t level) const;
+	// begin = lower bound of search, must not be greater than result
+	size_t lower_bound(std::shared_ptr<const block_t> block, const db_val_view& key, uint32_t& version, bool& is_match,
+			std::vector<uint8_t>& buffer, const size_t begin = 0) const;
+
+	std::shared_ptr<block_t> rewrite(const block_list_t& blocks, const uint32_t level, const bool background) const;
+
+	void check_rewrite();			// requires lock on mutex
+
+	void compact(const block_list_t& selected, const uint32_t level);
+
+	void finish_rewrite(const block_list_t& selected, std::shared_ptr<block_t> block, const int64_t time_begin);	// requires lock on mutex
+
+	bool apply_rewrite(const block_list_t& selected, std::shared_ptr<block_t> block);	// requires lock on mutex
 
-	void check_rewrite();
+	std::shared_ptr<const block_list_t> get_blocks() const;
+
+	void set_blocks(std::shared_ptr<const block_list_t> list);
 
 	void write_block_header(vnx::TypeOutput& out, std::shared_ptr<const block_t> block) const;
 
 	void write_block_index(vnx::TypeOutput& out, std::shared_ptr<const block_t> block) const;
 
+	void write_block_bloom(vnx::TypeOutput& out, std::shared_ptr<const block_t> block) const;
+
+	void write_block_chunks(vnx::TypeOutput& out, std::shared_ptr<const block_t> block) const;
+
+	std::shared_ptr<block_writer_t> create_writer(std::shared_ptr<block_t> block) const;
+
+	void train_dictionary();		// requires lock on mutex
+
 	std::shared_ptr<block_t> create_block(const uint32_t level, const std::string& name) const;
 
 	void finish_block(std::shared_ptr<block_t> block) const;
@@ -230,15 +565,25 @@ private:
 	uint64_t next_block_id = 0;
 
 	vnx::File write_log;
-	std::list<std::shared_ptr<block_t>> blocks;
+	std::shared_ptr<const block_list_t> blocks;		// copy-on-write, see get_blocks()
+
+	std::shared_ptr<const db_codec_t> codec;		// for new blocks, nullptr = no compression
+	std::map<uint32_t, std::shared_ptr<const db_codec_t>> codec_map;		// [dict_id => codec]
 
 	size_t mem_block_size = 0;
-	std::map<std::shared_ptr<db_val_t>, std::pair<std::shared_ptr<db_val_t>, uint32_t>, key_compare_t> mem_index;
-	std::map<std::pair<std::shared_ptr<db_val_t>, uint32_t>, std::shared_ptr<db_val_t>, mem_compare_t> mem_block;
+	db_arena_t mem_arena;			// needs to be destroyed after mem_index and mem_block
+	mem_index_t mem_index;			// latest version of each key
+	mem_block_t mem_block;			// all versions of each key
 
 	mutable std::mutex mutex;
 	mutable int64_t write_lock = 0;
 
+	bool is_closing = false;
+	bool revert_pending = false;
+	std::atomic_bool do_abort {false};
+	std::condition_variable compaction_signal;
+	compaction_stats_t compaction_stats;
+
 	std::ofstream debug_log;
 
 };
@@ -262,9 +607,9 @@ public:
 	uint32_t recover();
 
 	template<typename T>
-	void open_async(T& table, const std::string& path) {
-		threads.add_task([this, &table, path]() {
-			add(table.open(path));
+	void open_async(T& table, const std::string& path, const Table::options_t& options = Table::default_options) {
+		threads.add_task([this, &table, path, options]() {
+			add(table.open(path, options));
 		});
 	}
 
@@ -76,6 +76,7 @@ private:
 	std::shared_ptr<FarmerAsyncClient> farmer_async;
 	std::shared_ptr<NodeAsyncClient> node_async;
 	std::shared_ptr<vnx::ThreadPool> threads;
+	std::shared_ptr<vnx::ThreadPool> index_threads;			// for pos::Prover::load_y_index()
 	std::shared_ptr<const ChainParams> params;
 
 	std::unordered_set<hash_t> already_checked;
@@ -24,6 +24,9 @@
 #include <mmx/table.h>
 #include <mmx/multi_table.h>
 #include <mmx/balance_cache_t.h>
+#include <mmx/dag_scheduler_t.h>
+#include <mmx/vdf_verifier_t.h>
+#include <mmx/block_store_t.h>
 #include <mmx/farmed_block_info_t.hxx>
 #include <mmx/utils.h>
 
@@ -235,22 +238,14 @@ protected:
 	std::shared_ptr<vnx::Value> vnx_call_switch(std::shared_ptr<const vnx::Value> method, const vnx::request_id_t& request_id) override;
 
 private:
-	struct waitcond_t {
-		std::mutex mutex;
-		std::condition_variable signal;
-		bool do_wait = true;
-	};
-
 	struct execution_context_t {
 		bool do_profile = false;
 		bool do_trace = false;
 		uint32_t height = 0;
+		double conflict_ratio = 0;												// of optimistic execution, see Node::exec_conflict_ratio
 		std::shared_ptr<vm::StorageCache> storage;
 		std::unordered_map<addr_t, std::vector<hash_t>> mutate_map;				// [contract => TX ids]
 		std::unordered_map<hash_t, std::unordered_set<hash_t>> wait_map;		// [TX id => TX ids]
-		std::unordered_map<hash_t, std::shared_ptr<waitcond_t>> signal_map;		// [TX id => condition]
-		void wait(const hash_t& txid) const;
-		void signal(const hash_t& txid) const;
 		void setup_wait(const hash_t& txid, const addr_t& address);
 	};
 
@@ -293,6 +288,23 @@ private:
 		std::shared_ptr<const ProofOfSpace> proof;
 	};
 
+	struct sync_range_t {
+		bool is_failed = false;
+		uint32_t height = 0;						// first height
+		uint32_t num_pending = 0;
+		int64_t start_time_ms = 0;
+		std::string address;						// peer
+		std::vector<std::shared_ptr<const Block>> blocks;
+		std::map<uint32_t, std::vector<std::shared_ptr<const Block>>> checks;		// [height => blocks from min_sync_peers peers]
+	};
+
+	struct sync_peer_t {
+		bool is_busy = false;
+		uint32_t window = 0;						// heights per range
+		int64_t retry_time_ms = 0;					// no ranges before (after failure)
+		double blocks_per_sec = 0;					// measured throughput
+	};
+
 	void update();
 	void init_chain();
 	void trigger_update();
@@ -338,6 +350,14 @@ private:
 
 	void sync_result(const uint32_t& height, const std::vector<std::shared_ptr<const Block>>& blocks);
 
+	void sync_ranges();
+
+	void sync_range(const std::string& address, const uint32_t height, const uint32_t count);
+
+	void sync_range_result(std::shared_ptr<sync_range_t> range);
+
+	static bool is_header_only(std::shared_ptr<const Block> block);
+
 	void fetch_block(const hash_t& hash);
 
 	void fetch_result(const hash_t& hash, std::shared_ptr<const Block> block);
@@ -358,6 +378,11 @@ private:
 
 	void prepare_context(std::shared_ptr<execution_context_t> context, std::shared_ptr<const Transaction> tx) const;
 
+	// runs func(i) for each TX in parallel, in order of dependencies given by context->wait_map
+	dag_scheduler_t::stats_t execute_tx_list(
+			std::shared_ptr<const execution_context_t> context, const std::vector<hash_t>& tx_ids,
+			const std::function<void(const size_t)>& func) const;
+
 	void execute(	std::shared_ptr<const Transaction> tx,
 					std::shared_ptr<const execution_context_t> context,
 					std::shared_ptr<const operation::Execute> op,
@@ -381,6 +406,15 @@ private:
 	std::shared_ptr<const exec_result_t> validate(
 			std::shared_ptr<const Transaction> tx, std::shared_ptr<const execution_context_t> context) const;
 
+	// does not commit storage_cache, do_commit = true if it should be committed
+	std::shared_ptr<const exec_result_t> validate(
+			std::shared_ptr<const Transaction> tx, std::shared_ptr<const execution_context_t> context,
+			std::shared_ptr<vm::StorageCache> storage_cache, bool& do_commit) const;
+
+	// executes block transactions in parallel against block state, re-executes conflicting ones in order, returns conflict ratio
+	double execute_optimistic(std::shared_ptr<const Block> block, std::shared_ptr<const execution_context_t> context,
+			hash_t& failed_tx, std::exception_ptr& failed_ex) const;
+
 	void validate_diff_adjust(const uint64_t& block, const uint64_t& prev) const;
 
 	void commit(std::shared_ptr<const Block> block);
@@ -423,7 +457,8 @@ private:
 
 	std::shared_ptr<const BlockHeader> get_peak() const;
 
-	std::shared_ptr<const BlockHeader> get_block_ex(const hash_t& hash, bool full_block) const;
+	// height = hint for main chain lookup via header ring
+	std::shared_ptr<const BlockHeader> get_block_ex(const hash_t& hash, bool full_block, const vnx::optional<uint32_t>& height = nullptr) const;
 
 	std::shared_ptr<const BlockHeader> get_block_at_ex(const uint32_t& height, bool full_block) const;
 
@@ -466,11 +501,16 @@ private:
 
 	vnx::optional<addr_t> get_vdf_reward_winner(std::shared_ptr<const BlockHeader> block) const;
 
+	// throws if block data has been pruned
 	std::shared_ptr<const BlockHeader> read_block(
-			vnx::File& file, bool full_block = true,
+			const int64_t offset, bool full_block = true,
 			std::vector<int64_t>* tx_offsets = nullptr) const;
 
-	void write_block(std::shared_ptr<const Block> block, const bool is_main = true);
+	// returns offset in block_store
+	int64_t write_block(std::shared_ptr<const Block> block, const bool is_main = true);
+
+	// makes header ring match height_map up to height
+	void sync_header_ring(const uint32_t height);
 
 	template<typename T>
 	std::shared_ptr<const T> get_contract_as(const addr_t& address, uint64_t* read_cost = nullptr, const uint64_t gas_limit = 0) const;
@@ -538,7 +578,8 @@ private:
 	uint32_t min_pool_fee_ratio = 0;
 	uint64_t mmx_address_count = 0;
 
-	std::shared_ptr<vnx::File> blocks;
+	std::shared_ptr<block_store_t> block_store;
+	uint32_t block_prune_depth = 0;												// 0 = keep all blocks (config: <name>.block_prune_depth)
 	std::shared_ptr<vm::StorageDB> storage;
 
 	hash_table<hash_t, block_index_t> block_index;								// [hash => index] (no revert)
@@ -559,6 +600,11 @@ private:
 	double max_sync_pending = 0;
 	std::set<uint32_t> sync_pending;						// set of heights
 	vnx::optional<uint32_t> sync_peak;						// max height we can sync
+	uint32_t sync_range_min = 8;							// heights per range at first (config: <name>.sync_range_min)
+	uint32_t sync_range_max = 256;							// 0 = per-height sync only (config: <name>.sync_range_max)
+	int64_t sync_peers_time_ms = 0;
+	std::vector<peer_info_t> sync_peers;					// from Router::get_peer_info()
+	std::map<std::string, sync_peer_t> sync_peer_map;		// [address => range state]
 	std::unordered_set<hash_t> fetch_pending;				// block hash
 
 	std::vector<std::pair<std::shared_ptr<const ProofResponse>, int64_t>> proof_queue;		// [data, recv_time_ms]
@@ -586,6 +632,7 @@ private:
 	std::condition_variable vdf_signal;
 	std::vector<std::shared_ptr<OCL_VDF>> opencl_vdf;
 	std::shared_ptr<vnx::ThreadPool> vdf_threads;
+	std::shared_ptr<vdf_verifier_t> vdf_verifier;		// shared CPU pipeline for all pending proofs
 	bool opencl_vdf_enable = false;
 
 	std::mutex fetch_mutex;
@@ -593,6 +640,8 @@ private:
 	std::set<std::string> pending_fetch;
 	std::shared_ptr<vnx::ThreadPool> fetch_threads;
 
+	double exec_conflict_ratio = 0;							// of last applied block, updated by apply()
+
 	friend class vnx::addons::HttpInterface<Node>;
 
 };
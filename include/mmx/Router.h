@@ -167,6 +167,8 @@ private:
 
 	void on_transaction(uint64_t client, std::shared_ptr<const Transaction> tx);
 
+	void verify_signatures();
+
 	void on_recv_note(uint64_t client, std::shared_ptr<const ReceiveNote> note);
 
 	void recv_notify(const hash_t& msg_hash);
@@ -284,6 +286,9 @@ private:
 	std::shared_ptr<UPNP_Mapper> upnp_mapper;
 	std::shared_ptr<vnx::addons::HttpInterface<Router>> http;
 
+	std::shared_ptr<vnx::ThreadPool> verify_threads;
+	std::vector<std::shared_ptr<const Transaction>> verify_queue;		// gossip tx to pre-verify signatures
+
 	friend class vnx::addons::HttpInterface<Router>;
 
 };
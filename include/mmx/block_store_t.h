@@ -0,0 +1,141 @@
+/*
+ * block_store_t.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef INCLUDE_MMX_BLOCK_STORE_T_H_
+#define INCLUDE_MMX_BLOCK_STORE_T_H_
+
+#include <mmx/Block.hxx>
+#include <mmx/BlockHeader.hxx>
+#include <mmx/Transaction.hxx>
+
+#include <vnx/File.h>
+
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <shared_mutex>
+
+
+namespace mmx {
+
+/*
+ * Block storage split into segment files, each holding segment_size heights.
+ * Every block is stored as [header, tx..., nullptr], same as the old single blocks.dat.
+ *
+ * Offsets are (segment << segment_shift) | position, segment 0 is the legacy file,
+ * so existing block_index_t / tx_index_t entries stay valid.
+ *
+ * The main chain [height => hash, offset] of the last ring_size heights is kept in a
+ * memory mapped ring (fixed size entries), for header queries by height without DB lookups.
+ *
+ * Pruned segments are tracked by offset (see is_pruned()), so index entries pointing
+ * into them can be refused explicitly instead of reading as missing.
+ */
+class block_store_t {
+public:
+	static constexpr int segment_shift = 40;
+
+	block_store_t(	const std::string& root_path, const std::string& legacy_file,
+					const uint32_t segment_size = 100000, const uint32_t ring_size = 1 << 20);
+
+	block_store_t(const block_store_t&) = delete;
+	block_store_t& operator=(const block_store_t&) = delete;
+
+	~block_store_t();
+
+	// returns offset of block, tx_offsets = offset of every tx
+	int64_t write(std::shared_ptr<const Block> block, std::vector<int64_t>* tx_offsets = nullptr);
+
+	// THREAD SAFE, returns nullptr if segment is missing, throws if pruned or data is corrupted
+	std::shared_ptr<const BlockHeader> read(const int64_t offset, const bool full_block, std::vector<int64_t>* tx_offsets = nullptr) const;
+
+	// THREAD SAFE, same as read()
+	std::shared_ptr<const Transaction> read_tx(const int64_t offset) const;
+
+	// THREAD SAFE, true if offset points into a segment that was removed by prune()
+	bool is_pruned(const int64_t offset) const;
+
+	// ring access is guarded by ring_mutex, find_main() can be called from any thread
+	void set_main(const uint32_t height, const hash_t& hash, const int64_t offset);
+
+	bool find_main(const uint32_t height, hash_t& hash, int64_t& offset) const;
+
+	void erase_main(const uint32_t height);
+
+	// invalidates all heights >= height, full_scan = true to not assume a contiguous chain (after a crash)
+	void revert_main(const uint32_t height, const bool full_scan = false);
+
+	// removes all segments that only contain heights < height (legacy file is kept)
+	size_t prune(const uint32_t height);
+
+	// first segment that has not been pruned
+	uint32_t get_prune_segment() const {
+		return prune_end;
+	}
+
+	// removes all blocks and the ring
+	void clear();
+
+	void close();
+
+	uint32_t get_segment_size() const {
+		return segment_size;
+	}
+
+	uint32_t get_ring_size() const {
+		return ring_size;
+	}
+
+private:
+	struct segment_t {
+		vnx::File file;
+	};
+
+	struct ring_entry_t {
+		uint32_t height = 0;
+		uint32_t is_valid = 0;
+		int64_t offset = 0;
+		uint8_t hash[32] = {};
+	};
+
+	std::string get_segment_path(const uint32_t index) const;
+
+	std::shared_ptr<segment_t> get_segment(const uint32_t index, const bool create) const;
+
+	std::string get_prune_path() const;
+
+	void read_prune_end();
+
+	void write_prune_end();
+
+	void map_ring();
+
+	void unmap_ring();
+
+private:
+	const std::string root_path;
+	const std::string legacy_file;
+	const uint32_t segment_size;
+	const uint32_t ring_size;
+
+	mutable std::mutex mutex;
+	mutable std::map<uint32_t, std::shared_ptr<segment_t>> segments;
+
+	std::atomic<uint32_t> prune_end {1};		// segments < prune_end have been removed (persisted in prune_end.dat)
+
+	mutable std::shared_mutex ring_mutex;
+	ring_entry_t* ring = nullptr;
+	std::vector<ring_entry_t> ring_buf;			// when mmap is not available
+	int ring_fd = -1;
+
+};
+
+
+} // mmx
+
+#endif /* INCLUDE_MMX_BLOCK_STORE_T_H_ */
@@ -0,0 +1,87 @@
+/*
+ * dag_scheduler_t.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef INCLUDE_MMX_DAG_SCHEDULER_T_H_
+#define INCLUDE_MMX_DAG_SCHEDULER_T_H_
+
+#include <vnx/ThreadPool.h>
+
+#include <deque>
+#include <mutex>
+#include <vector>
+#include <functional>
+#include <exception>
+#include <condition_variable>
+
+
+namespace mmx {
+
+/*
+ * Runs a graph of dependent tasks on a thread pool.
+ * Only tasks whose dependencies have finished are dispatched, no worker blocks on a dependency.
+ * Each worker keeps a local queue of ready tasks (continuing its own chain first), idle workers steal from others.
+ */
+class dag_scheduler_t {
+public:
+	struct stats_t {
+		size_t num_tasks = 0;
+		size_t num_workers = 0;
+		size_t num_steals = 0;
+		size_t max_depth = 0;					// longest chain of dependent tasks
+		int64_t critical_path_us = 0;			// execution time along the slowest chain
+		int64_t total_time_us = 0;				// sum of all task execution times
+		int64_t wall_time_us = 0;
+
+		double get_parallelism() const {
+			return wall_time_us > 0 ? double(total_time_us) / wall_time_us : 0;
+		}
+	};
+
+	dag_scheduler_t() = default;
+	dag_scheduler_t(const dag_scheduler_t&) = delete;
+	dag_scheduler_t& operator=(const dag_scheduler_t&) = delete;
+
+	// returns task index
+	size_t add_task(const std::function<void()>& func);
+
+	// task will not start before prev has finished, requires prev < task
+	void add_depend(const size_t task, const size_t prev);
+
+	// blocks until all tasks have finished, re-throws first exception thrown by a task
+	stats_t run(vnx::ThreadPool& pool, const size_t num_workers);
+
+	size_t size() const {
+		return tasks.size();
+	}
+
+private:
+	struct task_t {
+		std::function<void()> func;
+		std::vector<size_t> next;
+		size_t num_pending = 0;
+		size_t depth = 0;
+		int64_t path_us = 0;
+	};
+
+	void worker(const size_t index);
+
+	bool pop_task(const size_t index, size_t& task);		// requires lock
+
+	std::mutex mutex;
+	std::condition_variable signal;
+	std::vector<task_t> tasks;
+	std::vector<std::deque<size_t>> queues;					// [worker => ready tasks]
+	std::exception_ptr error;
+	size_t num_done = 0;
+	size_t num_running = 0;
+	stats_t stats;
+
+};
+
+
+} // mmx
+
+#endif /* INCLUDE_MMX_DAG_SCHEDULER_T_H_ */
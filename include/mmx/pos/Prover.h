@@ -12,6 +12,8 @@
 #include <mmx/hash_t.hpp>
 #include <mmx/pos/config.h>
 
+#include <mutex>
+
 
 namespace mmx {
 namespace pos {
@@ -27,12 +29,34 @@ struct proof_data_t
 
 class Prover {
 public:
+	class file_t;
+
 	bool debug = false;
 
+	bool parallel_io = true;			// issue park reads of a proof level in parallel
+
 	int32_t initial_y_shift = -1024 * 24;
 
+	uint32_t max_y_index = 4096;		// max number of Y park index entries (16 KiB)
+
 	Prover(const std::string& file_path);
 
+	~Prover();
+
+	Prover(const Prover&) = delete;
+	Prover& operator=(const Prover&) = delete;
+
+	// limit for open plot files shared by all instances (default is half the descriptor limit)
+	static void set_max_open_files(const size_t count);
+
+	// stop the I/O thread pool shared by all instances, call before exit
+	static void shutdown();
+
+	// load Y park index from cache_file, or build it (and write cache_file if not empty)
+	void load_y_index(const std::string& cache_file = "");
+
+	bool have_y_index() const;
+
 	std::vector<proof_data_t> get_qualities(const hash_t& challenge, const int plot_filter) const;
 
 	proof_data_t get_full_proof(const uint64_t final_index) const;
@@ -69,11 +93,29 @@ public:
 		return header->ksize - header->xbits;
 	}
 
+private:
+	// first Y of every n-th Y park
+	struct y_index_t {
+		uint32_t stride = 0;
+		std::vector<uint32_t> first_y;
+	};
+
+	std::shared_ptr<const file_t> get_file() const;
+
+	std::shared_ptr<const y_index_t> get_y_index() const;
+
+	std::shared_ptr<const y_index_t> read_y_index(const std::string& cache_file) const;
+
+	void write_y_index(const std::string& cache_file, std::shared_ptr<const y_index_t> index) const;
+
 private:
 	const std::string file_path;
 
 	std::shared_ptr<const PlotHeader> header;
 
+	mutable std::mutex index_mutex;
+	std::shared_ptr<const y_index_t> y_index;
+
 };
 
 
@@ -26,6 +26,23 @@ void gen_mem_array(uint32_t* mem, const uint8_t* key, const uint32_t mem_size);
  */
 void calc_mem_hash(uint32_t* mem, uint8_t* hash, const int num_iter);
 
+/*
+ * gen_mem_array() + calc_mem_hash() for independent keys (mem_size = 1024)
+ * key = array of size 64 * num_keys
+ * hash = array of size 128 * num_keys
+ * Uses AVX-512 (16 lanes) or AVX2 (8 lanes) if available.
+ */
+void calc_mem_hash_batch(const uint8_t* key, uint8_t* hash, const uint32_t num_keys, const int num_iter);
+
+// kernels for calc_mem_hash_batch(), key and hash as above with 8 / 16 keys
+void mem_hash_avx2_x8(const uint8_t* key, uint8_t* hash, const int num_iter);
+void mem_hash_avx512_x16(const uint8_t* key, uint8_t* hash, const int num_iter);
+
+bool mem_hash_avx2_available();
+bool mem_hash_avx512_available();
+
+extern const uint32_t MEM_HASH_INIT[16];
+
 
 } // pos
 } // mmx
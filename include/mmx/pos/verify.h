@@ -10,26 +10,34 @@
 
 #include <mmx/hash_t.hpp>
 #include <mmx/pos/config.h>
+#include <vnx/ThreadPool.h>
 #include <vector>
 
 
 namespace mmx {
 namespace pos {
 
+struct compute_stats_t {
+	int64_t table_time_us[N_TABLE + 1] = {};		// [t] = table t (1 = mem hash, 2+ = sort + match)
+	uint64_t table_size[N_TABLE + 1] = {};
+	int64_t final_time_us = 0;						// final sort + X gather
+};
+
 hash_t calc_quality(const hash_t& challenge, const bytes_t<META_BYTES_OUT>& meta);
 
 bool check_post_filter(const hash_t& challenge, const bytes_t<META_BYTES_OUT>& meta, const int post_filter);
 
 std::vector<std::pair<uint32_t, bytes_t<META_BYTES_OUT>>>
 compute(const std::vector<uint32_t>& X_values, std::vector<uint32_t>* X_out,
-		const hash_t& id, const int ksize, const int xbits);
+		const hash_t& id, const int ksize, const int xbits, compute_stats_t* stats = nullptr);
 
 std::vector<std::pair<uint32_t, bytes_t<META_BYTES_OUT>>>
 compute_full(	const std::vector<uint32_t>& X_in,
 				const std::vector<uint32_t>& Y_in,
 				std::vector<std::array<uint32_t, N_META>>& M_in,
 				std::vector<uint32_t>* X_out,
-				const hash_t& id, const int ksize);
+				const hash_t& id, const int ksize,
+				vnx::ThreadPool* threads = nullptr, compute_stats_t* stats = nullptr);
 
 hash_t verify(	const std::vector<uint32_t>& X_values, const hash_t& challenge, const hash_t& id,
 				const int plot_filter, const int post_filter, const int ksize, const bool hard_fork);
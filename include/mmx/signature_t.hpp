@@ -14,6 +14,8 @@
 #include <mmx/secp256k1.hpp>
 
 #include <mutex>
+#include <tuple>
+#include <vector>
 
 
 namespace mmx {
@@ -36,6 +38,15 @@ public:
 
 	static signature_t sign(const skey_t& skey, const hash_t& hash);
 
+	// verify [hash, pubkey, signature] in parallel, results are cached for verify() later
+	static std::vector<bool> verify_many(const std::vector<std::tuple<hash_t, pubkey_t, signature_t>>& list);
+
+	// number of verify() calls answered from cache (since process start)
+	static uint64_t get_cache_hits();
+
+	// stop the thread pool used by verify_many(), call before exit
+	static void shutdown();
+
 };
 
 } // mmx
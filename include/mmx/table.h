@@ -45,10 +45,10 @@ public:
 		close();
 	}
 
-	std::shared_ptr<Table> open(const std::string& file_path)
+	std::shared_ptr<Table> open(const std::string& file_path, const Table::options_t& options = Table::default_options)
 	{
 		close();
-		return db = std::make_shared<Table>(file_path);
+		return db = std::make_shared<Table>(file_path, options);
 	}
 
 	void close() {
@@ -57,7 +57,7 @@ public:
 
 	void insert(const K& key, const V& value)
 	{
-		db->insert(write(key), write(value, value_type, value_code));
+		db->insert(*write(key), write(value, value_type, value_code));
 	}
 
 	bool count(const K& key, const uint32_t max_version = -1) const
@@ -68,14 +68,39 @@ public:
 
 	bool find(const K& key, V& value, const uint32_t max_version = -1) const
 	{
-		const auto entry = db->find(write(key), max_version);
-		if(entry) {
-			read(entry, value, value_type, value_code);
+		thread_local std::vector<uint8_t> key_buffer;
+		thread_local std::vector<uint8_t> buffer;
+
+		if(db->find(write_key(key, key_buffer), buffer, max_version)) {
+			read(db_val_view(buffer), value, value_type, value_code);
 			return true;
 		}
 		return false;
 	}
 
+	// returns [key, value] for each key found, in order of keys
+	size_t find_many(const std::vector<K>& keys, std::vector<std::pair<K, V>>& result, const uint32_t max_version = -1) const
+	{
+		result.clear();
+
+		std::vector<std::shared_ptr<db_val_t>> list;
+		list.reserve(keys.size());
+		for(const auto& key : keys) {
+			list.push_back(write(key));
+		}
+		const auto values = db->find_many(list, max_version);
+
+		for(size_t i = 0; i < keys.size(); ++i) {
+			if(const auto& value = values[i]) {
+				std::pair<K, V> tmp;
+				tmp.first = keys[i];
+				read(db_val_view(*value), tmp.second, value_type, value_code);
+				result.push_back(std::move(tmp));
+			}
+		}
+		return result.size();
+	}
+
 	bool find_first(V& value) const
 	{
 		K dummy;
@@ -348,14 +373,28 @@ protected:
 
 	virtual std::shared_ptr<db_val_t> write(const K& key) const = 0;
 
+	// same as write(key) but into a re-used buffer, returned view is valid until buffer is modified
+	virtual db_val_view write_key(const K& key, std::vector<uint8_t>& buffer) const
+	{
+		const auto out = write(key);
+		buffer.assign(out->data, out->data + out->size);
+		return db_val_view(buffer);
+	}
+
 	void read(std::shared_ptr<const db_val_t> slice, V& value, const vnx::TypeCode* type_code, const std::vector<uint16_t>& code) const
 	{
-		vnx::PointerInputStream stream(slice->data, slice->size);
+		read(db_val_view(*slice), value, type_code, code);
+	}
+
+	void read(const db_val_view& slice, V& value, const vnx::TypeCode* type_code, const std::vector<uint16_t>& code) const
+	{
+		vnx::PointerInputStream stream(slice.data, slice.size);
 		vnx::TypeInput in(&stream);
 		vnx::read(in, value, type_code, type_code ? nullptr : code.data());
 	}
 
-	std::shared_ptr<db_val_t> write(const V& value, const vnx::TypeCode* type_code, const std::vector<uint16_t>& code)
+	// returned view is valid until next call
+	db_val_view write(const V& value, const vnx::TypeCode* type_code, const std::vector<uint16_t>& code)
 	{
 		stream.out.reset();
 		stream.memory.clear();
@@ -365,9 +404,9 @@ protected:
 		if(stream.memory.get_size()) {
 			stream.out.flush();
 			stream.buffer = stream.memory;
-			return std::make_shared<db_val_t>(stream.buffer.data(), stream.buffer.size());
+			return db_val_view(stream.buffer.data(), stream.buffer.size());
 		}
-		return std::make_shared<db_val_t>(stream.out.get_buffer(), stream.out.get_buffer_pos());
+		return db_val_view(stream.out.get_buffer(), stream.out.get_buffer_pos());
 	}
 
 protected:
@@ -397,6 +436,11 @@ protected:
 		vnx::write_value(out->data, vnx::to_big_endian(key));
 		return out;
 	}
+	db_val_view write_key(const K& key, std::vector<uint8_t>& buffer) const override {
+		buffer.resize(sizeof(K));
+		vnx::write_value(buffer.data(), vnx::to_big_endian(key));
+		return db_val_view(buffer);
+	}
 };
 
 template<typename K, typename I, typename V>
@@ -418,6 +462,12 @@ protected:
 		vnx::write_value(out->data + sizeof(K), vnx::to_big_endian(key.second));
 		return out;
 	}
+	db_val_view write_key(const std::pair<K, I>& key, std::vector<uint8_t>& buffer) const override {
+		buffer.resize(sizeof(K) + sizeof(I));
+		vnx::write_value(buffer.data(), vnx::to_big_endian(key.first));
+		vnx::write_value(buffer.data() + sizeof(K), vnx::to_big_endian(key.second));
+		return db_val_view(buffer);
+	}
 };
 
 template<typename K, typename V>
@@ -437,6 +487,9 @@ protected:
 		::memcpy(out->data, key.data(), key.size());
 		return out;
 	}
+	db_val_view write_key(const K& key, std::vector<uint8_t>& buffer) const override {
+		return db_val_view(key.data(), key.size());		// no copy needed
+	}
 };
 
 template<typename K, typename H, typename V>
@@ -462,6 +515,14 @@ protected:
 		vnx::write_value(dst, vnx::to_big_endian(key.second)); dst += sizeof(H);
 		return out;
 	}
+	db_val_view write_key(const std::pair<K, H>& key, std::vector<uint8_t>& buffer) const override {
+		const auto& hash = key.first;
+		buffer.resize(hash.size() + sizeof(H));
+		auto* dst = buffer.data();
+		::memcpy(dst, hash.data(), hash.size()); dst += hash.size();
+		vnx::write_value(dst, vnx::to_big_endian(key.second));
+		return db_val_view(buffer);
+	}
 };
 
 template<typename K, typename H, typename I, typename V>
@@ -489,6 +550,15 @@ protected:
 		vnx::write_value(dst, vnx::to_big_endian(std::get<2>(key)));
 		return out;
 	}
+	db_val_view write_key(const std::tuple<K, H, I>& key, std::vector<uint8_t>& buffer) const override {
+		const auto& hash = std::get<0>(key);
+		buffer.resize(hash.size() + sizeof(H) + sizeof(I));
+		auto* dst = buffer.data();
+		::memcpy(dst, hash.data(), hash.size()); dst += hash.size();
+		vnx::write_value(dst, vnx::to_big_endian(std::get<1>(key))); dst += sizeof(H);
+		vnx::write_value(dst, vnx::to_big_endian(std::get<2>(key)));
+		return db_val_view(buffer);
+	}
 };
 
 template<typename V>
@@ -510,6 +580,12 @@ protected:
 		::memcpy(out->data + 32, key.second.data(), 32);
 		return out;
 	}
+	db_val_view write_key(const std::pair<addr_t, addr_t>& key, std::vector<uint8_t>& buffer) const override {
+		buffer.resize(64);
+		::memcpy(buffer.data(), key.first.data(), 32);
+		::memcpy(buffer.data() + 32, key.second.data(), 32);
+		return db_val_view(buffer);
+	}
 };
 
 
@@ -15,24 +15,14 @@
 
 namespace mmx {
 
-inline
-hash_t calc_btree_hash(const std::vector<hash_t>& input)
-{
-	auto tmp = input;
-	while(tmp.size() > 1) {
-		std::vector<hash_t> next;
-		for(size_t i = 0; i < tmp.size(); i += 2)
-		{
-			if(i + 1 < tmp.size()) {
-				next.emplace_back(tmp[i] + tmp[i + 1]);
-			} else {
-				next.push_back(tmp[i]);
-			}
-		}
-		tmp = next;
-	}
-	return tmp.empty() ? hash_t() : tmp[0];
-}
+/*
+ * Binary tree hash: each level hashes pairs (left + right), an odd last element is carried up.
+ * Pairs are hashed 8 at a time (SHA-NI / ARM / AVX2), large levels are split across threads.
+ */
+hash_t calc_btree_hash(const std::vector<hash_t>& input);
+
+// stop the thread pool used by calc_btree_hash(), call before exit
+void tree_hash_shutdown();
 
 
 } // mmx
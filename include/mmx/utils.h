@@ -110,6 +110,16 @@ bool check_plot_filter(
 	return (hash.to_uint256() >> (256 - params->plot_filter)) == 0;
 }
 
+// same as above for many plots, hashed 8 at a time
+std::vector<bool> check_plot_filter(
+		std::shared_ptr<const ChainParams> params, const hash_t& challenge, const std::vector<hash_t>& plot_ids);
+
+// [txid, pubkey, signature] of all PubKey solutions (also inside MultiSig), for signature_t::verify_many()
+std::vector<std::tuple<hash_t, pubkey_t, signature_t>> get_signatures(const std::vector<std::shared_ptr<const Transaction>>& tx_list);
+
+// copy of header as a Block without body, needed for BlockHeader::is_valid() since calc_hash() includes the type hash of mmx.Block
+std::shared_ptr<Block> make_header_only(std::shared_ptr<const BlockHeader> header);
+
 inline
 bool check_space_fork(std::shared_ptr<const ChainParams> params, const hash_t& challenge, const hash_t& proof_hash)
 {
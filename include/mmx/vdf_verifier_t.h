@@ -0,0 +1,97 @@
+/*
+ * vdf_verifier_t.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef INCLUDE_MMX_VDF_VERIFIER_T_H_
+#define INCLUDE_MMX_VDF_VERIFIER_T_H_
+
+#include <mmx/ProofOfTime.hxx>
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <future>
+#include <vector>
+#include <condition_variable>
+
+
+namespace mmx {
+
+/*
+ * Verifies VDF proofs on a shared pool of SHA worker threads.
+ * Segments of all pending proofs go into one queue, workers take up to 16 segments at a time,
+ * crossing proof boundaries, so the SIMD lanes stay full even for the tail of a proof.
+ */
+class vdf_verifier_t {
+public:
+	static constexpr uint32_t batch_size = 16;
+
+	struct stats_t {
+		uint64_t num_proofs = 0;
+		uint64_t num_segments = 0;
+		uint64_t num_iters = 0;
+		uint64_t num_batches = 0;
+		uint64_t num_lanes = 0;					// sum of lanes used per batch (excluding padding)
+		int64_t busy_time_us = 0;				// sum over all workers
+
+		double get_lane_usage() const {
+			return num_batches ? double(num_lanes) / (num_batches * batch_size) : 0;
+		}
+	};
+
+	// num_threads = 0 for hardware concurrency
+	vdf_verifier_t(const size_t num_threads = 0);
+
+	vdf_verifier_t(const vdf_verifier_t&) = delete;
+	vdf_verifier_t& operator=(const vdf_verifier_t&) = delete;
+
+	~vdf_verifier_t();
+
+	// future throws if proof is invalid
+	std::future<void> verify_async(std::shared_ptr<const ProofOfTime> proof);
+
+	// blocks until all segments are checked, throws if proof is invalid
+	void verify(std::shared_ptr<const ProofOfTime> proof);
+
+	void close();
+
+	stats_t get_stats() const;
+
+	size_t get_num_threads() const {
+		return threads.size();
+	}
+
+private:
+	struct job_t {
+		std::shared_ptr<const ProofOfTime> proof;
+		hash_t input;							// input of first segment
+		size_t num_pending = 0;
+		size_t invalid_segment = -1;
+		std::promise<void> result;
+	};
+
+	struct item_t {
+		std::shared_ptr<job_t> job;
+		uint32_t index = 0;
+	};
+
+	void worker();
+
+	void finish(std::shared_ptr<job_t> job, const size_t count);		// requires lock
+
+	mutable std::mutex mutex;
+	std::condition_variable signal;
+	std::deque<item_t> queue;
+	std::vector<std::thread> threads;
+	bool do_run = true;
+	stats_t stats;
+
+};
+
+
+} // mmx
+
+#endif /* INCLUDE_MMX_VDF_VERIFIER_T_H_ */
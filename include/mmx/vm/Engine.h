@@ -13,10 +13,12 @@
 #include <mmx/vm/var_t.h>
 #include <mmx/vm/varptr_t.hpp>
 #include <mmx/vm/instr_t.h>
+#include <mmx/vm/op_t.h>
 #include <mmx/vm/Storage.h>
 #include <mmx/vm/StorageProxy.h>
 
 #include <set>
+#include <deque>
 #include <map>
 #include <limits>
 #include <memory>
@@ -79,6 +81,12 @@ enum globalvar_e : uint32_t {
 };
 
 
+struct const_image_t {
+	std::vector<std::unique_ptr<var_t>> vars;		// [MEM_CONST + index], with FLAG_CONST
+	uint64_t write_cost = 0;						// gas for assigning all vars
+};
+
+
 class Engine {
 public:
 	struct frame_t {
@@ -89,6 +97,8 @@ public:
 	std::vector<instr_t> code;
 	std::vector<frame_t> call_stack;
 
+	std::shared_ptr<const program_ops_t> program;		// lower_program(code), created by run() if missing (reset when modifying code)
+
 	std::vector<txout_t> outputs;
 	std::vector<txout_t> mint_outputs;
 
@@ -103,6 +113,7 @@ public:
 	bool is_debug = false;
 	bool do_profile = false;
 	bool do_trace = false;
+	bool do_lower = true;		// run() executes pre-decoded program instead of step()
 
 	std::map<std::string, uint32_t> cost_map;		// key => count
 
@@ -181,6 +192,9 @@ public:
 	uint64_t deref(const uint64_t src);
 	uint64_t alloc();
 
+	// shares constant memory with other engines instead of assigning a copy
+	void map_constants(std::shared_ptr<const const_image_t> image);
+
 	void init();
 	void begin(const uint64_t instr_ptr);
 	void run();
@@ -214,6 +228,14 @@ public:
 
 private:
 	var_t* assign(std::unique_ptr<var_t>& var, std::unique_ptr<var_t> value);
+	var_t* read_const(const uint64_t src) const;
+
+	std::unique_ptr<var_t>* find_flat(const uint64_t addr, const bool create);
+	std::unique_ptr<var_t>* find_slot(const uint64_t addr);
+	std::unique_ptr<var_t>& get_slot(const uint64_t addr);
+
+	template<typename F>
+	void for_each_slot(const uint64_t begin, const uint64_t end, const F& func);
 	var_t* write(std::unique_ptr<var_t>& var, const uint64_t* dst, const var_t& src);
 
 	void clear(var_t* var);
@@ -226,9 +248,21 @@ private:
 	bool is_true(const uint64_t src);
 	bool is_true(const var_t& var);
 
+	void run_lowered();
+	void add(const uint64_t dst, const uint64_t lhs, const uint64_t rhs, const uint8_t flags);
+	void sub(const uint64_t dst, const uint64_t lhs, const uint64_t rhs, const uint8_t flags);
+	bool cmp(const opcode_e code, const uint64_t dst, const uint64_t lhs, const uint64_t rhs);
+
 private:
 	bool have_init = false;
-	std::map<uint64_t, std::unique_ptr<var_t>> memory;
+	std::shared_ptr<const const_image_t> const_image;
+
+	// first FLAT_SIZE addresses of const / extern / stack segments, indexed directly
+	// (deque keeps references valid while growing)
+	static constexpr uint64_t FLAT_SIZE = 0x10000;
+	std::deque<std::unique_ptr<var_t>> flat_memory[3];
+
+	std::map<uint64_t, std::unique_ptr<var_t>> memory;		// everything else
 	std::map<std::pair<uint64_t, uint64_t>, std::unique_ptr<var_t>> entries;
 	std::map<const var_t*, uint64_t, varptr_less_t> key_map;
 	std::map<addr_t, uint128_t> balance_map;
@@ -10,6 +10,8 @@
 
 #include <mmx/vm/StorageRAM.h>
 
+#include <set>
+
 
 namespace mmx {
 namespace vm {
@@ -30,13 +32,19 @@ public:
 
 	void commit() const;
 
+	void set_balance(const addr_t& contract, const addr_t& currency, const uint128& amount) override;
+
 	std::unique_ptr<uint128> get_balance(const addr_t& contract, const addr_t& currency) override;
 
+	// [contract, currency] passed to set_balance(), excludes balances only cached by get_balance()
+	std::set<std::pair<addr_t, addr_t>> get_balance_writes() const;
+
 	using Storage::write;
 	using Storage::lookup;
 
 private:
 	std::shared_ptr<Storage> backend;
+	std::set<std::pair<addr_t, addr_t>> balance_writes;
 
 };
 
@@ -49,6 +49,10 @@ public:
 		return entries;
 	}
 
+	const std::map<addr_t, std::map<addr_t, uint128>>& get_balances() const {
+		return balance_map;
+	}
+
 	void dump_memory(std::ostream& out) const;
 
 	using Storage::write;
@@ -0,0 +1,78 @@
+/*
+ * StorageTracker.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef INCLUDE_MMX_VM_STORAGETRACKER_H_
+#define INCLUDE_MMX_VM_STORAGETRACKER_H_
+
+#include <mmx/vm/StorageCache.h>
+
+#include <set>
+
+
+namespace mmx {
+namespace vm {
+
+/*
+ * Set of storage locations, used as read or write set for conflict detection.
+ */
+struct access_set_t {
+	std::set<std::pair<addr_t, uint64_t>> memory;
+	std::set<std::tuple<addr_t, uint64_t, uint64_t>> entries;
+	std::set<std::pair<addr_t, addr_t>> balances;
+	std::set<addr_t> keys;										// lookup() by value
+
+	bool intersects(const access_set_t& other) const;
+
+	void insert(const access_set_t& other);
+
+	// adds all locations written to storage (balances only read are not included)
+	void add_writes(const StorageCache& storage);
+
+	size_t size() const {
+		return memory.size() + entries.size() + balances.size() + keys.size();
+	}
+};
+
+/*
+ * Forwards all calls to backend and records the read set.
+ * Not thread-safe, meant to be used by a single transaction.
+ */
+class StorageTracker : public Storage {
+public:
+	StorageTracker(std::shared_ptr<Storage> backend);
+
+	std::unique_ptr<var_t> read(const addr_t& contract, const uint64_t src) const override;
+
+	std::unique_ptr<var_t> read(const addr_t& contract, const uint64_t src, const uint64_t key) const override;
+
+	void write(const addr_t& contract, const uint64_t dst, const var_t& value) override;
+
+	void write(const addr_t& contract, const uint64_t dst, const uint64_t key, const var_t& value) override;
+
+	uint64_t lookup(const addr_t& contract, const var_t& value) const override;
+
+	void set_balance(const addr_t& contract, const addr_t& currency, const uint128& amount) override;
+
+	std::unique_ptr<uint128> get_balance(const addr_t& contract, const addr_t& currency) override;
+
+	const access_set_t& get_read_set() const {
+		return read_set;
+	}
+
+	using Storage::write;
+	using Storage::lookup;
+
+private:
+	std::shared_ptr<Storage> backend;
+	mutable access_set_t read_set;
+
+};
+
+
+} // vm
+} // mmx
+
+#endif /* INCLUDE_MMX_VM_STORAGETRACKER_H_ */
@@ -0,0 +1,75 @@
+/*
+ * op_t.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef INCLUDE_MMX_VM_OP_T_H_
+#define INCLUDE_MMX_VM_OP_T_H_
+
+#include <mmx/vm/instr_t.h>
+
+#include <memory>
+
+
+namespace mmx {
+namespace vm {
+
+// handlers of Engine::run(), see lower()
+enum handler_e : uint8_t {
+
+	H_GENERIC,		// Engine::exec()
+	H_NOP,
+	H_COPY,			// dst, src
+	H_JUMP,			// dst
+	H_JUMPI,		// dst, cond
+	H_JUMPN,		// dst, cond
+	H_ADD,			// dst, lhs, rhs
+	H_SUB,			// dst, lhs, rhs
+	H_CMP,			// dst, lhs, rhs
+	H_CMP_JUMP,		// CMP_* dst, lhs, rhs + JUMPI / JUMPN a2, dst
+	H_ADD_JUMP,		// ADD dst, lhs, rhs + JUMP a2
+
+	H_COUNT
+};
+
+/*
+ * Pre-decoded instruction, one per instr_t (same index).
+ * Specialized handlers are only used without OPFLAG_REF_*, everything else goes through exec().
+ */
+struct op_t {
+	handler_e handler = H_GENERIC;
+	opcode_e code = OP_NOP;
+	opcode_e code2 = OP_NOP;	// second instruction of fused op
+	uint8_t flags = 0;
+	uint32_t a = 0;
+	uint32_t b = 0;
+	uint32_t c = 0;
+	uint32_t a2 = 0;			// first operand of second instruction
+};
+
+// FNV-1a over all instruction fields
+uint64_t hash_code(const std::vector<instr_t>& code);
+
+/*
+ * lower(code) together with a fingerprint of the code it was created from,
+ * created once per binary by vm::load() and shared via the binary image cache.
+ */
+struct program_ops_t {
+	std::vector<op_t> ops;
+	uint64_t code_hash = 0;		// hash_code(code)
+
+	bool matches(const std::vector<instr_t>& code) const {
+		return ops.size() == code.size() && code_hash == hash_code(code);
+	}
+};
+
+std::vector<op_t> lower(const std::vector<instr_t>& code);
+
+std::shared_ptr<const program_ops_t> lower_program(const std::vector<instr_t>& code);
+
+
+} // vm
+} // mmx
+
+#endif /* INCLUDE_MMX_VM_OP_T_H_ */
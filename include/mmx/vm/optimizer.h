@@ -0,0 +1,52 @@
+/*
+ * optimizer.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef INCLUDE_MMX_VM_OPTIMIZER_H_
+#define INCLUDE_MMX_VM_OPTIMIZER_H_
+
+#include <mmx/vm/instr_t.h>
+#include <mmx/vm/varptr_t.hpp>
+#include <mmx/contract/Binary.hxx>
+
+#include <map>
+
+
+namespace mmx {
+namespace vm {
+
+struct program_t {
+	std::vector<instr_t> code;
+	std::vector<varptr_t> constants;				// at MEM_CONST + index (read only)
+	std::vector<uint32_t> entry_points;				// instruction index, updated when code moves
+	std::map<uint32_t, uint32_t> line_info;			// instruction index => line, updated when code moves
+};
+
+struct code_stats_t {
+	size_t num_instr = 0;
+	size_t num_const = 0;
+	uint64_t load_cost = 0;			// gas to load constants, paid on every call
+	uint64_t exec_cost = 0;			// gas to execute every instruction once (without storage / call overhead)
+};
+
+/*
+ * Optimization passes on compiled code, by level:
+ * 1 = jump threading, peephole, unreachable code removal
+ * 2 = constant / copy propagation over stack slots, constant folding, dead branch removal
+ * 3 = store forwarding and dead store removal based on stack slot liveness
+ *
+ * Behavior is the same for every run that does not fail, constants are never added.
+ */
+void optimize(program_t& program, const int level);
+
+code_stats_t get_code_stats(const std::vector<instr_t>& code, const std::vector<varptr_t>& constants);
+
+code_stats_t get_code_stats(std::shared_ptr<const contract::Binary> binary);
+
+
+} // vm
+} // mmx
+
+#endif /* INCLUDE_MMX_VM_OPTIMIZER_H_ */
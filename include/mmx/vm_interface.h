@@ -17,6 +17,12 @@
 namespace mmx {
 namespace vm {
 
+struct binary_image_t {
+	std::vector<instr_t> code;
+	std::shared_ptr<const program_ops_t> program;		// lower_program(code)
+	std::shared_ptr<const const_image_t> constants;
+};
+
 const contract::method_t* find_method(std::shared_ptr<const contract::Binary> binary, const std::string& method_name);
 
 void set_deposit(std::shared_ptr<vm::Engine> engine, const addr_t& currency, const uint128& amount);
@@ -26,6 +32,13 @@ std::vector<std::unique_ptr<vm::var_t>> read_constants(std::shared_ptr<const con
 void load(	std::shared_ptr<vm::Engine> engine,
 			std::shared_ptr<const contract::Binary> binary);
 
+// same as above, but uses a process-wide cache of decoded binaries (address = binary address)
+void load(	std::shared_ptr<vm::Engine> engine,
+			std::shared_ptr<const contract::Binary> binary, const addr_t& address);
+
+// returns nullptr if binary cannot be mapped (need to use plain load() instead)
+std::shared_ptr<const binary_image_t> get_binary_image(std::shared_ptr<const contract::Binary> binary, const addr_t& address);
+
 void copy(std::shared_ptr<vm::Engine> dst, std::shared_ptr<vm::Engine> src, const uint64_t dst_addr, const uint64_t src_addr);
 
 void assign(std::shared_ptr<vm::Engine> engine, const uint64_t dst, const vnx::Variant& value);
@@ -14,6 +14,14 @@ void sha256_64_x8(uint8_t* out, uint8_t* in, const uint64_t length);
 
 void sha256_avx2_64_x8(uint8_t* out, uint8_t* in, const uint64_t length);
 
+// 8 messages of equal length, back to back (any length)
+void sha256_x8(uint8_t* out, const uint8_t* in, const uint64_t length);
+
+void sha256_avx2_x8(uint8_t* out, const uint8_t* in, const uint64_t length);
+
+// hash: 8 lanes x 32 bytes
+void recursive_sha256_avx2_x8(uint8_t* hash, const uint64_t num_iters);
+
 bool avx2_available();
 
 
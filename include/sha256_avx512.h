@@ -0,0 +1,18 @@
+/*
+ * sha256_avx512.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#ifndef INCLUDE_SHA256_AVX512_H_
+#define INCLUDE_SHA256_AVX512_H_
+
+#include <cstdint>
+
+// hash: 16 lanes x 32 bytes
+void recursive_sha256_avx512_x16(uint8_t* hash, const uint64_t num_iters);
+
+bool avx512_available();
+
+
+#endif /* INCLUDE_SHA256_AVX512_H_ */
@@ -43,6 +43,7 @@ vnx::bool_t Block::is_valid() const
 hash_t Block::calc_tx_hash() const
 {
 	std::vector<hash_t> tmp;
+	tmp.reserve(tx_list.size());
 	for(const auto& tx : tx_list) {
 		tmp.push_back(tx->content_hash);
 	}
@@ -10,6 +10,19 @@
 
 #include <vnx/vnx.h>
 
+#include <thread>
+#include <chrono>
+
+#ifndef _WIN32
+#include <stdio.h>
+#include <sys/mman.h>
+#endif
+
+#ifdef WITH_ZSTD
+#include <zstd.h>
+#include <zdict.h>
+#endif
+
 
 namespace mmx {
 
@@ -20,15 +33,52 @@ std::string to_number(const T& value, const size_t n_zero)
 	return std::string(n_zero - std::min(n_zero, tmp.length()), '0') + tmp;
 }
 
-uint32_t calc_checksum_32(uint32_t version, std::shared_ptr<db_val_t> key, std::shared_ptr<db_val_t> value)
+uint32_t calc_checksum_32(uint32_t version, const db_val_view& key, const db_val_view& value)
 {
 	vnx::CRC64 crc;
 	crc.update(version);
-	crc.update((const char*)key->data, key->size);
-	crc.update((const char*)value->data, value->size);
+	crc.update((const char*)key.data, key.size);
+	crc.update((const char*)value.data, value.size);
 	return uint32_t(crc.get());
 }
 
+// MurmurHash64A
+uint64_t calc_key_hash(const db_val_view& key)
+{
+	const uint64_t m = 0xc6a4a7935bd1e995ull;
+	const int r = 47;
+
+	uint64_t h = 0x5bd1e9955bd1e995ull ^ (key.size * m);
+
+	const uint8_t* data = key.data;
+	const uint8_t* end = data + (key.size / 8) * 8;
+	for(; data != end; data += 8) {
+		uint64_t k;
+		::memcpy(&k, data, 8);
+		k *= m;
+		k ^= k >> r;
+		k *= m;
+		h ^= k;
+		h *= m;
+	}
+	const auto left = key.size & 7;
+	if(left) {
+		uint64_t k = 0;
+		::memcpy(&k, data, left);
+		h ^= k;
+		h *= m;
+	}
+	h ^= h >> r;
+	h *= m;
+	h ^= h >> r;
+	return h;
+}
+
+std::shared_ptr<db_val_t> make_val(const db_val_view& value)
+{
+	return std::make_shared<db_val_t>(value.data, value.size);
+}
+
 void read_key(vnx::TypeInput& in, uint32_t& version, std::shared_ptr<db_val_t>& key)
 {
 	vnx::read(in, version);
@@ -39,7 +89,17 @@ void read_key(vnx::TypeInput& in, uint32_t& version, std::shared_ptr<db_val_t>&
 	in.read(key->data, key->size);
 }
 
-void read_key_at(const vnx::File& file, const int64_t offset, uint32_t& version, std::shared_ptr<db_val_t>& key)
+void read_key(vnx::TypeInput& in, uint32_t& version, std::vector<uint8_t>& key)
+{
+	vnx::read(in, version);
+
+	uint32_t size = 0;
+	vnx::read(in, size);
+	key.resize(size);
+	in.read(key.data(), key.size());
+}
+
+void read_key_at(const vnx::File& file, const int64_t offset, uint32_t& version, std::vector<uint8_t>& key)
 {
 	vnx::FileSectionInputStream stream(file.get_handle(), offset, -1, 256);
 	vnx::TypeInput in(&stream);
@@ -54,11 +114,12 @@ void read_value(vnx::TypeInput& in, std::shared_ptr<db_val_t>& value)
 	in.read(value->data, value->size);
 }
 
-void read_value_at(const vnx::File& file, const int64_t offset, std::shared_ptr<db_val_t> key, std::shared_ptr<db_val_t>& value)
+void read_value(vnx::TypeInput& in, std::vector<uint8_t>& value)
 {
-	vnx::FileSectionInputStream stream(file.get_handle(), offset + 8 + key->size, -1, 1024);
-	vnx::TypeInput in(&stream);
-	read_value(in, value);
+	uint32_t size = 0;
+	vnx::read(in, size);
+	value.resize(size);
+	in.read(value.data(), value.size());
 }
 
 void read_entry(vnx::TypeInput& in, uint32_t& version, std::shared_ptr<db_val_t>& key, std::shared_ptr<db_val_t>& value)
@@ -73,37 +134,171 @@ void read_entry_sum(vnx::TypeInput& in, uint32_t& version, std::shared_ptr<db_va
 
 	uint32_t sum = 0;
 	vnx::read(in, sum);
-	if(sum != calc_checksum_32(version, key, value)) {
+	if(sum != calc_checksum_32(version, *key, *value)) {
 		throw std::runtime_error("read_entry(): checksum fail (version = " + std::to_string(version)
 				+ ", key = " + std::to_string(key->size) + ", value = " + std::to_string(value->size) + ")");
 	}
 }
 
-void read_entry_at(const vnx::File& file, const int64_t offset, uint32_t& version, std::shared_ptr<db_val_t>& key, std::shared_ptr<db_val_t>& value)
-{
-	vnx::FileSectionInputStream stream(file.get_handle(), offset, -1, 1024);
-	vnx::TypeInput in(&stream);
-	read_key(in, version, key);
-	read_value(in, value);
-}
-
-void write_entry(vnx::TypeOutput& out, uint32_t version, std::shared_ptr<db_val_t> key, std::shared_ptr<db_val_t> value)
+void write_entry(vnx::TypeOutput& out, uint32_t version, const db_val_view& key, const db_val_view& value)
 {
 	vnx::write(out, version);
-	vnx::write(out, key->size);
-	out.write(key->data, key->size);
-	vnx::write(out, value->size);
-	out.write(value->data, value->size);
+	vnx::write(out, key.size);
+	out.write(key.data, key.size);
+	vnx::write(out, value.size);
+	out.write(value.data, value.size);
 }
 
-void write_entry_sum(vnx::TypeOutput& out, uint32_t version, std::shared_ptr<db_val_t> key, std::shared_ptr<db_val_t> value)
+void write_entry_sum(vnx::TypeOutput& out, uint32_t version, const db_val_view& key, const db_val_view& value)
 {
 	write_entry(out, version, key, value);
 	vnx::write(out, calc_checksum_32(version, key, value));
 }
 
-const std::function<int(const db_val_t&, const db_val_t&)> Table::default_comparator =
-	[](const db_val_t& lhs, const db_val_t& rhs) -> int {
+// same format as write_entry()
+void append_entry(std::vector<uint8_t>& out, uint32_t version, const db_val_view& key, const db_val_view& value)
+{
+	const auto offset = out.size();
+	out.resize(offset + 12 + key.size + value.size);
+	auto* dst = out.data() + offset;
+	::memcpy(dst, &version, 4);
+	::memcpy(dst + 4, &key.size, 4);
+	::memcpy(dst + 8, key.data, key.size);
+	::memcpy(dst + 8 + key.size, &value.size, 4);
+	::memcpy(dst + 12 + key.size, value.data, value.size);
+}
+
+size_t parse_key(const uint8_t* data, const size_t avail, uint32_t& version, db_val_view& key)
+{
+	uint32_t size = 0;
+	if(avail < 8) {
+		throw std::logic_error("parse_key(): offset out of bounds");
+	}
+	::memcpy(&version, data, 4);
+	::memcpy(&size, data + 4, 4);
+	if(8 + size_t(size) > avail) {
+		throw std::logic_error("parse_key(): key size out of bounds");
+	}
+	key = db_val_view(data + 8, size);
+	return 8 + size;
+}
+
+size_t parse_value(const uint8_t* data, const size_t avail, db_val_view& value)
+{
+	uint32_t size = 0;
+	if(avail < 4) {
+		throw std::logic_error("parse_value(): offset out of bounds");
+	}
+	::memcpy(&size, data, 4);
+	if(4 + size_t(size) > avail) {
+		throw std::logic_error("parse_value(): value size out of bounds");
+	}
+	value = db_val_view(data + 4, size);
+	return 4 + size;
+}
+
+/*
+ * Compression context, with optional dictionary (dict_id = 0 means no dictionary).
+ */
+struct db_codec_t {
+	uint32_t dict_id = 0;
+	int level = 0;
+
+	db_codec_t(const std::vector<uint8_t>& dict, const int level);
+	~db_codec_t();
+
+	db_codec_t(const db_codec_t&) = delete;
+	db_codec_t& operator=(const db_codec_t&) = delete;
+
+	void compress(const std::vector<uint8_t>& src, std::vector<uint8_t>& dst) const;
+	void decompress(const uint8_t* src, const size_t size, std::vector<uint8_t>& dst, const size_t raw_size) const;
+
+#ifdef WITH_ZSTD
+private:
+	ZSTD_CDict* cdict = nullptr;
+	ZSTD_DDict* ddict = nullptr;
+#endif
+};
+
+#ifdef WITH_ZSTD
+
+db_codec_t::db_codec_t(const std::vector<uint8_t>& dict, const int level)
+	:	level(level)
+{
+	if(dict.size()) {
+		dict_id = ZDICT_getDictID(dict.data(), dict.size());
+		if(!dict_id) {
+			throw std::runtime_error("invalid compression dictionary");
+		}
+		cdict = ZSTD_createCDict(dict.data(), dict.size(), level);
+		ddict = ZSTD_createDDict(dict.data(), dict.size());
+		if(!cdict || !ddict) {
+			throw std::runtime_error("ZSTD_createCDict() / ZSTD_createDDict() failed");
+		}
+	}
+}
+
+db_codec_t::~db_codec_t()
+{
+	ZSTD_freeCDict(cdict);
+	ZSTD_freeDDict(ddict);
+}
+
+void db_codec_t::compress(const std::vector<uint8_t>& src, std::vector<uint8_t>& dst) const
+{
+	struct context_t {
+		ZSTD_CCtx* ctx = ZSTD_createCCtx();
+		~context_t() { ZSTD_freeCCtx(ctx); }
+	};
+	thread_local context_t context;
+
+	dst.resize(ZSTD_compressBound(src.size()));
+	const auto res = cdict ?
+			ZSTD_compress_usingCDict(context.ctx, dst.data(), dst.size(), src.data(), src.size(), cdict) :
+			ZSTD_compressCCtx(context.ctx, dst.data(), dst.size(), src.data(), src.size(), level);
+	if(ZSTD_isError(res)) {
+		throw std::runtime_error(std::string("ZSTD_compress() failed with: ") + ZSTD_getErrorName(res));
+	}
+	dst.resize(res);
+}
+
+void db_codec_t::decompress(const uint8_t* src, const size_t size, std::vector<uint8_t>& dst, const size_t raw_size) const
+{
+	struct context_t {
+		ZSTD_DCtx* ctx = ZSTD_createDCtx();
+		~context_t() { ZSTD_freeDCtx(ctx); }
+	};
+	thread_local context_t context;
+
+	dst.resize(raw_size);
+	const auto res = ddict ?
+			ZSTD_decompress_usingDDict(context.ctx, dst.data(), dst.size(), src, size, ddict) :
+			ZSTD_decompressDCtx(context.ctx, dst.data(), dst.size(), src, size);
+	if(ZSTD_isError(res)) {
+		throw std::runtime_error(std::string("ZSTD_decompress() failed with: ") + ZSTD_getErrorName(res));
+	}
+	if(res != raw_size) {
+		throw std::runtime_error("ZSTD_decompress(): size mismatch");
+	}
+}
+
+#else
+
+db_codec_t::db_codec_t(const std::vector<uint8_t>& dict, const int level)
+{
+	throw std::runtime_error("compression not supported (built without zstd)");
+}
+
+db_codec_t::~db_codec_t() {}
+
+void db_codec_t::compress(const std::vector<uint8_t>& src, std::vector<uint8_t>& dst) const {}
+
+void db_codec_t::decompress(const uint8_t* src, const size_t size, std::vector<uint8_t>& dst, const size_t raw_size) const {}
+
+#endif // WITH_ZSTD
+
+const std::function<int(const db_val_view&, const db_val_view&)> Table::default_comparator =
+	[](const db_val_view& lhs, const db_val_view& rhs) -> int {
 		if(lhs.size == rhs.size) {
 			return ::memcmp(lhs.data, rhs.data, lhs.size);
 		}
@@ -112,8 +307,14 @@ const std::function<int(const db_val_t&, const db_val_t&)> Table::default_compar
 
 const Table::options_t Table::default_options;
 
+static vnx::ThreadPool& get_compaction_pool()
+{
+	static vnx::ThreadPool pool(std::max(std::thread::hardware_concurrency() / 4, 2u));
+	return pool;
+}
+
 Table::Table(const std::string& root_path, const options_t& options)
-	:	options(options), root_path(root_path), mem_index(key_compare_t(this)), mem_block(mem_compare_t(this))
+	:	options(options), root_path(root_path), mem_index(key_compare_t(this), &mem_arena), mem_block(mem_compare_t(this), &mem_arena)
 {
 	const auto time_begin = get_time_ms();
 	vnx::Directory root(root_path);
@@ -141,12 +342,31 @@ Table::Table(const std::string& root_path, const options_t& options)
 			}
 		}
 	}
+#ifdef WITH_ZSTD
+	codec_map[0] = std::make_shared<db_codec_t>(std::vector<uint8_t>(), options.compression_level);
+	{
+		vnx::File file(root_path + "/dictionary.dat");
+		if(file.exists()) {
+			file.open("rb");
+			std::vector<uint8_t> dict(file.file_size());
+			file.in.read(dict.data(), dict.size());
+			file.close();
+
+			const auto dict_codec = std::make_shared<db_codec_t>(dict, options.compression_level);
+			codec_map[dict_codec->dict_id] = dict_codec;
+			debug_log << "Loaded dictionary.dat with " << dict.size() << " bytes, dict_id = " << dict_codec->dict_id << std::endl;
+		}
+	}
+	if(options.compression == compression_t::ZSTD) {
+		codec = codec_map.rbegin()->second;		// use dictionary if available
+	}
+#endif
 	{
 		std::vector<std::shared_ptr<block_t>> block_list;
 		for(const auto& entry : block_map) {
 			const auto block = read_block(entry.second);
 			block_list.push_back(block);
-			debug_log << "Loaded " << block->name << " at level " << block->level << " with " << block->index.size() << " / " << block->total_count
+			debug_log << "Loaded " << block->name << " at level " << block->level << " with " << block->index_size() << " / " << block->total_count
 					<< " entries, min_version = " << block->min_version << ", max_version = " << block->max_version << std::endl;
 		}
 		std::sort(block_list.begin(), block_list.end(),
@@ -157,17 +377,19 @@ Table::Table(const std::string& root_path, const options_t& options)
 				return lhs->min_version < rhs->min_version;
 			});
 
+		auto list = std::make_shared<block_list_t>();
 		std::shared_ptr<block_t> prev;
 		for(const auto& block : block_list) {
 			if(!prev || block->min_version > prev->max_version) {
 				curr_version = block->max_version + 1;
-				blocks.push_back(block);
+				list->push_back(block);
 			} else {
 				block->file.remove();
 				debug_log << "Deleted " << block->name << std::endl;
 			}
 			prev = block;
 		}
+		set_blocks(list);
 	}
 	last_flush = curr_version;
 
@@ -215,7 +437,7 @@ Table::Table(const std::string& root_path, const options_t& options)
 		write_log.seek_to(offset);
 
 		for(const auto& entry : entries) {
-			insert_entry(entry.first, entry.second.first, entry.second.second);
+			insert_entry(entry.first, *entry.second.first, *entry.second.second);
 		}
 		debug_log << "Loaded " << mem_index.size() << " / " << mem_block.size() << " entries from write_log.dat" << std::endl;
 	}
@@ -223,9 +445,20 @@ Table::Table(const std::string& root_path, const options_t& options)
 
 	revert(curr_version);
 
+	std::lock_guard lock(mutex);
 	check_rewrite();
 }
 
+Table::~Table()
+{
+	std::unique_lock lock(mutex);
+	is_closing = true;
+	do_abort = true;
+	while(compaction_stats.is_running) {
+		compaction_signal.wait(lock);
+	}
+}
+
 std::shared_ptr<Table::block_t> Table::read_block(const std::string& name) const
 {
 	// TODO: handle unexpected read errors here
@@ -237,7 +470,7 @@ std::shared_ptr<Table::block_t> Table::read_block(const std::string& name) const
 	auto& in = block->file.in;
 	uint16_t format = 0;
 	vnx::read(in, format);
-	if(format > 0) {
+	if(format > 2) {
 		throw std::runtime_error("invalid block format: " + std::to_string(format));
 	}
 	vnx::read(in, block->level);
@@ -251,6 +484,53 @@ std::shared_ptr<Table::block_t> Table::read_block(const std::string& name) const
 	vnx::read(in, index_size);
 	block->index.resize(index_size);
 	in.read(block->index.data(), block->index.size() * 8);
+
+	if(format >= 1) {
+		auto& bloom = block->bloom;
+		uint64_t num_words = 0;
+		vnx::read(in, bloom.num_hashes);
+		vnx::read(in, num_words);
+		if(num_words % 8) {
+			throw std::runtime_error("invalid bloom filter size: " + std::to_string(num_words));
+		}
+		bloom.data.resize(num_words);
+		in.read(bloom.data.data(), bloom.data.size() * 8);
+	}
+	block->data_end = block->index_offset;
+
+	if(format >= 2) {
+		uint32_t codec_id = 0;
+		uint64_t num_chunks = 0;
+		vnx::read(in, codec_id);
+		vnx::read(in, block->dict_id);
+		vnx::read(in, num_chunks);
+		block->chunks.resize(num_chunks);
+		for(auto& chunk : block->chunks) {
+			vnx::read(in, chunk.offset);
+			vnx::read(in, chunk.file_offset);
+			vnx::read(in, chunk.size);
+			vnx::read(in, chunk.raw_size);
+		}
+		if(codec_id > uint32_t(compression_t::ZSTD)) {
+			throw std::runtime_error("invalid block compression: " + std::to_string(codec_id));
+		}
+		block->codec = compression_t(codec_id);
+		if(block->codec != compression_t::NONE) {
+			auto iter = codec_map.find(block->dict_id);
+			if(iter == codec_map.end()) {
+				throw std::runtime_error("missing compression dictionary " + std::to_string(block->dict_id) + " for " + name);
+			}
+			block->codec_impl = iter->second;
+			block->data_end = block_header_size;
+			if(!block->chunks.empty()) {
+				const auto& last = block->chunks.back();
+				block->data_end = last.offset + last.raw_size;
+			}
+		}
+	}
+	if(options.use_mmap) {
+		block->map();
+	}
 	return block;
 }
 
@@ -259,6 +539,11 @@ void Table::insert(std::shared_ptr<db_val_t> key, std::shared_ptr<db_val_t> valu
 	if(!key || !value) {
 		throw std::logic_error("!key || !value");
 	}
+	insert(*key, *value);
+}
+
+void Table::insert(const db_val_view& key, const db_val_view& value)
+{
 	std::lock_guard lock(mutex);
 	if(write_lock) {
 		throw std::logic_error("table is write locked");
@@ -267,15 +552,23 @@ void Table::insert(std::shared_ptr<db_val_t> key, std::shared_ptr<db_val_t> valu
 	insert_entry(curr_version, key, value);
 }
 
-void Table::insert_entry(uint32_t version, std::shared_ptr<db_val_t> key, std::shared_ptr<db_val_t> value)
+void Table::insert_entry(uint32_t version, const db_val_view& key, const db_val_view& value)
 {
-	auto& entry = mem_block[std::make_pair(key, version)];
-	if(entry) {
-		mem_block_size -= key->size + entry->size;
+	const auto value_ = mem_arena.copy(value);
+
+	auto iter = mem_index.find(key);
+	if(iter != mem_index.end()) {
+		iter->second = std::make_pair(value_, version);
+	} else {
+		iter = mem_index.emplace(mem_arena.copy(key), std::make_pair(value_, version)).first;
+	}
+	const auto ret = mem_block.emplace(std::make_pair(iter->first, version), value_);
+	if(!ret.second) {
+		auto& entry = ret.first->second;
+		mem_block_size -= key.size + entry.size;
+		entry = value_;
 	}
-	entry = value;
-	mem_index[key] = std::make_pair(value, version);
-	mem_block_size += key->size + value->size;
+	mem_block_size += key.size + value.size;
 }
 
 std::shared_ptr<db_val_t> Table::find(std::shared_ptr<db_val_t> key, const uint32_t max_version) const
@@ -283,68 +576,173 @@ std::shared_ptr<db_val_t> Table::find(std::shared_ptr<db_val_t> key, const uint3
 	if(!key) {
 		return nullptr;
 	}
-	{
-		auto iter = mem_index.find(key);
-		if(iter != mem_index.end()) {
-			if(iter->second.second <= max_version) {
-				return iter->second.first;
+	std::vector<uint8_t> value;
+	if(find(*key, value, max_version)) {
+		return make_val(value);
+	}
+	return nullptr;
+}
+
+bool Table::find(const db_val_view& key, std::vector<uint8_t>& value, const uint32_t max_version) const
+{
+	if(find_mem(key, value, max_version)) {
+		return true;
+	}
+	const auto hash = calc_key_hash(key);
+	const auto blocks = get_blocks();
+
+	for(auto iter = blocks->rbegin(); iter != blocks->rend(); ++iter) {
+		const auto& block = *iter;
+		if(block->min_version <= max_version && block->bloom.contains(hash)) {
+			if(find(block, key, value, max_version)) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+bool Table::bloom_contains(const db_val_view& key) const
+{
+	const auto hash = calc_key_hash(key);
+	for(const auto& block : *get_blocks()) {
+		if(block->bloom.contains(hash)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+std::vector<std::shared_ptr<db_val_t>> Table::find_many(const std::vector<std::shared_ptr<db_val_t>>& keys, const uint32_t max_version) const
+{
+	std::vector<uint8_t> value;
+	std::vector<std::shared_ptr<db_val_t>> result(keys.size());
+
+	std::vector<std::pair<size_t, uint64_t>> pending;		// [index, hash]
+	for(size_t i = 0; i < keys.size(); ++i) {
+		if(const auto& key = keys[i]) {
+			if(find_mem(*key, value, max_version)) {
+				result[i] = make_val(value);
 			} else {
-				auto iter = mem_block.lower_bound(std::make_pair(key, max_version));
-				while(iter != mem_block.end() && *iter->first.first == *key) {
-					if(iter->first.second <= max_version) {
-						return iter->second;
-					} else if(iter != mem_block.begin()) {
-						iter--;
-					} else {
-						break;
-					}
-				}
+				pending.emplace_back(i, calc_key_hash(*key));
 			}
 		}
 	}
-	for(auto iter = blocks.rbegin(); iter != blocks.rend(); ++iter) {
+	std::sort(pending.begin(), pending.end(),
+		[this, &keys](const std::pair<size_t, uint64_t>& lhs, const std::pair<size_t, uint64_t>& rhs) -> bool {
+			return options.comparator(*keys[lhs.first], *keys[rhs.first]) < 0;
+		});
+
+	std::vector<uint8_t> buffer;
+	const auto blocks = get_blocks();
+
+	for(auto iter = blocks->rbegin(); iter != blocks->rend() && !pending.empty(); ++iter) {
 		const auto& block = *iter;
-		if(block->min_version <= max_version) {
-			if(auto value = find(block, key, max_version)) {
-				return value;
+		if(block->min_version > max_version) {
+			continue;
+		}
+		// keys are sorted, so each search continues where the previous one ended
+		size_t pos = 0;
+		auto dst = pending.begin();
+		for(const auto& entry : pending) {
+			const auto& key = *keys[entry.first];
+			bool found = false;
+			if(block->bloom.contains(entry.second)) {
+				bool is_match = false;
+				uint32_t version = -1;
+				pos = lower_bound(block, key, version, is_match, buffer, pos);
+				if(is_match && find_at(block, pos, key, version, value, buffer, max_version)) {
+					result[entry.first] = make_val(value);
+					found = true;
+				}
+			}
+			if(!found) {
+				*(dst++) = entry;
 			}
 		}
+		pending.erase(dst, pending.end());
 	}
-	return nullptr;
+	return result;
 }
 
-std::shared_ptr<db_val_t> Table::find(std::shared_ptr<const block_t> block, std::shared_ptr<db_val_t> key, const uint32_t max_version) const
+bool Table::find_mem(const db_val_view& key, std::vector<uint8_t>& value, const uint32_t max_version) const
 {
-	auto res = key;
+	auto iter = mem_index.find(key);
+	if(iter != mem_index.end()) {
+		if(iter->second.second <= max_version) {
+			const auto& entry = iter->second.first;
+			value.assign(entry.data, entry.data + entry.size);
+			return true;
+		} else {
+			auto iter = mem_block.lower_bound(std::make_pair(key, max_version));
+			while(iter != mem_block.end() && iter->first.first == key) {
+				if(iter->first.second <= max_version) {
+					const auto& entry = iter->second;
+					value.assign(entry.data, entry.data + entry.size);
+					return true;
+				} else if(iter != mem_block.begin()) {
+					iter--;
+				} else {
+					break;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+bool Table::find(std::shared_ptr<const block_t> block, const db_val_view& key, std::vector<uint8_t>& value, const uint32_t max_version) const
+{
+	thread_local std::vector<uint8_t> buffer;
+
 	bool is_match = false;
 	uint32_t version = -1;
-	const auto pos = lower_bound(block, version, res, is_match);
+	const auto pos = lower_bound(block, key, version, is_match, buffer);
+	if(!is_match) {
+		return false;
+	}
+	return find_at(block, pos, key, version, value, buffer, max_version);
+}
 
-	std::shared_ptr<db_val_t> value;
-	if(is_match) {
-		const auto offset = block->index[pos] + 8 + key->size;
-		if(offset > block->index_offset) {
-			throw std::logic_error("offset > index_offset");
+bool Table::find_at(std::shared_ptr<const block_t> block, const size_t pos, const db_val_view& key, uint32_t version,
+					std::vector<uint8_t>& value, std::vector<uint8_t>& buffer, const uint32_t max_version) const
+{
+	if(block->map_data || block->codec != compression_t::NONE) {
+		auto offset = block->get_index(pos);
+		while(offset < block->data_end) {
+			const auto key_i = block->read_key_at(offset, version, buffer);
+			if(key_i != key) {
+				break;
+			}
+			const auto value_i = block->read_value_at(offset, key_i.size, buffer);
+			if(version <= max_version) {
+				value.assign(value_i.data, value_i.data + value_i.size);
+				return true;
+			}
+			offset += 12 + key_i.size + value_i.size;
 		}
-		vnx::FileSectionInputStream stream(block->file.get_handle(), offset, block->index_offset - offset, 1024);
-		vnx::TypeInput in(&stream);
-		read_value(in, value);
+		return false;
+	}
+	const auto offset = block->get_index(pos) + 8 + key.size;
+	if(offset > block->index_offset) {
+		throw std::logic_error("offset > index_offset");
+	}
+	vnx::FileSectionInputStream stream(block->file.get_handle(), offset, block->index_offset - offset, 1024);
+	vnx::TypeInput in(&stream);
+	read_value(in, value);
 
-		while(version > max_version) {
-			try {
-				std::shared_ptr<db_val_t> key_;
-				read_entry(in, version, key_, value);
-				if(*key_ != *key) {
-					value = nullptr;
-					break;
-				}
-			} catch(const std::underflow_error& ex) {
-				value = nullptr;
-				break;
+	while(version > max_version) {
+		try {
+			read_key(in, version, buffer);
+			read_value(in, value);
+			if(db_val_view(buffer) != key) {
+				return false;
 			}
+		} catch(const std::underflow_error& ex) {
+			return false;
 		}
 	}
-	return value;
+	return true;
 }
 
 size_t Table::lower_bound(std::shared_ptr<const block_t> block, uint32_t& version, std::shared_ptr<db_val_t>& key, bool& is_match) const
@@ -352,36 +750,43 @@ size_t Table::lower_bound(std::shared_ptr<const block_t> block, uint32_t& versio
 	if(!key) {
 		throw std::logic_error("!key");
 	}
-	const auto end = block->index.size();
+	std::vector<uint8_t> buffer;
+	const auto pos = lower_bound(block, *key, version, is_match, buffer);
+	if(!is_match) {
+		if(pos < block->index_size()) {
+			key = make_val(block->read_key_at(block->get_index(pos), version, buffer));
+		} else {
+			version = -1;
+			key = nullptr;
+		}
+	}
+	return pos;
+}
+
+size_t Table::lower_bound(std::shared_ptr<const block_t> block, const db_val_view& key, uint32_t& version, bool& is_match,
+							std::vector<uint8_t>& buffer, const size_t begin) const
+{
+	const auto end = block->index_size();
 	// find match or successor
-	size_t L = 0;
+	size_t L = std::min(begin, end);
 	size_t R = end;
 	while(L < R) {
 		const auto pos = (L + R) / 2;
 		uint32_t version;
-		std::shared_ptr<db_val_t> key_i;
-		read_key_at(block->file, block->index[pos], version, key_i);
-		if(options.comparator(*key, *key_i) < 0) {
+		const auto key_i = block->read_key_at(block->get_index(pos), version, buffer);
+		if(options.comparator(key, key_i) < 0) {
 			R = pos;
 		} else {
 			L = pos + 1;
 		}
 	}
+	is_match = false;
 	if(R > 0) {
-		std::shared_ptr<db_val_t> key_i;
-		read_key_at(block->file, block->index[R - 1], version, key_i);
-		if(*key == *key_i) {
+		if(key == block->read_key_at(block->get_index(R - 1), version, buffer)) {
 			is_match = true;
 			return R - 1;
 		}
 	}
-	if(R < end) {
-		read_key_at(block->file, block->index[R], version, key);
-	} else {
-		version = -1;
-		key = nullptr;
-	}
-	is_match = false;
 	return R;
 }
 
@@ -395,9 +800,7 @@ bool Table::commit(const uint32_t new_version, const bool auto_flush)
 	}
 	{
 		const std::string cmd = "commit";
-		write_entry_sum(write_log.out, -1,
-				std::make_shared<db_val_t>(cmd.c_str(), cmd.size()),
-				std::make_shared<db_val_t>(&new_version, sizeof(new_version)));
+		write_entry_sum(write_log.out, -1, cmd, db_val_view(&new_version, sizeof(new_version)));
 	}
 	write_log.flush();
 
@@ -413,14 +816,25 @@ bool Table::commit(const uint32_t new_version, const bool auto_flush)
 
 bool Table::do_flush() const
 {
-	const bool normal_flush = (mem_block_size + mem_block.size() * entry_overhead >= options.max_block_size);
+	const bool normal_flush = (mem_block_size + mem_block.size() * entry_overhead >= options.max_block_size)
+			|| (mem_arena.get_size() >= 4 * options.max_block_size);	// in case of many reverts
 	const bool force_flush = (curr_version > last_flush && curr_version - last_flush >= options.force_flush_threshold);
 	return normal_flush || force_flush;
 }
 
 void Table::revert(const uint32_t new_version)
 {
-	std::lock_guard lock(mutex);
+	std::unique_lock lock(mutex);
+
+	// compaction works on a snapshot of the blocks we are about to modify, abort it instead of waiting
+	revert_pending = true;
+	do_abort = true;
+	while(compaction_stats.is_running) {
+		compaction_signal.wait(lock);
+	}
+	do_abort = false;
+	revert_pending = false;
+
 	if(write_lock) {
 		throw std::logic_error("table is write locked");
 	}
@@ -429,19 +843,17 @@ void Table::revert(const uint32_t new_version)
 	}
 	{
 		const std::string cmd = "revert";
-		write_entry_sum(write_log.out, -1,
-				std::make_shared<db_val_t>(cmd.c_str(), cmd.size()),
-				std::make_shared<db_val_t>(&new_version, sizeof(new_version)));
+		write_entry_sum(write_log.out, -1, cmd, db_val_view(&new_version, sizeof(new_version)));
 	}
 	write_log.flush();
 
-	std::set<std::string> deleted_blocks;
-	for(auto iter = blocks.begin(); iter != blocks.end();) {
+	auto blocks = std::make_shared<block_list_t>(*get_blocks());
+	for(auto iter = blocks->begin(); iter != blocks->end();) {
 		auto& block = *iter;
 		if(block->min_version >= new_version) {
 			block->file.remove();
 			debug_log << "Deleted " << block->name << std::endl;
-			iter = blocks.erase(iter);
+			iter = blocks->erase(iter);
 			continue;
 		}
 		if(block->max_version >= new_version) {
@@ -449,49 +861,48 @@ void Table::revert(const uint32_t new_version)
 
 			auto new_block = create_block(block->level, block->name + ".tmp");
 			new_block->min_version = block->min_version;
+			new_block->bloom.init(block->index_size(), options.bloom_bits_per_key);
 
-			auto& src = block->file;
-			auto& dst = new_block->file;
-			auto& in = src.in;
-			auto& out = dst.out;
-			src.seek_to(block_header_size);
-			dst.seek_to(block_header_size);
+			block_reader_t reader(block);
+			const auto writer = create_writer(new_block);
 
 			std::shared_ptr<db_val_t> prev;
 			for(uint64_t i = 0; i < block->total_count; ++i) {
 				uint32_t version;
 				std::shared_ptr<db_val_t> key;
 				std::shared_ptr<db_val_t> value;
-				read_entry(in, version, key, value);
+				reader.read(version, key, value);
 				if(version < new_version) {
 					if(!prev || *key != *prev) {
-						new_block->index.push_back(out.get_output_pos());
+						new_block->index.push_back(writer->get_pos());
+						new_block->bloom.add(calc_key_hash(*key));
 					}
 					new_block->max_version = std::max(version, new_block->max_version);
 					new_block->total_count++;
-					write_entry(out, version, key, value);
+					writer->write(version, *key, *value);
 					prev = key;
 				}
 			}
-			new_block->index_offset = out.get_output_pos();
+			writer->finish();
 
 			finish_block(new_block);
 			block->file.close();
 			rename(new_block, block->name);
 
 			debug_log << "Rewrote " << block->name << " with max_version = " << new_block->max_version
-					<< ", " << new_block->index.size() << " / " << new_block->total_count << " entries"
-					<< ", from " << block->index.size() << " / " << block->total_count << " entries"
+					<< ", " << new_block->index_size() << " / " << new_block->total_count << " entries"
+					<< ", from " << block->index_size() << " / " << block->total_count << " entries"
 					<< ", took " << (get_time_ms() - time_begin) / 1e3 << " sec" << std::endl;
 			block = new_block;
 		}
 		iter++;
 	}
+	set_blocks(blocks);
 
 	for(auto iter = mem_block.begin(); iter != mem_block.end();) {
 		const auto& key = iter->first;
 		if(key.second >= new_version) {
-			mem_block_size -= key.first->size + iter->second->size;
+			mem_block_size -= key.first.size + iter->second.size;
 			iter = mem_block.erase(iter);
 		} else {
 			iter++;
@@ -501,7 +912,7 @@ void Table::revert(const uint32_t new_version)
 		const auto& key = iter->first;
 		if(iter->second.second >= new_version) {
 			const auto found = mem_block.lower_bound(std::make_pair(key, -1));
-			if(found != mem_block.end() && *found->first.first == *key) {
+			if(found != mem_block.end() && found->first.first == key) {
 				iter->second = std::make_pair(found->second, found->first.second);
 				iter++;
 			} else {
@@ -511,6 +922,10 @@ void Table::revert(const uint32_t new_version)
 			iter++;
 		}
 	}
+	if(mem_block.empty()) {
+		mem_index.clear();
+		mem_arena.clear();
+	}
 	curr_version = new_version;
 	last_flush = std::min(last_flush, new_version);
 }
@@ -529,42 +944,51 @@ void Table::flush()
 		write_log.lock_exclusive();
 		{
 			const std::string cmd = "reset";
-			write_entry_sum(write_log.out, -1,
-					std::make_shared<db_val_t>(cmd.c_str(), cmd.size()),
-					std::make_shared<db_val_t>(&curr_version, sizeof(curr_version)));
+			write_entry_sum(write_log.out, -1, cmd, db_val_view(&curr_version, sizeof(curr_version)));
 		}
 		debug_log << "Force flushed at version " << curr_version << std::endl;
 		return;
 	}
 	const auto time_begin = get_time_ms();
 
+	if(codec && !codec->dict_id && options.dictionary_size) {
+		train_dictionary();
+	}
 	auto block = create_block(0, "flush.tmp");
 	block->index.reserve(mem_index.size());
+	block->bloom.init(mem_index.size(), options.bloom_bits_per_key);
 
-	auto& out = block->file.out;
-	block->file.seek_to(block_header_size);
+	const auto writer = create_writer(block);
 
-	std::shared_ptr<db_val_t> prev;
+	bool is_first = true;
+	db_val_view prev;
 	for(const auto& entry : mem_block) {
 		const auto& version = entry.first.second;
 		const auto& key = entry.first.first;
-		if(!prev || *key != *prev) {
-			block->index.push_back(out.get_output_pos());
+		if(is_first || key != prev) {
+			block->index.push_back(writer->get_pos());
+			block->bloom.add(calc_key_hash(key));
 		}
 		block->total_count++;
 		block->min_version = std::min(version, block->min_version);
 		block->max_version = std::max(version, block->max_version);
-		write_entry(out, version, key, entry.second);
+		writer->write(version, key, entry.second);
+		is_first = false;
 		prev = key;
 	}
-	block->index_offset = out.get_output_pos();
+	writer->finish();
 
 	finish_block(block);
 	rename(block, next_block_id++);
 
 	mem_index.clear();
 	mem_block.clear();
-	blocks.push_back(block);
+	mem_arena.clear();
+	{
+		auto list = std::make_shared<block_list_t>(*get_blocks());
+		list->push_back(block);
+		set_blocks(list);
+	}
 
 	mem_block_size = 0;
 
@@ -572,7 +996,7 @@ void Table::flush()
 	write_log.open("wb");
 	write_log.lock_exclusive();
 
-	debug_log << "Flushed " << block->name << " with " << block->index.size() << " / " << block->total_count
+	debug_log << "Flushed " << block->name << " with " << block->index_size() << " / " << block->total_count
 			<< " entries, min_version = " << block->min_version << ", max_version = " << block->max_version
 			<< ", took " << (get_time_ms() - time_begin) / 1e3 << " sec" << std::endl;
 
@@ -580,7 +1004,7 @@ void Table::flush()
 }
 
 std::shared_ptr<Table::block_t>
-Table::rewrite(std::list<std::shared_ptr<block_t>> blocks, const uint32_t level) const
+Table::rewrite(const block_list_t& blocks, const uint32_t level, const bool background) const
 {
 	if(blocks.empty()) {
 		throw std::logic_error("no blocks given");
@@ -590,12 +1014,13 @@ Table::rewrite(std::list<std::shared_ptr<block_t>> blocks, const uint32_t level)
 		if(block->level + 1 != level) {
 			throw std::logic_error("level mismatch");
 		}
-		total_index_entries += block->index.size();
+		total_index_entries += block->index_size();
 	}
 
 	struct pointer_t {
 		uint64_t offset = 0;
 		std::shared_ptr<block_t> block;
+		std::shared_ptr<block_reader_t> reader;
 		std::shared_ptr<db_val_t> value;
 	};
 	std::map<std::pair<std::shared_ptr<db_val_t>, uint32_t>, pointer_t, mem_compare_t> block_map(mem_compare_t(this));
@@ -604,46 +1029,74 @@ Table::rewrite(std::list<std::shared_ptr<block_t>> blocks, const uint32_t level)
 		if(!block->total_count) {
 			continue;
 		}
-		block->file.seek_to(block_header_size);
-
 		pointer_t entry;
 		entry.block = block;
+		// use separate file handle, since block is concurrently read from
+		auto file = std::make_shared<vnx::File>(root_path + '/' + block->name);
+		file->open("rb");
+		entry.reader = std::make_shared<block_reader_t>(block, file);
+
 		uint32_t version;
 		std::shared_ptr<db_val_t> key;
-		read_entry(block->file.in, version, key, entry.value);
+		entry.reader->read(version, key, entry.value);
 		block_map[std::make_pair(key, version)] = entry;
 	}
 
 	auto block = create_block(level, "rewrite.tmp");
-	block->index.reserve(total_index_entries);
-
-	auto& out = block->file.out;
-	block->file.seek_to(block_header_size);
-
-	std::shared_ptr<db_val_t> prev;
-	while(!block_map.empty()) {
-		const auto iter = block_map.begin();
-		const auto& key = iter->first.first;
-		const auto& version = iter->first.second;
-		if(!prev || *key != *prev) {
-			block->index.push_back(out.get_output_pos());
-		}
-		block->total_count++;
-		block->min_version = std::min(version, block->min_version);
-		block->max_version = std::max(version, block->max_version);
-		write_entry(out, version, key, iter->second.value);
-		prev = key;
+	try {
+		block->index.reserve(total_index_entries);
+		block->bloom.init(total_index_entries, options.bloom_bits_per_key);
+
+		const auto writer = create_writer(block);
+
+		const auto time_begin = get_time_ms();
+		const auto rate_limit = background ? options.compaction_rate_limit : 0;
+
+		std::shared_ptr<db_val_t> prev;
+		while(!block_map.empty()) {
+			const auto iter = block_map.begin();
+			const auto& key = iter->first.first;
+			const auto& version = iter->first.second;
+			if(!prev || *key != *prev) {
+				block->index.push_back(writer->get_pos());
+				block->bloom.add(calc_key_hash(*key));
+			}
+			block->total_count++;
+			block->min_version = std::min(version, block->min_version);
+			block->max_version = std::max(version, block->max_version);
+			writer->write(version, *key, *iter->second.value);
+			prev = key;
+
+			auto entry = iter->second;
+			if(++entry.offset < entry.block->total_count) {
+				uint32_t version;
+				std::shared_ptr<db_val_t> key;
+				entry.reader->read(version, key, entry.value);
+				block_map[std::make_pair(key, version)] = entry;
+			}
+			block_map.erase(iter);
 
-		auto entry = iter->second;
-		if(++entry.offset < entry.block->total_count) {
-			uint32_t version;
-			std::shared_ptr<db_val_t> key;
-			read_entry(entry.block->file.in, version, key, entry.value);
-			block_map[std::make_pair(key, version)] = entry;
+			if(background && block->total_count % 1024 == 0) {
+				if(do_abort) {
+					block->file.remove();
+					return nullptr;
+				}
+				if(rate_limit) {
+					// sleep in small steps to notice an abort
+					const int64_t target_ms = (block->file.out.get_output_pos() * 1000) / rate_limit;
+					int64_t elapsed_ms = 0;
+					while(!do_abort && target_ms > (elapsed_ms = get_time_ms() - time_begin)) {
+						std::this_thread::sleep_for(std::chrono::milliseconds(std::min<int64_t>(target_ms - elapsed_ms, 100)));
+					}
+				}
+			}
 		}
-		block_map.erase(iter);
+		writer->finish();
+	} catch(...) {
+		// discard partial output
+		block->file.remove();
+		throw;
 	}
-	block->index_offset = out.get_output_pos();
 
 	finish_block(block);
 	return block;
@@ -651,25 +1104,22 @@ Table::rewrite(std::list<std::shared_ptr<block_t>> blocks, const uint32_t level)
 
 void Table::check_rewrite()
 {
-	if(options.level_factor <= 1) {
+	if(options.level_factor <= 1 || is_closing || revert_pending || compaction_stats.is_running) {
 		return;
 	}
+	const auto blocks = get_blocks();
+
 	uint32_t level = 0;
-	auto iter_begin = blocks.begin();
-	auto iter_end = iter_begin;
-	std::list<std::shared_ptr<block_t>> selected;
-	for(auto iter = blocks.begin(); iter != blocks.end(); ++iter) {
-		const auto& block = *iter;
+	block_list_t selected;
+	for(const auto& block : *blocks) {
 		if(selected.empty() || block->level == level) {
 			selected.push_back(block);
 			if(selected.size() > options.level_factor) {
-				iter_end = iter;
 				break;
 			}
 		} else {
 			selected.clear();
 			selected.push_back(block);
-			iter_begin = iter;
 		}
 		level = block->level;
 	}
@@ -678,29 +1128,118 @@ void Table::check_rewrite()
 	}
 	selected.pop_back();
 
+	if(options.background_compaction) {
+		compaction_stats.is_running = true;
+		get_compaction_pool().add_task([this, selected, level]() {
+			compact(selected, level + 1);
+		});
+	} else {
+		const auto time_begin = get_time_ms();
+		finish_rewrite(selected, rewrite(selected, level + 1, false), time_begin);
+	}
+}
+
+void Table::compact(const block_list_t& selected, const uint32_t level)
+{
 	const auto time_begin = get_time_ms();
 
-	const auto block = rewrite(selected, level + 1);
-	rename(block, next_block_id++);
+	std::string error;
+	std::shared_ptr<block_t> block;
+	try {
+		block = rewrite(selected, level, true);
+	} catch(const std::exception& ex) {
+		error = ex.what();
+	}
+	std::lock_guard lock(mutex);
+
+	compaction_stats.is_running = false;
+	if(!error.empty()) {
+		debug_log << "Rewrite at level " << level << " failed with: " << error << std::endl;
+	}
+	finish_rewrite(selected, block, time_begin);
+
+	compaction_signal.notify_all();
+}
+
+void Table::finish_rewrite(const block_list_t& selected, std::shared_ptr<block_t> block, const int64_t time_begin)
+{
+	auto& stats = compaction_stats;
+	if(!block || !apply_rewrite(selected, block)) {
+		stats.num_aborted++;
+		debug_log << "Aborted rewrite of " << selected.size() << " blocks at level " << selected.front()->level << std::endl;
+		return;
+	}
+	const auto elapsed = get_time_ms() - time_begin;
+
+	stats.num_rewrites++;
+	stats.num_entries += block->total_count;
+	stats.num_bytes += block->index_offset;
+	stats.total_time_ms += elapsed;
+	stats.last_time_ms = elapsed;
+	stats.max_time_ms = std::max(stats.max_time_ms, elapsed);
+	stats.max_level = std::max(stats.max_level, block->level);
 
 	debug_log << "Wrote " << block->name << " at level " << block->level
-			<< " with " << block->index.size() << " / " << block->total_count
+			<< " with " << block->index_size() << " / " << block->total_count
 			<< " entries, min_version = " << block->min_version << ", max_version = " << block->max_version
-			<< ", took " << (get_time_ms() - time_begin) / 1e3 << " sec" << std::endl;
+			<< ", took " << elapsed / 1e3 << " sec" << std::endl;
 
-	for(const auto& block : selected) {
-		block->file.remove();
-		debug_log << "Deleted " << block->name << std::endl;
+	check_rewrite();
+}
+
+bool Table::apply_rewrite(const block_list_t& selected, std::shared_ptr<block_t> block)
+{
+	auto list = std::make_shared<block_list_t>(*get_blocks());
+
+	// make sure selected blocks are still in place
+	auto iter_begin = std::find(list->begin(), list->end(), selected.front());
+	auto iter_end = iter_begin;
+	for(const auto& entry : selected) {
+		if(iter_end == list->end() || *iter_end != entry) {
+			block->file.remove();
+			return false;
+		}
+		iter_end++;
 	}
-	blocks.insert(iter_begin, block);
-	blocks.erase(iter_begin, iter_end);
+	rename(block, next_block_id++);
 
-	check_rewrite();
+	for(const auto& entry : selected) {
+		entry->remove_on_close = true;
+		debug_log << "Deleted " << entry->name << std::endl;
+	}
+	list->insert(iter_begin, block);
+	list->erase(iter_begin, iter_end);
+	set_blocks(list);
+	return true;
+}
+
+std::shared_ptr<const Table::block_list_t> Table::get_blocks() const
+{
+	return std::atomic_load(&blocks);
+}
+
+void Table::set_blocks(std::shared_ptr<const block_list_t> list)
+{
+	std::atomic_store(&blocks, list);
+}
+
+void Table::wait_compaction()
+{
+	std::unique_lock lock(mutex);
+	while(compaction_stats.is_running) {
+		compaction_signal.wait(lock);
+	}
+}
+
+Table::compaction_stats_t Table::get_compaction_stats() const
+{
+	std::lock_guard lock(mutex);
+	return compaction_stats;
 }
 
 void Table::write_block_header(vnx::TypeOutput& out, std::shared_ptr<const block_t> block) const
 {
-	vnx::write(out, uint16_t(0));
+	vnx::write(out, uint16_t(block->codec != compression_t::NONE ? 2 : 1));
 	vnx::write(out, block->level);
 	vnx::write(out, block->min_version);
 	vnx::write(out, block->max_version);
@@ -714,6 +1253,127 @@ void Table::write_block_index(vnx::TypeOutput& out, std::shared_ptr<const block_
 	out.write(block->index.data(), block->index.size() * 8);
 }
 
+void Table::write_block_bloom(vnx::TypeOutput& out, std::shared_ptr<const block_t> block) const
+{
+	const auto& bloom = block->bloom;
+	vnx::write(out, bloom.num_hashes);
+	vnx::write(out, uint64_t(bloom.data.size()));
+	out.write(bloom.data.data(), bloom.data.size() * 8);
+}
+
+void Table::write_block_chunks(vnx::TypeOutput& out, std::shared_ptr<const block_t> block) const
+{
+	vnx::write(out, uint32_t(block->codec));
+	vnx::write(out, block->dict_id);
+	vnx::write(out, uint64_t(block->chunks.size()));
+	for(const auto& chunk : block->chunks) {
+		vnx::write(out, chunk.offset);
+		vnx::write(out, chunk.file_offset);
+		vnx::write(out, chunk.size);
+		vnx::write(out, chunk.raw_size);
+	}
+}
+
+std::shared_ptr<Table::block_writer_t> Table::create_writer(std::shared_ptr<block_t> block) const
+{
+	return std::make_shared<block_writer_t>(block, std::atomic_load(&codec), options.compression_chunk_size);
+}
+
+void Table::train_dictionary()
+{
+#ifdef WITH_ZSTD
+	const auto time_begin = get_time_ms();
+	const size_t max_samples_size = 100 * options.dictionary_size;
+	const size_t stride = (mem_block_size + mem_block.size() * 12) / max_samples_size + 1;
+
+	size_t i = 0;
+	std::vector<uint8_t> samples;
+	std::vector<size_t> sample_sizes;
+	for(const auto& entry : mem_block) {
+		if(i++ % stride) {
+			continue;
+		}
+		const auto& key = entry.first.first;
+		const size_t size = 12 + key.size + entry.second.size;
+		if(samples.size() + size > max_samples_size) {
+			break;
+		}
+		append_entry(samples, entry.first.second, key, entry.second);
+		sample_sizes.push_back(size);
+	}
+	if(sample_sizes.size() < 1000) {
+		return;		// not enough data yet
+	}
+	std::vector<uint8_t> dict(options.dictionary_size);
+	const auto res = ZDICT_trainFromBuffer(dict.data(), dict.size(), samples.data(), sample_sizes.data(), sample_sizes.size());
+	if(ZDICT_isError(res)) {
+		debug_log << "Training dictionary failed with: " << ZDICT_getErrorName(res) << std::endl;
+		return;
+	}
+	dict.resize(res);
+
+	const auto dict_codec = std::make_shared<db_codec_t>(dict, options.compression_level);
+	{
+		vnx::File file(root_path + "/dictionary.dat.tmp");
+		file.open("wb");
+		file.out.write(dict.data(), dict.size());
+		file.close();
+		file.rename(root_path + "/dictionary.dat");
+	}
+	codec_map[dict_codec->dict_id] = dict_codec;
+	std::atomic_store(&codec, std::shared_ptr<const db_codec_t>(dict_codec));
+
+	debug_log << "Trained dictionary with " << dict.size() << " bytes from " << sample_sizes.size() << " samples"
+			<< ", dict_id = " << dict_codec->dict_id << ", took " << (get_time_ms() - time_begin) / 1e3 << " sec" << std::endl;
+#endif
+}
+
+void Table::bloom_filter_t::init(const size_t num_keys, const size_t bits_per_key)
+{
+	data.clear();
+	num_hashes = 0;
+	if(num_keys && bits_per_key) {
+		num_hashes = std::max<uint32_t>(std::min<uint32_t>(uint32_t(bits_per_key * 0.69), 30), 1);
+		const auto num_blocks = (num_keys * bits_per_key + 511) / 512;
+		data.resize(num_blocks * 8);
+	}
+}
+
+void Table::bloom_filter_t::add(const uint64_t hash)
+{
+	if(data.empty()) {
+		return;
+	}
+	auto* block = data.data() + ((((hash >> 32) * (data.size() / 8)) >> 32) * 8);
+
+	uint32_t h = hash;
+	const uint32_t delta = (h >> 17) | (h << 15);
+	for(uint32_t i = 0; i < num_hashes; ++i) {
+		const auto bit = h & 511;
+		block[bit >> 6] |= uint64_t(1) << (bit & 63);
+		h += delta;
+	}
+}
+
+bool Table::bloom_filter_t::contains(const uint64_t hash) const
+{
+	if(data.empty()) {
+		return true;
+	}
+	const auto* block = data.data() + ((((hash >> 32) * (data.size() / 8)) >> 32) * 8);
+
+	uint32_t h = hash;
+	const uint32_t delta = (h >> 17) | (h << 15);
+	for(uint32_t i = 0; i < num_hashes; ++i) {
+		const auto bit = h & 511;
+		if(!(block[bit >> 6] & (uint64_t(1) << (bit & 63)))) {
+			return false;
+		}
+		h += delta;
+	}
+	return true;
+}
+
 std::shared_ptr<Table::block_t> Table::create_block(const uint32_t level, const std::string& name) const
 {
 	auto block = std::make_shared<block_t>();
@@ -733,6 +1393,10 @@ void Table::finish_block(std::shared_ptr<block_t> block) const
 
 	file.seek_to(block->index_offset);
 	write_block_index(file.out, block);
+	write_block_bloom(file.out, block);
+	if(block->codec != compression_t::NONE) {
+		write_block_chunks(file.out, block);
+	}
 
 	file.close();
 }
@@ -748,6 +1412,257 @@ void Table::rename(std::shared_ptr<block_t> block, const std::string& new_name)
 	block->file.rename(root_path + '/' + block->name);
 	block->file.open("rb");
 	block->file.lock_exclusive();
+
+	if(options.use_mmap) {
+		block->map();
+	}
+}
+
+Table::block_t::block_t()
+{
+	static std::atomic<uint64_t> next_uid {1};
+	uid = next_uid++;
+}
+
+Table::block_t::~block_t()
+{
+	unmap();
+	if(remove_on_close) {
+		file.remove();
+	}
+}
+
+void Table::block_t::map()
+{
+#ifndef _WIN32
+	if(map_data) {
+		return;
+	}
+	const int64_t file_size = file.file_size();
+	if(file_size <= 0 || index_offset + 8 + int64_t(index.size() * 8) > file_size) {
+		return;
+	}
+	void* ptr = ::mmap(nullptr, file_size, PROT_READ, MAP_SHARED, ::fileno(file.get_handle()), 0);
+	if(ptr == MAP_FAILED) {
+		return;		// fall back to file reads
+	}
+	::madvise(ptr, file_size, MADV_RANDOM);
+
+	map_data = (const uint8_t*)ptr;
+	map_size = file_size;
+	map_index = map_data + index_offset + 8;
+	map_index_size = index.size();
+	std::vector<int64_t>().swap(index);
+#endif
+}
+
+void Table::block_t::unmap()
+{
+#ifndef _WIN32
+	if(map_data) {
+		::munmap((void*)map_data, map_size);
+	}
+#endif
+	map_data = nullptr;
+	map_index = nullptr;
+	map_size = 0;
+	map_index_size = 0;
+}
+
+db_val_view Table::block_t::read_key_at(const int64_t offset, uint32_t& version, std::vector<uint8_t>& buffer) const
+{
+	db_val_view key;
+	if(codec != compression_t::NONE) {
+		size_t avail = 0;
+		const auto* data = find_entry(offset, avail);
+		parse_key(data, avail, version, key);
+		return key;
+	}
+	if(map_data) {
+		if(offset < 0 || offset > index_offset) {
+			throw std::logic_error("read_key_at(): offset out of bounds");
+		}
+		parse_key(map_data + offset, index_offset - offset, version, key);
+		return key;
+	}
+	mmx::read_key_at(file, offset, version, buffer);
+	return db_val_view(buffer);
+}
+
+db_val_view Table::block_t::read_value_at(const int64_t offset, const uint32_t key_size, std::vector<uint8_t>& buffer) const
+{
+	db_val_view value;
+	const auto value_offset = offset + 8 + key_size;
+	if(codec != compression_t::NONE) {
+		size_t avail = 0;
+		const auto* data = find_entry(value_offset, avail);
+		parse_value(data, avail, value);
+		return value;
+	}
+	if(map_data) {
+		if(offset < 0 || value_offset > index_offset) {
+			throw std::logic_error("read_value_at(): offset out of bounds");
+		}
+		parse_value(map_data + value_offset, index_offset - value_offset, value);
+		return value;
+	}
+	vnx::FileSectionInputStream stream(file.get_handle(), value_offset, -1, 1024);
+	vnx::TypeInput in(&stream);
+	read_value(in, buffer);
+	return db_val_view(buffer);
+}
+
+void Table::block_t::read_chunk(const size_t index, std::vector<uint8_t>& out, FILE* handle) const
+{
+	if(!codec_impl) {
+		throw std::logic_error("read_chunk(): block not compressed");
+	}
+	const auto& chunk = chunks.at(index);
+	if(map_data && !handle) {
+		if(chunk.file_offset < 0 || chunk.file_offset + int64_t(chunk.size) > map_size) {
+			throw std::logic_error("read_chunk(): chunk out of bounds");
+		}
+		codec_impl->decompress(map_data + chunk.file_offset, chunk.size, out, chunk.raw_size);
+		return;
+	}
+	thread_local std::vector<uint8_t> buffer;
+	buffer.resize(chunk.size);
+	vnx::FileSectionInputStream stream(handle ? handle : file.get_handle(), chunk.file_offset, chunk.size, 4096);
+	vnx::TypeInput in(&stream);
+	in.read(buffer.data(), buffer.size());
+	codec_impl->decompress(buffer.data(), buffer.size(), out, chunk.raw_size);
+}
+
+const std::vector<uint8_t>& Table::block_t::get_chunk(const size_t index) const
+{
+	struct entry_t {
+		uint64_t uid = 0;
+		size_t index = 0;
+		std::vector<uint8_t> data;
+	};
+	thread_local entry_t cache[8];
+	thread_local size_t next = 0;
+
+	for(const auto& entry : cache) {
+		if(entry.uid == uid && entry.index == index) {
+			return entry.data;
+		}
+	}
+	auto& entry = cache[next++ % 8];
+	entry.uid = 0;
+	read_chunk(index, entry.data);
+	entry.uid = uid;
+	entry.index = index;
+	return entry.data;
+}
+
+const uint8_t* Table::block_t::find_entry(const int64_t offset, size_t& avail) const
+{
+	auto iter = std::upper_bound(chunks.begin(), chunks.end(), offset,
+		[](const int64_t offset, const chunk_t& chunk) -> bool {
+			return offset < chunk.offset;
+		});
+	if(iter == chunks.begin()) {
+		throw std::logic_error("find_entry(): offset out of bounds");
+	}
+	iter--;
+	const uint64_t pos = offset - iter->offset;
+	if(pos >= iter->raw_size) {
+		throw std::logic_error("find_entry(): offset out of bounds");
+	}
+	const auto& data = get_chunk(iter - chunks.begin());
+	avail = data.size() - pos;
+	return data.data() + pos;
+}
+
+Table::block_writer_t::block_writer_t(std::shared_ptr<block_t> block, std::shared_ptr<const db_codec_t> codec, const size_t chunk_size)
+	:	block(block), codec(codec), chunk_size(std::max<size_t>(chunk_size, 1024))
+{
+	block->file.seek_to(block_header_size);
+	if(codec) {
+		block->codec = compression_t::ZSTD;
+		block->dict_id = codec->dict_id;
+		block->codec_impl = codec;
+		chunk_offset = block_header_size;
+	}
+}
+
+int64_t Table::block_writer_t::get_pos() const
+{
+	if(codec) {
+		return chunk_offset + chunk.size();
+	}
+	return block->file.out.get_output_pos();
+}
+
+void Table::block_writer_t::write(uint32_t version, const db_val_view& key, const db_val_view& value)
+{
+	if(codec) {
+		append_entry(chunk, version, key, value);
+		if(chunk.size() >= chunk_size) {
+			write_chunk();
+		}
+	} else {
+		write_entry(block->file.out, version, key, value);
+	}
+}
+
+void Table::block_writer_t::write_chunk()
+{
+	if(chunk.empty()) {
+		return;
+	}
+	auto& out = block->file.out;
+	chunk_t info;
+	info.offset = chunk_offset;
+	info.file_offset = out.get_output_pos();
+	info.raw_size = chunk.size();
+
+	codec->compress(chunk, buffer);
+	info.size = buffer.size();
+	out.write(buffer.data(), buffer.size());
+
+	block->chunks.push_back(info);
+	chunk_offset += chunk.size();
+	chunk.clear();
+}
+
+void Table::block_writer_t::finish()
+{
+	if(codec) {
+		write_chunk();
+	}
+	block->index_offset = block->file.out.get_output_pos();
+	block->data_end = codec ? chunk_offset : block->index_offset;
+}
+
+Table::block_reader_t::block_reader_t(std::shared_ptr<block_t> block, std::shared_ptr<vnx::File> file)
+	:	block(block), file(file)
+{
+	if(block->codec == compression_t::NONE) {
+		(file ? *file : block->file).seek_to(block_header_size);
+	}
+}
+
+void Table::block_reader_t::read(uint32_t& version, std::shared_ptr<db_val_t>& key, std::shared_ptr<db_val_t>& value)
+{
+	if(block->codec == compression_t::NONE) {
+		read_entry((file ? *file : block->file).in, version, key, value);
+		return;
+	}
+	if(chunk_pos >= chunk.size()) {
+		if(chunk_index >= block->chunks.size()) {
+			throw std::underflow_error("block_reader_t: end of block");
+		}
+		block->read_chunk(chunk_index++, chunk, file ? file->get_handle() : nullptr);
+		chunk_pos = 0;
+	}
+	db_val_view key_;
+	db_val_view value_;
+	chunk_pos += parse_key(chunk.data() + chunk_pos, chunk.size() - chunk_pos, version, key_);
+	chunk_pos += parse_value(chunk.data() + chunk_pos, chunk.size() - chunk_pos, value_);
+	key = make_val(key_);
+	value = make_val(value_);
 }
 
 Table::Iterator::Iterator(const Table* table)
@@ -829,8 +1744,10 @@ void Table::Iterator::prev()
 					next.block = block;
 					next.pos = pos;
 					uint32_t version;
-					std::shared_ptr<db_val_t> key;
-					read_entry_at(entry.block->file, block->index[pos], version, key, next.value);
+					std::vector<uint8_t> buffer;
+					const auto offset = block->get_index(pos);
+					const auto key = make_val(block->read_key_at(offset, version, buffer));
+					next.value = make_val(block->read_value_at(offset, key->size, buffer));
 					block_map[std::make_pair(key, version)] = next;
 				}
 			} else {
@@ -838,8 +1755,8 @@ void Table::Iterator::prev()
 					auto iter = entry.iter; iter--;
 					pointer_t next;
 					next.iter = iter;
-					next.value = iter->second.first;
-					block_map[std::make_pair(iter->first, iter->second.second)] = next;
+					next.value = make_val(iter->second.first);
+					block_map[std::make_pair(make_val(iter->first), iter->second.second)] = next;
 				}
 			}
 			iter = block_map.erase(iter);
@@ -862,13 +1779,15 @@ void Table::Iterator::next()
 			const auto& entry = iter->second;
 			if(const auto& block = entry.block) {
 				const auto pos = entry.pos + 1;
-				if(pos < block->index.size()) {
+				if(pos < block->index_size()) {
 					pointer_t next;
 					next.block = block;
 					next.pos = pos;
 					uint32_t version;
-					std::shared_ptr<db_val_t> key;
-					read_entry_at(entry.block->file, block->index[pos], version, key, next.value);
+					std::vector<uint8_t> buffer;
+					const auto offset = block->get_index(pos);
+					const auto key = make_val(block->read_key_at(offset, version, buffer));
+					next.value = make_val(block->read_value_at(offset, key->size, buffer));
 					block_map[std::make_pair(key, version)] = next;
 				}
 			} else {
@@ -876,8 +1795,8 @@ void Table::Iterator::next()
 				if(iter != table->mem_index.end()) {
 					pointer_t next;
 					next.iter = iter;
-					next.value = iter->second.first;
-					block_map[std::make_pair(iter->first, iter->second.second)] = next;
+					next.value = make_val(iter->second.first);
+					block_map[std::make_pair(make_val(iter->first), iter->second.second)] = next;
 				}
 			}
 			iter = block_map.erase(iter);
@@ -904,13 +1823,13 @@ void Table::Iterator::seek(std::shared_ptr<db_val_t> key)
 
 void Table::Iterator::seek(std::shared_ptr<db_val_t> key, const int mode)
 {
-	seek(table->blocks, key, mode);
+	seek(*table->get_blocks(), key, mode);
 
 	const auto& mem_index = table->mem_index;
 	if(!mem_index.empty()) {
 		auto iter = mem_index.begin();
 		if(key) {
-			iter = mem_index.lower_bound(key);
+			iter = mem_index.lower_bound(*key);
 		} else if(mode < 0) {
 			iter = mem_index.end();
 		}
@@ -928,20 +1847,21 @@ void Table::Iterator::seek(std::shared_ptr<db_val_t> key, const int mode)
 		if(iter != mem_index.end()) {
 			pointer_t entry;
 			entry.iter = iter;
-			entry.value = iter->second.first;
-			block_map[std::make_pair(iter->first, iter->second.second)] = entry;
+			entry.value = make_val(iter->second.first);
+			block_map[std::make_pair(make_val(iter->first), iter->second.second)] = entry;
 		}
 	}
 }
 
-void Table::Iterator::seek(const std::list<std::shared_ptr<block_t>>& blocks, std::shared_ptr<db_val_t> key, const int mode)
+void Table::Iterator::seek(const block_list_t& blocks, std::shared_ptr<db_val_t> key, const int mode)
 {
 	block_map.clear();
 	direction = mode >= 0 ? 1 : -1;
 
+	std::vector<uint8_t> buffer;
 	for(const auto& block : blocks)
 	{
-		const auto end = block->index.size();
+		const auto end = block->index_size();
 
 		bool is_match = false;
 		uint32_t version = -1;
@@ -952,7 +1872,7 @@ void Table::Iterator::seek(const std::list<std::shared_ptr<block_t>>& blocks, st
 		}
 		else if(mode == 0) {
 			if(pos < end) {
-				read_key_at(block->file, block->index[pos], version, res);
+				res = make_val(block->read_key_at(block->get_index(pos), version, buffer));
 			} else {
 				continue;
 			}
@@ -964,13 +1884,13 @@ void Table::Iterator::seek(const std::list<std::shared_ptr<block_t>>& blocks, st
 			if(pos == 0) {
 				continue;
 			}
-			read_key_at(block->file, block->index[--pos], version, res);
+			res = make_val(block->read_key_at(block->get_index(--pos), version, buffer));
 		}
 		else if(mode > 0) {
 			if(pos + 1 >= end) {
 				continue;
 			}
-			read_key_at(block->file, block->index[++pos], version, res);
+			res = make_val(block->read_key_at(block->get_index(++pos), version, buffer));
 		}
 		if(!res) {
 			continue;
@@ -978,7 +1898,7 @@ void Table::Iterator::seek(const std::list<std::shared_ptr<block_t>>& blocks, st
 		pointer_t entry;
 		entry.block = block;
 		entry.pos = pos;
-		read_value_at(block->file, block->index[pos], res, entry.value);
+		entry.value = make_val(block->read_value_at(block->get_index(pos), res->size, buffer));
 		block_map[std::make_pair(res, version)] = entry;
 	}
 }
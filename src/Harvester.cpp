@@ -50,6 +50,7 @@ void Harvester::main()
 	add_async_client(farmer_async);
 
 	threads = std::make_shared<vnx::ThreadPool>(num_threads, num_threads);
+	index_threads = std::make_shared<vnx::ThreadPool>(4);
 	lookup_timer = add_timer(std::bind(&Harvester::check_queue, this));
 
 	set_timer_millis(10000, std::bind(&Harvester::update, this));
@@ -63,6 +64,7 @@ void Harvester::main()
 
 	Super::main();
 
+	index_threads->close();
 	threads->close();
 }
 
@@ -172,9 +174,31 @@ void Harvester::lookup_task(std::shared_ptr<const Challenge> value, const int64_
 	};
 	const auto job = std::make_shared<lookup_job_t>();
 	job->total_plots = id_map.size();
-	job->num_left = job->total_plots;
 	job->time_begin = get_time_ms();
 
+	// only plots that pass the filter are dispatched
+	std::vector<hash_t> plot_ids;
+	plot_ids.reserve(id_map.size());
+	for(const auto& entry : id_map) {
+		plot_ids.push_back(entry.first);
+	}
+	const auto passed = check_plot_filter(params, value->challenge, plot_ids);
+
+	std::vector<std::shared_ptr<pos::Prover>> provers;
+	for(size_t i = 0; i < plot_ids.size(); ++i)
+	{
+		if(!passed[i]) {
+			continue;
+		}
+		const auto iter = plot_map.find(id_map.at(plot_ids[i]));
+		if(iter == plot_map.end()) {
+			log(WARN) << "Cannot find plot " << plot_ids[i].to_string();
+			continue;
+		}
+		provers.push_back(iter->second);
+	}
+	job->num_left = provers.size();
+
 	for(const auto& entry : plot_nfts) {
 		const auto& info = entry.second;
 		if(info.is_locked && info.server_url) {
@@ -188,25 +212,16 @@ void Harvester::lookup_task(std::shared_ptr<const Challenge> value, const int64_
 		}
 	}
 
-	for(const auto& entry : id_map)
+	for(const auto& prover : provers)
 	{
-		const auto iter = plot_map.find(entry.second);
-		if(iter == plot_map.end()) {
-			job->num_left--;
-			log(WARN) << "Cannot find plot " << entry.first.to_string();
-			continue;
-		}
-		const auto& plot_id = entry.first;
-		const auto& prover = iter->second;
-
-		threads->add_task([this, plot_id, prover, value, job, recv_time_ms]()
+		threads->add_task([this, prover, value, job, recv_time_ms]()
 		{
+			const auto& plot_id = prover->get_plot_id();
 			const auto header = prover->get_header();
 			const auto time_begin = get_time_ms();
 			const bool hard_fork = value->vdf_height >= params->hardfork1_height;
-			const bool passed_filter = check_plot_filter(params, value->challenge, plot_id);
 
-			if(passed_filter) try
+			try
 			{
 				const pool_conf_t* pool_config = nullptr;
 				if(auto contract = header->contract) {
@@ -317,13 +332,11 @@ void Harvester::lookup_task(std::shared_ptr<const Challenge> value, const int64_
 			const auto time_lookup = get_time_ms() - time_begin;
 			{
 				std::lock_guard<std::mutex> lock(job->mutex);
-				if(passed_filter) {
-					if(time_lookup > job->slow_time_ms) {
-						job->slow_time_ms = time_lookup;
-						job->slow_plot = prover->get_file_path();
-					}
-					job->num_passed++;
+				if(time_lookup > job->slow_time_ms) {
+					job->slow_time_ms = time_lookup;
+					job->slow_plot = prover->get_file_path();
 				}
+				job->num_passed++;
 				job->num_left--;
 			}
 			job->signal.notify_all();
@@ -556,6 +569,23 @@ void Harvester::reload()
 		}
 	}
 
+	// load Y park index in background, lookups fall back to searching until ready
+	if(plots.size()) {
+		const std::string index_path = storage_path + "plot_index/";
+		vnx::Directory(index_path).create();
+
+		for(const auto& entry : plots) {
+			const auto prover = entry.second;
+			index_threads->add_task([this, prover, index_path]() {
+				try {
+					prover->load_y_index(index_path + prover->get_plot_id().to_string() + ".dat");
+				} catch(const std::exception& ex) {
+					log(WARN) << "[" << my_name << "] Failed to load Y index for '" << prover->get_file_path() << "' due to: " << ex.what();
+				}
+			});
+		}
+	}
+
 	id_map.clear();
 	total_bytes = 0;
 	total_bytes_effective = 0;
@@ -143,7 +143,8 @@ void Node::main()
 	if(opencl_vdf.size()) {
 		opencl_vdf_enable = true;
 	} else {
-		max_vdf_verify_pending = 1;
+		// segments of all pending proofs share one worker pool, no need to limit
+		vdf_verifier = std::make_shared<vdf_verifier_t>();
 	}
 	threads = std::make_shared<vnx::ThreadPool>(num_threads);
 	api_threads = std::make_shared<vnx::ThreadPool>(num_api_threads);
@@ -162,22 +163,26 @@ void Node::main()
 	{
 		db = std::make_shared<DataBase>(num_db_threads);
 
-		db->open_async(txio_log, database_path + "txio_log");
-		db->open_async(exec_log, database_path + "exec_log");
+		// history tables are large and mostly scanned, compress them
+		auto log_options = Table::default_options;
+		log_options.compression = Table::compression_t::ZSTD;
+
+		db->open_async(txio_log, database_path + "txio_log", log_options);
+		db->open_async(exec_log, database_path + "exec_log", log_options);
 		db->open_async(memo_log, database_path + "memo_log");
 
 		db->open_async(contract_map, database_path + "contract_map");
-		db->open_async(contract_log, database_path + "contract_log");
+		db->open_async(contract_log, database_path + "contract_log", log_options);
 		db->open_async(contract_depends, database_path + "contract_depends");
 		db->open_async(deploy_map, database_path + "deploy_map");
 		db->open_async(owner_map, database_path + "owner_map");
 		db->open_async(swap_index, database_path + "swap_index");
 		db->open_async(offer_index, database_path + "offer_index");
-		db->open_async(trade_log, database_path + "trade_log");
+		db->open_async(trade_log, database_path + "trade_log", log_options);
 		db->open_async(trade_index, database_path + "trade_index");
 		db->open_async(swap_liquid_map, database_path + "swap_liquid_map");
 
-		db->open_async(tx_log, database_path + "tx_log");
+		db->open_async(tx_log, database_path + "tx_log", log_options);
 		db->open_async(tx_index, database_path + "tx_index");
 		db->open_async(height_map, database_path + "height_map");
 		db->open_async(balance_table, database_path + "balance_table");
@@ -206,7 +211,12 @@ void Node::main()
 		return nullptr;
 	};
 
-	blocks = std::make_shared<vnx::File>(database_path + "blocks.dat");
+	vnx::read_config(vnx_name + ".block_prune_depth", block_prune_depth);
+	vnx::read_config(vnx_name + ".sync_range_min", sync_range_min);
+	vnx::read_config(vnx_name + ".sync_range_max", sync_range_max);
+	sync_range_min = std::max<uint32_t>(sync_range_min, 1);
+
+	block_store = std::make_shared<block_store_t>(database_path + "block_data", database_path + "blocks.dat");
 	{
 		const auto height = std::min(db->min_version(), revert_height);
 		revert(height);
@@ -271,12 +281,16 @@ void Node::main()
 
 	Super::main();
 
-	blocks->close();
+	block_store->close();
 	threads->close();
 	api_threads->close();
 	vdf_threads->close();
 	fetch_threads->close();
 
+	if(vdf_verifier) {
+		vdf_verifier->close();
+	}
+
 	opencl_vdf.clear();
 
 #ifdef WITH_OPENCL
@@ -366,7 +380,7 @@ void Node::trigger_update()
 void Node::add_block(std::shared_ptr<const Block> block)
 {
 	try {
-		if(!block->is_valid()) {
+		if(is_header_only(block) ? !block->BlockHeader::is_valid() : !block->is_valid()) {
 			throw std::logic_error("invalid block");
 		}
 		// need to verify farmer_sig before adding to fork tree
@@ -379,7 +393,9 @@ void Node::add_block(std::shared_ptr<const Block> block)
 
 	const auto root = get_root();
 	if(block->height <= root->height) {
-		write_block(block, false);
+		if(!is_header_only(block)) {
+			write_block(block, false);
+		}
 		return;
 	}
 	auto fork = std::make_shared<fork_t>();
@@ -403,9 +419,18 @@ void Node::add_fork(std::shared_ptr<fork_t> fork)
 	}
 	fork->prev = find_fork(block->prev);
 
-	if(fork_tree.emplace(block->hash, fork).second) {
+	const auto ret = fork_tree.emplace(block->hash, fork);
+	if(ret.second) {
 		fork_index.emplace(block->height, fork);
 	}
+	else if(is_header_only(ret.first->second->block) && !is_header_only(block)) {
+		ret.first->second->block = block;		// got the body, keep verification state
+	}
+}
+
+bool Node::is_header_only(std::shared_ptr<const Block> block)
+{
+	return block->tx_list.empty() && block->tx_count;
 }
 
 void Node::add_transaction(std::shared_ptr<const Transaction> tx, const vnx::bool_t& pre_validate)
@@ -560,6 +585,9 @@ void Node::sync_more()
 	if(sync_pos > root->height && sync_pos - root->height > params->commit_delay + max_sync_ahead) {
 		return;		// limit blocks in memory during sync
 	}
+	if(sync_range_max && !sync_retry) {
+		sync_ranges();
+	}
 	const size_t max_pending = sync_retry ? 2 : std::max(std::min<int>(max_sync_pending, max_sync_jobs), 4);
 
 	while(sync_pending.size() < max_pending && (!sync_peak || sync_pos < *sync_peak)) {
@@ -567,6 +595,159 @@ void Node::sync_more()
 	}
 }
 
+void Node::sync_ranges()
+{
+	const auto now_ms = get_time_ms();
+	if(now_ms - sync_peers_time_ms > 10 * 1000) {
+		sync_peers_time_ms = now_ms;
+		router->get_peer_info(
+			[this](std::shared_ptr<const PeerInfo> info) {
+				sync_peers = info->peers;
+				sync_more();
+			},
+			[this](const vnx::exception& ex) {
+				log(WARN) << "get_peer_info() failed with: " << ex.what();
+			});
+	}
+	const auto root = get_root();
+	const uint32_t max_height = root->height + params->commit_delay + max_sync_ahead;
+
+	for(const auto& peer : sync_peers)
+	{
+		if(!peer.is_synced || peer.is_blocked) {
+			continue;
+		}
+		auto& state = sync_peer_map[peer.address];
+		if(state.is_busy || now_ms < state.retry_time_ms) {
+			continue;
+		}
+		if(!state.window) {
+			state.window = sync_range_min;
+		}
+		const auto count = std::min(state.window, sync_range_max);
+		const auto end = sync_pos + count;
+
+		// stay away from their peak, forks need to be fetched from multiple peers (per-height)
+		if(end + params->commit_delay > peer.height || end > max_height || (sync_peak && end > *sync_peak)) {
+			continue;
+		}
+		sync_range(peer.address, sync_pos, count);
+		sync_pos = end;
+	}
+}
+
+void Node::sync_range(const std::string& address, const uint32_t height, const uint32_t count)
+{
+	auto range = std::make_shared<sync_range_t>();
+	range->height = height;
+	range->address = address;
+	range->start_time_ms = get_time_ms();
+	range->blocks.resize(count);
+
+	sync_peer_map[address].is_busy = true;
+
+	// first and last block are cross-checked with min_sync_peers peers, same as per-height sync
+	const std::set<uint32_t> check = {height, height + count - 1};
+	range->num_pending = count + check.size();
+
+	// all requests are sent at once, so the peer streams the whole range
+	for(uint32_t i = 0; i < count; ++i) {
+		sync_pending.insert(height + i);
+		router->fetch_block_at(height + i, address,
+			[this, range, i](std::shared_ptr<const Block> block) {
+				range->blocks[i] = block;
+				if(--range->num_pending == 0) {
+					sync_range_result(range);
+				}
+			},
+			[this, range](const vnx::exception& ex) {
+				range->is_failed = true;
+				if(--range->num_pending == 0) {
+					sync_range_result(range);
+				}
+			});
+	}
+	for(const auto check_height : check) {
+		router->get_blocks_at(check_height,
+			[this, range, check_height](const std::vector<std::shared_ptr<const Block>>& blocks) {
+				range->checks[check_height] = blocks;
+				if(--range->num_pending == 0) {
+					sync_range_result(range);
+				}
+			},
+			[this, range](const vnx::exception& ex) {
+				range->is_failed = true;
+				if(--range->num_pending == 0) {
+					sync_range_result(range);
+				}
+			});
+	}
+}
+
+void Node::sync_range_result(std::shared_ptr<sync_range_t> range)
+{
+	const auto now_ms = get_time_ms();
+	const auto count = range->blocks.size();
+	const auto elapsed = std::max<int64_t>(now_ms - range->start_time_ms, 1) / 1e3;
+
+	auto& peer = sync_peer_map[range->address];
+	peer.is_busy = false;
+
+	// need a valid chain of blocks, otherwise fall back to per-height sync
+	bool is_valid = !range->is_failed;
+	bool is_invalid_data = false;
+	for(size_t i = 0; i < count && is_valid; ++i) {
+		const auto& block = range->blocks[i];
+		if(!block) {
+			is_valid = false;
+		} else if(block->height != range->height + i || !block->is_valid()) {
+			is_valid = false;
+			is_invalid_data = true;
+		} else if(i && block->prev != range->blocks[i - 1]->hash) {
+			is_valid = false;
+		}
+	}
+	// all peers asked need to agree on first and last block, otherwise there is a fork to resolve per-height
+	bool is_match = is_valid;
+	for(const auto& entry : range->checks) {
+		const auto& block = range->blocks[entry.first - range->height];
+		const auto& others = entry.second;
+		if(!block || others.size() != 1 || others[0]->hash != block->hash) {
+			is_match = false;
+		}
+	}
+	if(is_valid && is_match) {
+		const auto rate = count / elapsed;
+		peer.blocks_per_sec = peer.blocks_per_sec > 0 ? rate * 0.3 + peer.blocks_per_sec * 0.7 : rate;
+		// aim for about 2 sec per range, grow at most 2x at a time
+		peer.window = std::min<uint32_t>(peer.blocks_per_sec * 2, peer.window * 2);
+		peer.window = std::min(std::max(peer.window, sync_range_min), sync_range_max);
+
+		log(DEBUG) << "Got " << count << " blocks at height " << range->height << " from " << range->address
+				<< ", took " << elapsed << " sec, " << int(peer.blocks_per_sec) << " blocks/sec, next window " << peer.window;
+
+		for(size_t i = 0; i < count; ++i) {
+			sync_result(range->height + i, {range->blocks[i]});
+		}
+	} else {
+		// back off from this peer, disconnect if they sent us garbage
+		peer.window = sync_range_min;
+		peer.retry_time_ms = now_ms + 30 * 1000;
+		if(is_invalid_data) {
+			router->kick_peer(range->address);
+		}
+		log(DEBUG) << "Range sync at height " << range->height << " from " << range->address << " failed"
+				<< (is_invalid_data ? " (invalid)" : (is_valid ? " (mismatch)" : "")) << ", falling back to per-height";
+
+		// always re-queue, otherwise sync stalls
+		for(size_t i = 0; i < count; ++i) {
+			const auto height = range->height + i;
+			sync_pending.erase(height);
+			sync_height(height);
+		}
+	}
+}
+
 void Node::sync_height(const uint32_t& height)
 {
 	sync_pending.insert(height);
@@ -651,6 +832,21 @@ void Node::fetch_result(const hash_t& hash, std::shared_ptr<const Block> block)
 	if(block) {
 		add_block(block);
 	}
+	else if(auto fork = find_fork(hash)) {
+		if(is_header_only(fork->block)) {
+			// cannot follow it without a body, drop the header so it can be received again later
+			const auto height = fork->block->height;
+			const auto range = fork_index.equal_range(height);
+			for(auto iter = range.first; iter != range.second; ++iter) {
+				if(iter->second == fork) {
+					fork_index.erase(iter);
+					break;
+				}
+			}
+			fork_tree.erase(hash);
+			log(WARN) << "Failed to fetch body for block at height " << height << ", hash " << hash;
+		}
+	}
 	fetch_pending.erase(hash);
 }
 
@@ -1016,10 +1212,25 @@ size_t Node::prefetch_balances(const std::set<std::pair<addr_t, addr_t>>& keys)
 	if(keys.size() < 64) {
 		return 0;
 	}
+	// split sorted keys into a few batches, each batch shares one pass over the blocks
+	const size_t num_batches = std::min<size_t>(keys.size() / 64, 16);
+	std::vector<std::vector<std::pair<addr_t, addr_t>>> batches(num_batches);
+	{
+		size_t i = 0;
+		for(const auto& key : keys) {
+			batches[(i++ * num_batches) / keys.size()].push_back(key);
+		}
+	}
 	std::atomic<size_t> total {0};
-	for(const auto& key : keys) {
-		threads->add_task([this, &key, &total]() {
-			total += balance_table.count(key);
+	for(const auto& batch : batches) {
+		threads->add_task([this, &batch, &total]() {
+			try {
+				std::vector<std::pair<std::pair<addr_t, addr_t>, uint128>> result;
+				total += balance_table.find_many(batch, result);
+			} catch(const std::exception& ex) {
+				// only a cache warm-up, apply() will read (and fail on) the same keys again
+				log(DEBUG) << "prefetch_balances() failed with: " << ex.what();
+			}
 		});
 	}
 	threads->sync();
@@ -1117,6 +1328,7 @@ void Node::apply(	std::shared_ptr<const Block> block,
 			} else {
 				throw std::logic_error("storage == nullptr");
 			}
+			exec_conflict_ratio = context->conflict_ratio;
 		}
 
 		if(block->height) {
@@ -1142,14 +1354,30 @@ void Node::apply(	std::shared_ptr<const Block> block,
 			update_farmer_ranking();
 		}
 
-		write_block(block);
+		const auto offset = write_block(block);
 
 		height_map.insert(block->height, block->hash);
+		block_store->set_main(block->height, block->hash, offset);
 		contract_cache.clear();
 
 		state_hash = block->hash;
 
 		db->commit(block->height + 1);
+
+		// drop old segments, but never what is needed for history or a revert
+		const auto segment_size = block_store->get_segment_size();
+		if(block_prune_depth && block->height % segment_size == 0) {
+			const uint32_t depth = std::max<uint32_t>(block_prune_depth, max_history + params->commit_delay);
+			if(block->height > depth) {
+				try {
+					if(const auto count = block_store->prune(block->height - depth)) {
+						log(INFO) << "Pruned " << count << " block segments below height " << block->height - depth;
+					}
+				} catch(const std::exception& ex) {
+					log(WARN) << "Failed to prune blocks: " << ex.what();
+				}
+			}
+		}
 	}
 	catch(const std::exception& ex) {
 		try {
@@ -1324,6 +1552,7 @@ void Node::revert(const uint32_t height)
 	}
 
 	db->revert(height);
+	block_store->revert_main(height);
 
 	uint32_t peak = 0;
 	if(!height_map.find_last(peak, state_hash)) {
@@ -1364,7 +1593,7 @@ void Node::reset()
 	uint32_t height = 0;
 	if(height_map.find_last(height, state_hash))
 	{
-		blocks->open("rb+");
+		sync_header_ring(height);
 
 		// check consistency
 		while(true) {
@@ -1418,8 +1647,7 @@ void Node::reset()
 		});
 	}
 	else {
-		blocks->open("wb");
-		blocks->open("rb+");
+		block_store->clear();
 		db_blocks->revert(0);
 		init_chain();
 	}
@@ -1459,7 +1687,11 @@ std::shared_ptr<const BlockHeader> Node::find_prev(	std::shared_ptr<const BlockH
 															const size_t distance, bool clamped) const
 {
 	for(size_t i = 0; block && i < distance && (block->height || !clamped); ++i) {
-		block = get_header(block->prev);
+		if(block->height) {
+			block = get_block_ex(block->prev, false, block->height - 1);
+		} else {
+			block = get_header(block->prev);
+		}
 	}
 	return block;
 }
@@ -1828,53 +2060,28 @@ vnx::optional<addr_t> Node::get_vdf_reward_winner(std::shared_ptr<const BlockHea
 }
 
 std::shared_ptr<const BlockHeader> Node::read_block(
-		vnx::File& file, bool full_block, std::vector<int64_t>* tx_offsets) const
+		const int64_t offset, bool full_block, std::vector<int64_t>* tx_offsets) const
 {
 	// THREAD SAFE (for concurrent reads)
-	auto& in = file.in;
-	if(tx_offsets) {
-		tx_offsets->clear();
+	if(block_store->is_pruned(offset)) {
+		throw std::runtime_error("block data has been pruned (block_prune_depth)");
 	}
 	try {
-		if(auto header = std::dynamic_pointer_cast<const BlockHeader>(vnx::read(in))) {
-			if(full_block) {
-				auto block = Block::create();
-				block->BlockHeader::operator=(*header);
-				while(true) {
-					const auto offset = in.get_input_pos();
-					if(auto value = vnx::read(in)) {
-						if(auto tx = std::dynamic_pointer_cast<const Transaction>(value)) {
-							if(tx_offsets) {
-								tx_offsets->push_back(offset);
-							}
-							block->tx_list.push_back(tx);
-						} else {
-							throw std::logic_error("expected transaction");
-						}
-					} else {
-						break;
-					}
-				}
-				header = block;
-			}
-			return header;
-		}
+		return block_store->read(offset, full_block, tx_offsets);
 	} catch(const std::exception& ex) {
 		log(WARN) << "Failed to read block: " << ex.what();
 	}
 	return nullptr;
 }
 
-void Node::write_block(std::shared_ptr<const Block> block, const bool is_main)
+int64_t Node::write_block(std::shared_ptr<const Block> block, const bool is_main)
 {
 	try {
 		block_index_t index;
 		if(block_index.find(block->hash, index))
 		{
-			blocks->seek_to(index.file_offset);
-
 			std::vector<int64_t> tx_offsets;
-			if(auto block = read_block(*blocks, true, &tx_offsets)) {
+			if(auto block = read_block(index.file_offset, true, &tx_offsets)) {
 				if(!block->is_valid()) {
 					throw std::logic_error("invalid block");
 				}
@@ -1893,30 +2100,20 @@ void Node::write_block(std::shared_ptr<const Block> block, const bool is_main)
 					tx_index.insert(tx->id, tx->get_tx_index(params, block, tx_offsets[i]));
 				}
 			}
-			return;
+			return index.file_offset;
 		}
 	} catch(const std::exception& ex) {
 		log(WARN) << "Stored block at height " << block->height << " is corrupted: " << ex.what();
 	}
-	blocks->seek_end();
-	auto& out = blocks->out;
-	const auto offset = out.get_output_pos();
+	std::vector<int64_t> tx_offsets;
+	const auto offset = block_store->write(block, &tx_offsets);
 
-	vnx::write(out, block->get_header());
-
-	std::vector<std::pair<hash_t, tx_index_t>> tx_list;
-	for(const auto& tx : block->tx_list) {
-		if(is_main) {
-			tx_list.emplace_back(tx->id, tx->get_tx_index(params, block, out.get_output_pos()));
+	if(is_main) {
+		for(size_t i = 0; i < block->tx_list.size(); ++i) {
+			const auto& tx = block->tx_list[i];
+			tx_index.insert(tx->id, tx->get_tx_index(params, block, tx_offsets[i]));
 		}
-		vnx::write(out, tx);
-	}
-	for(const auto& entry : tx_list) {
-		tx_index.insert(entry.first, entry.second);
 	}
-	vnx::write(out, nullptr);	// end of block
-	blocks->flush();
-
 	block_index.insert(block->hash, block->get_block_index(offset));
 	{
 		std::vector<hash_t> list;
@@ -1926,6 +2123,42 @@ void Node::write_block(std::shared_ptr<const Block> block, const bool is_main)
 		}
 	}
 	db_blocks->commit(db_blocks->version() + 1);
+	return offset;
+}
+
+void Node::sync_header_ring(const uint32_t height)
+{
+	const auto time_begin = get_time_ms();
+	const auto ring_size = block_store->get_ring_size();
+	const uint32_t begin = height >= ring_size ? height - ring_size + 1 : 0;
+
+	// ring is not part of DB, may be stale after a crash or when it was missing
+	block_store->revert_main(height + 1, true);
+
+	std::vector<std::pair<uint32_t, hash_t>> list;
+	height_map.find_range(begin, height + 1, list);
+
+	std::vector<hash_t> missing;
+	std::unordered_map<hash_t, uint32_t> height_of;
+	for(const auto& entry : list) {
+		hash_t hash;
+		int64_t offset = 0;
+		if(!block_store->find_main(entry.first, hash, offset) || hash != entry.second) {
+			block_store->erase_main(entry.first);
+			missing.push_back(entry.second);
+			height_of[entry.second] = entry.first;
+		}
+	}
+	if(missing.empty()) {
+		return;
+	}
+	std::vector<std::pair<hash_t, block_index_t>> found;
+	block_index.find_many(missing, found);
+
+	for(const auto& entry : found) {
+		block_store->set_main(height_of[entry.first], entry.first, entry.second.file_offset);
+	}
+	log(INFO) << "Updated " << found.size() << " header ring entries, took " << (get_time_ms() - time_begin) / 1e3 << " sec";
 }
 
 
@@ -136,8 +136,8 @@ std::shared_ptr<const NetworkInfo> Node::get_network_info() const
 
 hash_t Node::get_genesis_hash() const
 {
-	if(auto block = get_header_at(0)) {
-		return block->hash;
+	if(auto hash = get_block_hash(0)) {
+		return *hash;		// block data may be pruned
 	}
 	throw std::logic_error("have no genesis");
 }
@@ -171,12 +171,15 @@ std::shared_ptr<const Block> Node::get_block(const hash_t& hash) const
 	return std::dynamic_pointer_cast<const Block>(get_block_ex(hash, true));
 }
 
-std::shared_ptr<const BlockHeader> Node::get_block_ex(const hash_t& hash, bool full_block) const
+std::shared_ptr<const BlockHeader> Node::get_block_ex(const hash_t& hash, bool full_block, const vnx::optional<uint32_t>& height) const
 {
 	// THREAD SAFE (for concurrent reads)
 	auto iter = fork_tree.find(hash);
 	if(iter != fork_tree.end()) {
-		return iter->second->block;
+		const auto& block = iter->second->block;
+		if(!full_block || !is_header_only(block)) {
+			return block;
+		}
 	}
 	if(!full_block) {
 		auto iter = history.find(hash);
@@ -184,12 +187,16 @@ std::shared_ptr<const BlockHeader> Node::get_block_ex(const hash_t& hash, bool f
 			return iter->second;
 		}
 	}
+	if(height) {
+		hash_t main_hash;
+		int64_t offset = 0;
+		if(block_store->find_main(*height, main_hash, offset) && main_hash == hash) {
+			return read_block(offset, full_block);
+		}
+	}
 	block_index_t entry;
 	if(block_index.find(hash, entry)) {
-		vnx::File file(blocks->get_path());
-		file.open("rb");
-		file.seek_to(entry.file_offset);
-		return read_block(file, full_block);
+		return read_block(entry.file_offset, full_block);
 	}
 	return nullptr;
 }
@@ -201,6 +208,13 @@ std::shared_ptr<const Block> Node::get_block_at(const uint32_t& height) const
 
 std::shared_ptr<const BlockHeader> Node::get_block_at_ex(const uint32_t& height, bool full_block) const
 {
+	{
+		hash_t hash;
+		int64_t offset = 0;
+		if(block_store->find_main(height, hash, offset)) {
+			return get_block_ex(hash, full_block, height);
+		}
+	}
 	if(auto hash = get_block_hash(height)) {
 		return get_block_ex(*hash, full_block);
 	}
@@ -209,7 +223,11 @@ std::shared_ptr<const BlockHeader> Node::get_block_at_ex(const uint32_t& height,
 
 std::shared_ptr<const BlockHeader> Node::get_header(const hash_t& hash) const
 {
-	return get_block_ex(hash, false);
+	auto header = get_block_ex(hash, false);
+	if(auto block = std::dynamic_pointer_cast<const Block>(header)) {
+		return block->get_header();		// don't send transactions
+	}
+	return header;
 }
 
 std::shared_ptr<const BlockHeader> Node::get_header_at(const uint32_t& height) const
@@ -220,6 +238,10 @@ std::shared_ptr<const BlockHeader> Node::get_header_at(const uint32_t& height) c
 vnx::optional<hash_t> Node::get_block_hash(const uint32_t& height) const
 {
 	hash_t hash;
+	int64_t offset = 0;
+	if(block_store->find_main(height, hash, offset)) {
+		return hash;
+	}
 	if(height_map.find(height, hash)) {
 		return hash;
 	}
@@ -359,13 +381,10 @@ std::shared_ptr<const Transaction> Node::get_transaction(const hash_t& id, const
 	}
 	tx_index_t entry;
 	if(tx_index.find(id, entry)) {
-		vnx::File file(blocks->get_path());
-		file.open("rb");
-		file.seek_to(entry.file_offset);
-		const auto value = vnx::read(file.in);
-		if(auto tx = std::dynamic_pointer_cast<const Transaction>(value)) {
-			return tx;
+		if(block_store->is_pruned(entry.file_offset)) {
+			throw std::runtime_error("transaction data has been pruned (block_prune_depth): " + id.to_string());
 		}
+		return block_store->read_tx(entry.file_offset);
 	}
 	return nullptr;
 }
@@ -864,7 +883,7 @@ std::map<vm::varptr_t, vm::varptr_t> Node::read_storage_map(const addr_t& contra
 		if(auto bin = std::dynamic_pointer_cast<const contract::Binary>(get_contract(exec->binary))) {
 			auto engine = std::make_shared<vm::Engine>(contract, storage, true);
 			engine->gas_limit = params->max_tx_cost;
-			vm::load(engine, bin);
+			vm::load(engine, bin, exec->binary);
 			for(const auto& entry : storage->find_entries(contract, address, height)) {
 				// need to use engine to support constant keys
 				if(auto key = engine->read(entry.first)) {
@@ -898,7 +917,7 @@ vnx::Variant Node::call_contract(
 			}
 			auto engine = std::make_shared<vm::Engine>(address, storage, func->is_const);
 			engine->gas_limit = params->max_tx_cost;
-			vm::load(engine, bin);
+			vm::load(engine, bin, exec->binary);
 			engine->write(vm::MEM_EXTERN + vm::EXTERN_TXID, vm::var_t());
 			engine->write(vm::MEM_EXTERN + vm::EXTERN_HEIGHT, vm::uint_t(get_height()));
 			engine->write(vm::MEM_EXTERN + vm::EXTERN_ADDRESS, vm::to_binary(address));
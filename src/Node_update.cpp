@@ -283,6 +283,19 @@ void Node::update()
 			break;	// no change
 		}
 
+		// headers-first: only fetch bodies once we decide to follow a fork
+		size_t num_missing = 0;
+		for(const auto& fork : get_fork_line(best_fork)) {
+			if(is_header_only(fork->block)) {
+				fetch_block(fork->block->hash);
+				num_missing++;
+			}
+		}
+		if(num_missing) {
+			log(DEBUG) << "Waiting for " << num_missing << " block bodies to fork to height " << best_fork->block->height;
+			break;
+		}
+
 		// verify and apply new fork
 		try {
 			forked_at = fork_to(best_fork);
@@ -704,11 +717,17 @@ void Node::validate_new()
 	}
 
 	// verify transactions in parallel
+	std::vector<tx_pool_t*> exec_list;
+	std::vector<hash_t> exec_ids;
 	for(auto& entry : tx_list) {
-		if(!entry.is_valid) {
-			continue;
+		if(entry.is_valid) {
+			exec_list.push_back(&entry);
+			exec_ids.push_back(entry.tx->id);
 		}
-		threads->add_task([this, &entry, context, deadline_ms]() {
+	}
+	execute_tx_list(context, exec_ids,
+		[this, &exec_list, context, deadline_ms](const size_t i) {
+			auto& entry = *exec_list[i];
 			if(get_time_ms() > deadline_ms) {
 				entry.is_skipped = true;
 				return;
@@ -721,7 +740,6 @@ void Node::validate_new()
 				tmp->reset(params);
 				tx = tmp;
 			}
-			context->wait(tx->id);
 			try {
 				if(auto result = validate(tx, context)) {
 					entry.cost = result->total_cost;
@@ -735,10 +753,7 @@ void Node::validate_new()
 			} catch(...) {
 				// ignore
 			}
-			context->signal(tx->id);
 		});
-	}
-	threads->sync();
 
 	// update tx pool
 	for(const auto& entry : tx_list) {
@@ -793,11 +808,17 @@ std::vector<Node::tx_pool_t> Node::validate_for_block(const int64_t deadline_ms)
 	}
 
 	// verify transactions in parallel
+	std::vector<tx_pool_t*> exec_list;
+	std::vector<hash_t> exec_ids;
 	for(auto& entry : tx_list) {
-		if(!entry.is_valid) {
-			continue;
+		if(entry.is_valid) {
+			exec_list.push_back(&entry);
+			exec_ids.push_back(entry.tx->id);
 		}
-		threads->add_task([this, &entry, context, deadline_ms]() {
+	}
+	execute_tx_list(context, exec_ids,
+		[this, &exec_list, context, deadline_ms](const size_t i) {
+			auto& entry = *exec_list[i];
 			if(get_time_ms() > deadline_ms) {
 				entry.is_skipped = true;
 				return;
@@ -810,7 +831,6 @@ std::vector<Node::tx_pool_t> Node::validate_for_block(const int64_t deadline_ms)
 				tmp->reset(params);
 				tx = tmp;
 			}
-			context->wait(tx->id);
 			try {
 				auto result = validate(tx, context);
 				if(!result) {
@@ -829,10 +849,7 @@ std::vector<Node::tx_pool_t> Node::validate_for_block(const int64_t deadline_ms)
 			} catch(...) {
 				// ignore
 			}
-			context->signal(tx->id);
 		});
-	}
-	threads->sync();
 
 	uint32_t num_skipped = 0;
 	uint64_t total_cost = 0;
@@ -16,6 +16,7 @@
 #include <mmx/operation/Deposit.hxx>
 #include <mmx/utils.h>
 #include <mmx/vm_interface.h>
+#include <mmx/vm/StorageTracker.h>
 #include <mmx/exception.h>
 #include <mmx/error_code_e.hxx>
 #include <mmx/txio_t.hpp>
@@ -25,38 +26,6 @@
 
 namespace mmx {
 
-void Node::execution_context_t::wait(const hash_t& txid) const
-{
-	auto iter = wait_map.find(txid);
-	if(iter != wait_map.end()) {
-		for(const auto& prev : iter->second) {
-			auto iter = signal_map.find(prev);
-			if(iter != signal_map.end()) {
-				auto& entry = iter->second;
-				{
-					std::unique_lock<std::mutex> lock(entry->mutex);
-					while(entry->do_wait) {
-						entry->signal.wait(lock);
-					}
-				}
-			}
-		}
-	}
-}
-
-void Node::execution_context_t::signal(const hash_t& txid) const
-{
-	auto iter = signal_map.find(txid);
-	if(iter != signal_map.end()) {
-		auto& entry = iter->second;
-		{
-			std::lock_guard lock(entry->mutex);
-			entry->do_wait = false;
-		}
-		entry->signal.notify_all();
-	}
-}
-
 void Node::execution_context_t::setup_wait(const hash_t& txid, const addr_t& address)
 {
 	const auto& list = mutate_map[address];
@@ -98,9 +67,33 @@ void Node::prepare_context(std::shared_ptr<execution_context_t> context, std::sh
 		context->setup_wait(tx->id, address);
 		context->mutate_map[address].push_back(tx->id);
 	}
-	if(!mutate_set.empty()) {
-		context->signal_map.emplace(tx->id, std::make_shared<waitcond_t>());
+}
+
+dag_scheduler_t::stats_t Node::execute_tx_list(
+		std::shared_ptr<const execution_context_t> context, const std::vector<hash_t>& tx_ids,
+		const std::function<void(const size_t)>& func) const
+{
+	dag_scheduler_t scheduler;
+	std::unordered_map<hash_t, size_t> index_map;
+	index_map.reserve(tx_ids.size());
+
+	for(size_t i = 0; i < tx_ids.size(); ++i) {
+		index_map[tx_ids[i]] = scheduler.add_task([&func, i]() {
+			func(i);
+		});
+	}
+	for(size_t i = 0; i < tx_ids.size(); ++i) {
+		auto iter = context->wait_map.find(tx_ids[i]);
+		if(iter != context->wait_map.end()) {
+			for(const auto& prev : iter->second) {
+				auto iter = index_map.find(prev);
+				if(iter != index_map.end() && iter->second < i) {
+					scheduler.add_depend(i, iter->second);
+				}
+			}
+		}
 	}
+	return scheduler.run(*threads, num_threads);
 }
 
 std::shared_ptr<Node::execution_context_t> Node::validate(std::shared_ptr<const Block> block) const
@@ -232,6 +225,9 @@ std::shared_ptr<Node::execution_context_t> Node::validate(std::shared_ptr<const
 		throw std::logic_error("invalid project_addr");
 	}
 
+	// check all signatures in parallel, tx validation will hit the cache
+	signature_t::verify_many(get_signatures(block->tx_list));
+
 	{
 		std::set<std::pair<addr_t, addr_t>> keys;
 		for(const auto& tx : block->tx_list) {
@@ -323,22 +319,37 @@ std::shared_ptr<Node::execution_context_t> Node::validate(std::shared_ptr<const
 	std::mutex mutex;
 	std::exception_ptr failed_ex;
 
-	for(const auto& tx : block->tx_list) {
-		threads->add_task([this, tx, context, &mutex, &failed_tx, &failed_ex]() {
-			context->wait(tx->id);
-			try {
-				if(validate(tx, context)) {
-					throw std::logic_error("missing exec_result");
+	// fall back to static scheduling while too many transactions conflict
+	if(block->tx_list.size() > 1 && exec_conflict_ratio < 0.5) {
+		context->conflict_ratio = execute_optimistic(block, context, failed_tx, failed_ex);
+	} else {
+		std::vector<hash_t> tx_ids;
+		tx_ids.reserve(block->tx_list.size());
+		for(const auto& tx : block->tx_list) {
+			tx_ids.push_back(tx->id);
+		}
+		const auto stats = execute_tx_list(context, tx_ids,
+			[this, block, context, &mutex, &failed_tx, &failed_ex](const size_t i) {
+				const auto& tx = block->tx_list[i];
+				try {
+					if(validate(tx, context)) {
+						throw std::logic_error("missing exec_result");
+					}
+				} catch(...) {
+					std::lock_guard<std::mutex> lock(mutex);
+					failed_tx = tx->id;
+					failed_ex = std::current_exception();
 				}
-			} catch(...) {
-				std::lock_guard<std::mutex> lock(mutex);
-				failed_tx = tx->id;
-				failed_ex = std::current_exception();
-			}
-			context->signal(tx->id);
-		});
+			});
+
+		if(stats.num_tasks) {
+			log(DEBUG) << "Executed " << stats.num_tasks << " transactions at height " << block->height
+					<< " with critical path = " << stats.max_depth << " / " << stats.critical_path_us / 1e3 << " ms"
+					<< ", parallelism = " << stats.get_parallelism() << ", steals = " << stats.num_steals
+					<< ", took " << stats.wall_time_us / 1e3 << " ms";
+		}
+		context->conflict_ratio = exec_conflict_ratio / 2;
 	}
-	threads->sync();
 
 	if(failed_ex) {
 		try {
@@ -361,6 +372,74 @@ std::shared_ptr<Node::execution_context_t> Node::validate(std::shared_ptr<const
 	return context;
 }
 
+double Node::execute_optimistic(std::shared_ptr<const Block> block, std::shared_ptr<const execution_context_t> context,
+								hash_t& failed_tx, std::exception_ptr& failed_ex) const
+{
+	struct result_t {
+		bool do_commit = false;
+		std::exception_ptr error;
+		std::shared_ptr<vm::StorageTracker> tracker;
+		std::shared_ptr<vm::StorageCache> storage;
+	};
+	const auto time_begin = get_time_us();
+	const auto& tx_list = block->tx_list;
+	std::vector<result_t> results(tx_list.size());
+
+	// execute all transactions in parallel against the same block state, recording what they read
+	for(size_t i = 0; i < tx_list.size(); ++i) {
+		threads->add_task([this, &tx_list, &results, context, i]() {
+			auto& out = results[i];
+			out.tracker = std::make_shared<vm::StorageTracker>(context->storage);
+			out.storage = std::make_shared<vm::StorageCache>(out.tracker);
+			try {
+				if(validate(tx_list[i], context, out.storage, out.do_commit)) {
+					throw std::logic_error("missing exec_result");
+				}
+			} catch(...) {
+				out.error = std::current_exception();
+			}
+		});
+	}
+	threads->sync();
+
+	const auto time_mid = get_time_us();
+
+	// commit in block order, re-execute if anything read was written by a previous transaction
+	size_t num_conflicts = 0;
+	vm::access_set_t write_set;
+	for(size_t i = 0; i < tx_list.size(); ++i) {
+		const auto& tx = tx_list[i];
+		auto& out = results[i];
+		if(out.tracker->get_read_set().intersects(write_set)) {
+			num_conflicts++;
+			out = result_t();
+			out.storage = std::make_shared<vm::StorageCache>(context->storage);
+			try {
+				if(validate(tx, context, out.storage, out.do_commit)) {
+					throw std::logic_error("missing exec_result");
+				}
+			} catch(...) {
+				out.error = std::current_exception();
+			}
+		}
+		if(out.error) {
+			failed_tx = tx->id;
+			failed_ex = out.error;
+			return double(num_conflicts) / tx_list.size();
+		}
+		if(out.do_commit) {
+			write_set.add_writes(*out.storage);
+			out.storage->commit();
+		}
+		out = result_t();
+	}
+	log(DEBUG) << "Executed " << tx_list.size() << " transactions at height " << block->height
+			<< " optimistically with " << num_conflicts << " conflicts, took " << (time_mid - time_begin) / 1e3
+			<< " + " << (get_time_us() - time_mid) / 1e3 << " ms";
+
+	return double(num_conflicts) / tx_list.size();
+}
+
 exec_result_t Node::validate(std::shared_ptr<const Transaction> tx) const
 {
 	if(tx->exec_result) {
@@ -489,7 +568,7 @@ void Node::execute(	std::shared_ptr<const Transaction> tx,
 			throw std::logic_error("method is not public: " + method_name);
 		}
 	}
-	vm::load(engine, binary);
+	vm::load(engine, binary, executable->binary);
 
 	std::map<addr_t, std::shared_ptr<const Contract>> contract_cache;
 	contract_cache[tx->id] = tx->deploy;
@@ -580,6 +659,22 @@ std::shared_ptr<const exec_result_t>
 Node::validate(	std::shared_ptr<const Transaction> tx,
 				std::shared_ptr<const execution_context_t> context) const
 {
+	bool do_commit = false;
+	const auto storage_cache = std::make_shared<vm::StorageCache>(context->storage);
+	const auto result = validate(tx, context, storage_cache, do_commit);
+	if(do_commit) {
+		storage_cache->commit();
+	}
+	return result;
+}
+
+std::shared_ptr<const exec_result_t>
+Node::validate(	std::shared_ptr<const Transaction> tx,
+				std::shared_ptr<const execution_context_t> context,
+				std::shared_ptr<vm::StorageCache> storage_cache, bool& do_commit) const
+{
+	do_commit = false;
+
 	if(!tx->is_valid(params)) {
 		throw mmx::static_failure("invalid tx");
 	}
@@ -600,7 +695,6 @@ Node::validate(	std::shared_ptr<const Transaction> tx,
 	std::vector<txin_t> exec_inputs;
 	std::vector<txout_t> exec_outputs;
 	balance_cache_t balance_cache(&balance_table);
-	auto storage_cache = std::make_shared<vm::StorageCache>(context->storage);
 	std::unordered_map<addr_t, uint128> amounts;
 	std::map<std::pair<addr_t, addr_t>, uint128> deposit_map;
 	std::map<std::pair<addr_t, addr_t>, uint128> exec_spend_map;
@@ -920,9 +1014,7 @@ Node::validate(	std::shared_ptr<const Transaction> tx,
 		}
 	}
 
-	if(!failed_ex) {
-		storage_cache->commit();
-	}
+	do_commit = !failed_ex;
 	return out;
 }
 
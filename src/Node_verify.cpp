@@ -12,9 +12,6 @@
 #include <mmx/utils.h>
 
 #include <vnx/vnx.h>
-#include <sha256_avx2.h>
-#include <sha256_ni.h>
-#include <sha256_arm.h>
 
 
 namespace mmx {
@@ -258,82 +255,10 @@ void Node::verify_vdf(std::shared_ptr<const ProofOfTime> proof, const int64_t re
 
 void Node::verify_vdf_cpu(std::shared_ptr<const ProofOfTime> proof) const
 {
-	static bool have_sha_ni = sha256_ni_available();
-	static bool have_sha_arm = sha256_arm_available();
-
-	const auto& segments = proof->segments;
-	bool is_valid = !segments.empty();
-	size_t invalid_segment = -1;
-
-	constexpr uint32_t batch_size = 16;
-	const uint32_t num_iters = proof->segment_size;
-	const uint32_t num_chunks = (segments.size() + batch_size - 1) / batch_size;
-
-#pragma omp parallel for
-	for(int chunk = 0; chunk < int(num_chunks); ++chunk)
-	{
-		if(!is_valid) {
-			continue;
-		}
-		const auto num_lanes = std::min<uint32_t>(batch_size, segments.size() - chunk * batch_size);
-
-		hash_t point[batch_size];
-		uint8_t hash[batch_size][32];
-		uint8_t input[batch_size][64];
-
-		for(uint32_t j = 0; j < num_lanes; ++j)
-		{
-			const uint32_t i = chunk * batch_size + j;
-			if(i > 0) {
-				point[j] = segments[i - 1];
-			} else {
-				point[j] = hash_t(proof->input + proof->prev);
-				point[j] = hash_t(point[j] + proof->reward_addr);
-			}
-		}
-		if(have_sha_ni || have_sha_arm) {
-			// Note: `num_lanes` is always a multiple of 2 (based on chain params)
-			for(uint32_t j = 0; j < num_lanes; j += 2)
-			{
-				uint8_t hashx2[32 * 2];
-				::memcpy(hashx2, point[j].data(), 32);
-				::memcpy(hashx2 + 32, point[j + 1].data(), 32);
-				if(have_sha_ni) {
-					recursive_sha256_ni_x2(hashx2, num_iters);
-				} else if(have_sha_arm) {
-					recursive_sha256_arm_x2(hashx2, num_iters);
-				} else {
-					throw std::logic_error("invalid feature state");
-				}
-				::memcpy(point[j].data(), hashx2, 32);
-				::memcpy(point[j + 1].data(), hashx2 + 32, 32);
-			}
-		} else {
-			for(uint32_t k = 0; k < num_iters; ++k)
-			{
-				for(uint32_t j = 0; j < num_lanes; ++j) {
-					::memcpy(input[j], point[j].data(), 32);
-				}
-				sha256_64_x8(hash[0], input[0], 32);
-				sha256_64_x8(hash[8], input[8], 32);
-
-				for(uint32_t j = 0; j < num_lanes; ++j) {
-					::memcpy(point[j].data(), hash[j], 32);
-				}
-			}
-		}
-		for(uint32_t j = 0; j < num_lanes; ++j)
-		{
-			const uint32_t i = chunk * batch_size + j;
-			if(point[j] != segments[i]) {
-				is_valid = false;
-				invalid_segment = i;
-			}
-		}
-	}
-	if(!is_valid) {
-		throw std::logic_error("invalid output on segment " + std::to_string(invalid_segment));
+	if(!vdf_verifier) {
+		throw std::logic_error("no CPU VDF verifier");
 	}
+	vdf_verifier->verify(proof);
 }
 
 void Node::verify_vdf_success(std::shared_ptr<const VDF_Point> point, const int64_t took_ms)
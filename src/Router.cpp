@@ -133,6 +133,8 @@ void Router::main()
 		log(upnp_mapper ? INFO : WARN) << "UPnP supported: " << (upnp_mapper ? "yes" : "no");
 	}
 
+	verify_threads = std::make_shared<vnx::ThreadPool>(1);
+
 	set_timer_millis(send_interval_ms, std::bind(&Router::send, this));
 	set_timer_millis(query_interval_ms, std::bind(&Router::query, this));
 	set_timer_millis(update_interval_ms, std::bind(&Router::update, this));
@@ -146,6 +148,8 @@ void Router::main()
 
 	save_data();
 
+	verify_threads->close();
+
 	if(upnp_mapper) {
 		upnp_mapper->stop();
 	}
@@ -557,6 +561,29 @@ bool Router::process(std::shared_ptr<const Return> ret)
 						job->failed.insert(client);
 					}
 				}
+				else if(auto result = std::dynamic_pointer_cast<const Node_get_header_return>(ret->result)) {
+					if(auto header = result->_ret_0) {
+						const auto& hash = header->content_hash;
+						const auto block = make_header_only(header);		// body is fetched later if needed
+						if(block->BlockHeader::is_valid()) {
+							for(const auto& entry : job->got_hash) {
+								if(entry.second.second == hash) {
+									job->succeeded.insert(entry.first);
+								}
+							}
+							job->succeeded.insert(client);
+							if(!job->blocks.count(hash)) {
+								job->blocks[hash] = block;
+							}
+						} else {
+							ban_peer(client, "they sent us an invalid block header");
+						}
+						job->pending_blocks.erase(hash);
+					}
+					if(!job->succeeded.count(client)) {
+						job->failed.insert(client);
+					}
+				}
 				else if(auto result = std::dynamic_pointer_cast<const vnx::Exception>(ret->result)) {
 					auto got_hash = job->got_hash.find(client);
 					if(got_hash != job->got_hash.end()) {
@@ -607,7 +634,20 @@ bool Router::process(std::shared_ptr<const Return> ret)
 					job->pending.insert(client);
 				}
 			}
-			// fetch blocks
+			// fetch blocks, headers-first: only the block most peers agree on is fetched in full,
+			// for the others just the header, Node fetches their body if it decides to follow them
+			hash_t main_hash;
+			{
+				size_t max_count = 0;
+				std::map<hash_t, size_t> hash_count;
+				for(const auto& entry : job->got_hash) {
+					const auto count = ++hash_count[entry.second.second];
+					if(count > max_count) {
+						max_count = count;
+						main_hash = entry.second.second;
+					}
+				}
+			}
 			std::set<std::pair<uint64_t, std::pair<hash_t, hash_t>>> clients;
 			for(const auto& entry : job->got_hash) {
 				const auto& hash = entry.second;
@@ -623,8 +663,16 @@ bool Router::process(std::shared_ptr<const Return> ret)
 				const auto& hash = entry.second;
 				auto pending = job->pending_blocks.find(hash.second);
 				if(pending == job->pending_blocks.end() || now_ms > pending->second) {
-					auto req = Node_get_block::create();
-					req->hash = hash.first;
+					std::shared_ptr<vnx::Value> req;
+					if(hash.second == main_hash) {
+						auto tmp = Node_get_block::create();
+						tmp->hash = hash.first;
+						req = tmp;
+					} else {
+						auto tmp = Node_get_header::create();
+						tmp->hash = hash.first;
+						req = tmp;
+					}
 					const auto id = send_request(client, req);
 					job->request_map[id] = client;
 					job->pending.insert(client);
@@ -1121,7 +1169,24 @@ void Router::on_transaction(uint64_t client, std::shared_ptr<const Transaction>
 	}
 	if(receive_msg_hash(tx->content_hash, client)) {
 		publish(tx, output_transactions);
+		verify_queue.push_back(tx);
+		if(verify_queue.size() >= 256) {
+			verify_signatures();
+		}
+	}
+}
+
+void Router::verify_signatures()
+{
+	if(verify_queue.empty()) {
+		return;
 	}
+	// warm up the shared signature cache, so Node's tx validation doesn't have to
+	auto list = std::make_shared<std::vector<std::shared_ptr<const Transaction>>>();
+	list->swap(verify_queue);
+	verify_threads->add_task([list]() {
+		signature_t::verify_many(get_signatures(*list));
+	});
 }
 
 void Router::on_recv_note(uint64_t client, std::shared_ptr<const ReceiveNote> note)
@@ -1150,6 +1215,8 @@ void Router::recv_notify(const hash_t& msg_hash)
 
 void Router::send()
 {
+	verify_signatures();
+
 	const auto now = get_time_us();
 	tx_upload_credits += tx_upload_bandwidth * send_interval_ms / 1000;
 	tx_upload_credits = std::min(tx_upload_credits, tx_upload_bandwidth);
@@ -14,6 +14,75 @@
 
 namespace mmx {
 
+static void write_hash_header(vnx::OutputBuffer& out, const Transaction& tx)
+{
+	write_bytes(out, tx.get_type_hash());
+	write_field(out, "version", tx.version);
+	write_field(out, "expires", tx.expires);
+	write_field(out, "fee_ratio", tx.fee_ratio);
+	write_field(out, "max_fee_amount", tx.max_fee_amount);
+	write_field(out, "note", 	tx.note);
+	write_field(out, "nonce", 	tx.nonce);
+	write_field(out, "network", tx.network);
+	write_field(out, "sender",	tx.sender);
+}
+
+static void write_hash_body(vnx::OutputBuffer& out, const Transaction& tx, const bool full_hash, const hash_t& deploy_hash)
+{
+	write_field(out, "inputs",	tx.inputs, full_hash);
+	write_field(out, "outputs", tx.outputs);
+	write_field(out, "execute");
+	write_bytes(out, uint32_t(tx.execute.size()));
+	for(const auto& op : tx.execute) {
+		write_bytes(out, op ? op->calc_hash(full_hash) : hash_t());
+	}
+	write_field(out, "deploy", deploy_hash);
+
+	if(full_hash) {
+		write_field(out, "static_cost", tx.static_cost);
+		write_field(out, "solutions");
+		write_bytes(out, uint32_t(tx.solutions.size()));
+		for(const auto& sol : tx.solutions) {
+			write_bytes(out, sol ? sol->calc_hash() : hash_t());
+		}
+		write_field(out, "exec_result", tx.exec_result ? tx.exec_result->calc_hash() : hash_t());
+	}
+}
+
+/*
+ * [id, content_hash] in one pass: the common header is serialized once,
+ * the deploy hash is computed once (contracts don't have a full hash).
+ */
+static std::pair<hash_t, hash_t> calc_hash_pair(const Transaction& tx)
+{
+	std::vector<uint8_t> id_buffer;
+	std::vector<uint8_t> full_buffer;
+	id_buffer.reserve(4 * 1024);
+	{
+		vnx::VectorOutputStream stream(&id_buffer);
+		vnx::OutputBuffer out(&stream);
+		write_hash_header(out, tx);
+		out.flush();
+	}
+	full_buffer.reserve(id_buffer.capacity());
+	full_buffer = id_buffer;
+
+	const auto deploy_hash = tx.deploy ? tx.deploy->calc_hash() : hash_t();
+	{
+		vnx::VectorOutputStream stream(&id_buffer);
+		vnx::OutputBuffer out(&stream);
+		write_hash_body(out, tx, false, deploy_hash);
+		out.flush();
+	}
+	{
+		vnx::VectorOutputStream stream(&full_buffer);
+		vnx::OutputBuffer out(&stream);
+		write_hash_body(out, tx, true, deploy_hash);
+		out.flush();
+	}
+	return std::make_pair(hash_t(id_buffer), hash_t(full_buffer));
+}
+
 hash_t TransactionBase::calc_hash(const vnx::bool_t& full_hash) const {
 	return id;
 }
@@ -82,8 +151,7 @@ vnx::bool_t Transaction::is_valid(std::shared_ptr<const ChainParams> params) con
 			&& solutions.size() <= MAX_SOLUTIONS
 			&& (!exec_result || exec_result->is_valid())
 			&& static_cost == calc_cost(params)
-			&& id == calc_hash()
-			&& content_hash == calc_hash(true);
+			&& calc_hash_pair(*this) == std::make_pair(id, content_hash);
 }
 
 vnx::bool_t Transaction::did_fail() const
@@ -102,33 +170,8 @@ std::vector<uint8_t> Transaction::hash_serialize(const vnx::bool_t& full_hash) c
 
 	buffer.reserve(4 * 1024);
 
-	write_bytes(out, get_type_hash());
-	write_field(out, "version", version);
-	write_field(out, "expires", expires);
-	write_field(out, "fee_ratio", fee_ratio);
-	write_field(out, "max_fee_amount", max_fee_amount);
-	write_field(out, "note", 	note);
-	write_field(out, "nonce", 	nonce);
-	write_field(out, "network", network);
-	write_field(out, "sender",	sender);
-	write_field(out, "inputs",	inputs, full_hash);
-	write_field(out, "outputs", outputs);
-	write_field(out, "execute");
-	write_bytes(out, uint32_t(execute.size()));
-	for(const auto& op : execute) {
-		write_bytes(out, op ? op->calc_hash(full_hash) : hash_t());
-	}
-	write_field(out, "deploy", deploy ? deploy->calc_hash(full_hash) : hash_t());
-
-	if(full_hash) {
-		write_field(out, "static_cost", static_cost);
-		write_field(out, "solutions");
-		write_bytes(out, uint32_t(solutions.size()));
-		for(const auto& sol : solutions) {
-			write_bytes(out, sol ? sol->calc_hash() : hash_t());
-		}
-		write_field(out, "exec_result", exec_result ? exec_result->calc_hash() : hash_t());
-	}
+	write_hash_header(out, *this);
+	write_hash_body(out, *this, full_hash, deploy ? deploy->calc_hash(full_hash) : hash_t());
 	out.flush();
 
 	return buffer;
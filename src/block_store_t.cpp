@@ -0,0 +1,357 @@
+/*
+ * block_store_t.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <mmx/block_store_t.h>
+
+#include <vnx/vnx.h>
+
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+
+namespace mmx {
+
+static constexpr int64_t POSITION_MASK = (int64_t(1) << block_store_t::segment_shift) - 1;
+
+block_store_t::block_store_t(	const std::string& root_path, const std::string& legacy_file,
+								const uint32_t segment_size, const uint32_t ring_size)
+	:	root_path(root_path), legacy_file(legacy_file),
+		segment_size(std::max<uint32_t>(segment_size, 1)), ring_size(std::max<uint32_t>(ring_size, 1))
+{
+	vnx::Directory(root_path).create();
+	read_prune_end();
+	map_ring();
+}
+
+block_store_t::~block_store_t()
+{
+	close();
+}
+
+std::string block_store_t::get_segment_path(const uint32_t index) const
+{
+	if(index == 0) {
+		return legacy_file;
+	}
+	auto name = std::to_string(index);
+	if(name.size() < 6) {
+		name = std::string(6 - name.size(), '0') + name;
+	}
+	return root_path + "/" + name + ".dat";
+}
+
+std::string block_store_t::get_prune_path() const
+{
+	return root_path + "/prune_end.dat";
+}
+
+void block_store_t::read_prune_end()
+{
+	uint32_t value = 1;
+	vnx::File file(get_prune_path());
+	if(file.exists()) {
+		try {
+			file.open("rb");
+			file.in.read(&value, sizeof(value));
+			file.close();
+		} catch(const std::exception& ex) {
+			vnx::log_warn() << "block_store_t: failed to read " << file.get_path() << ": " << ex.what();
+		}
+	}
+	prune_end = std::max<uint32_t>(value, 1);
+}
+
+void block_store_t::write_prune_end()
+{
+	const uint32_t value = prune_end;
+	vnx::File file(get_prune_path() + ".tmp");
+	file.open("wb");
+	file.out.write(&value, sizeof(value));
+	file.close();
+	file.rename(get_prune_path());
+}
+
+bool block_store_t::is_pruned(const int64_t offset) const
+{
+	// THREAD SAFE
+	const auto index = offset >> segment_shift;
+	return index >= 1 && index < prune_end;
+}
+
+std::shared_ptr<block_store_t::segment_t> block_store_t::get_segment(const uint32_t index, const bool create) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	auto iter = segments.find(index);
+	if(iter != segments.end()) {
+		return iter->second;
+	}
+	auto segment = std::make_shared<segment_t>();
+	segment->file = vnx::File(get_segment_path(index));
+	if(!segment->file.exists()) {
+		if(!create) {
+			return nullptr;
+		}
+		segment->file.open("wb");
+	}
+	segment->file.open("rb+");
+
+	segments[index] = segment;
+	return segment;
+}
+
+int64_t block_store_t::write(std::shared_ptr<const Block> block, std::vector<int64_t>* tx_offsets)
+{
+	const uint32_t index = 1 + block->height / segment_size;
+	const auto segment = get_segment(index, true);
+	const auto base = int64_t(index) << segment_shift;
+
+	auto& file = segment->file;
+	file.seek_end();
+	auto& out = file.out;
+	const auto offset = out.get_output_pos();
+
+	if(tx_offsets) {
+		tx_offsets->clear();
+	}
+	vnx::write(out, block->get_header());
+
+	for(const auto& tx : block->tx_list) {
+		if(tx_offsets) {
+			tx_offsets->push_back(base | out.get_output_pos());
+		}
+		vnx::write(out, tx);
+	}
+	vnx::write(out, nullptr);	// end of block
+	file.flush();
+
+	return base | offset;
+}
+
+std::shared_ptr<const BlockHeader> block_store_t::read(const int64_t offset, const bool full_block, std::vector<int64_t>* tx_offsets) const
+{
+	// THREAD SAFE
+	if(tx_offsets) {
+		tx_offsets->clear();
+	}
+	if(is_pruned(offset)) {
+		throw std::runtime_error("block data has been pruned");
+	}
+	const auto segment = get_segment(offset >> segment_shift, false);
+	if(!segment) {
+		return nullptr;
+	}
+	vnx::FileSectionInputStream stream(segment->file.get_handle(), offset & POSITION_MASK, -1, full_block ? 65536 : 4096);
+	vnx::TypeInput in(&stream);
+
+	const auto begin = in.get_input_pos();
+
+	auto header = std::dynamic_pointer_cast<const BlockHeader>(vnx::read(in));
+	if(!header) {
+		throw std::logic_error("expected block header");
+	}
+	if(!full_block) {
+		return header;
+	}
+	auto block = Block::create();
+	block->BlockHeader::operator=(*header);
+	while(true) {
+		const auto tx_offset = offset + (in.get_input_pos() - begin);
+		if(auto value = vnx::read(in)) {
+			if(auto tx = std::dynamic_pointer_cast<const Transaction>(value)) {
+				if(tx_offsets) {
+					tx_offsets->push_back(tx_offset);
+				}
+				block->tx_list.push_back(tx);
+			} else {
+				throw std::logic_error("expected transaction");
+			}
+		} else {
+			break;
+		}
+	}
+	return block;
+}
+
+std::shared_ptr<const Transaction> block_store_t::read_tx(const int64_t offset) const
+{
+	// THREAD SAFE
+	if(is_pruned(offset)) {
+		throw std::runtime_error("transaction data has been pruned");
+	}
+	const auto segment = get_segment(offset >> segment_shift, false);
+	if(!segment) {
+		return nullptr;
+	}
+	vnx::FileSectionInputStream stream(segment->file.get_handle(), offset & POSITION_MASK, -1, 4096);
+	vnx::TypeInput in(&stream);
+
+	return std::dynamic_pointer_cast<const Transaction>(vnx::read(in));
+}
+
+void block_store_t::set_main(const uint32_t height, const hash_t& hash, const int64_t offset)
+{
+	std::unique_lock<std::shared_mutex> lock(ring_mutex);
+
+	auto& entry = ring[height % ring_size];
+	entry.height = height;
+	entry.offset = offset;
+	::memcpy(entry.hash, hash.data(), hash.size());
+	entry.is_valid = 1;
+}
+
+bool block_store_t::find_main(const uint32_t height, hash_t& hash, int64_t& offset) const
+{
+	// THREAD SAFE
+	std::shared_lock<std::shared_mutex> lock(ring_mutex);
+	if(!ring) {
+		return false;
+	}
+	const auto& entry = ring[height % ring_size];
+	if(entry.is_valid && entry.height == height) {
+		hash = hash_t::from_bytes(entry.hash);
+		offset = entry.offset;
+		return true;
+	}
+	return false;
+}
+
+void block_store_t::erase_main(const uint32_t height)
+{
+	std::unique_lock<std::shared_mutex> lock(ring_mutex);
+
+	auto& entry = ring[height % ring_size];
+	if(entry.height == height) {
+		entry.is_valid = 0;
+	}
+}
+
+void block_store_t::revert_main(const uint32_t height, const bool full_scan)
+{
+	std::unique_lock<std::shared_mutex> lock(ring_mutex);
+
+	if(full_scan) {
+		for(uint32_t i = 0; i < ring_size; ++i) {
+			auto& entry = ring[i];
+			if(entry.is_valid && entry.height >= height) {
+				entry.is_valid = 0;
+			}
+		}
+		return;
+	}
+	// main chain entries are contiguous
+	for(uint32_t i = 0; i < ring_size; ++i) {
+		auto& entry = ring[(uint64_t(height) + i) % ring_size];
+		if(!entry.is_valid || entry.height != height + i) {
+			break;
+		}
+		entry.is_valid = 0;
+	}
+}
+
+size_t block_store_t::prune(const uint32_t height)
+{
+	const uint32_t begin = prune_end;
+	const uint32_t end = 1 + height / segment_size;		// first segment to keep
+	if(end <= begin) {
+		return 0;
+	}
+	prune_end = end;		// refuse reads before the files are gone
+	write_prune_end();
+
+	size_t count = 0;
+	for(uint32_t index = begin; index < end; ++index)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			segments.erase(index);		// file is closed when last reader is done
+		}
+		vnx::File file(get_segment_path(index));
+		if(file.exists()) {
+			file.remove();
+			count++;
+		}
+	}
+	return count;
+}
+
+void block_store_t::clear()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		segments.clear();
+	}
+	for(const auto& file : vnx::Directory(root_path).files()) {
+		if(file->get_extension() == ".dat") {
+			file->remove();
+		}
+	}
+	{
+		vnx::File file(legacy_file);
+		if(file.exists()) {
+			file.remove();
+		}
+	}
+	prune_end = 1;
+
+	std::unique_lock<std::shared_mutex> lock(ring_mutex);
+	::memset((void*)ring, 0, size_t(ring_size) * sizeof(ring_entry_t));
+}
+
+void block_store_t::close()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		segments.clear();
+	}
+	unmap_ring();
+}
+
+void block_store_t::map_ring()
+{
+	const size_t num_bytes = size_t(ring_size) * sizeof(ring_entry_t);
+#ifndef _WIN32
+	const auto path = root_path + "/header_ring.idx";
+	ring_fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+	if(ring_fd >= 0) {
+		if(::ftruncate(ring_fd, num_bytes) == 0) {
+			void* ptr = ::mmap(nullptr, num_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, ring_fd, 0);
+			if(ptr != MAP_FAILED) {
+				ring = (ring_entry_t*)ptr;
+				return;
+			}
+		}
+		::close(ring_fd);
+		ring_fd = -1;
+	}
+	vnx::log_warn() << "block_store_t: failed to map " << path << ", using memory instead";
+#endif
+	ring_buf.resize(ring_size);		// not persistent, filled again on startup
+	ring = ring_buf.data();
+	(void)num_bytes;
+}
+
+void block_store_t::unmap_ring()
+{
+	std::unique_lock<std::shared_mutex> lock(ring_mutex);
+#ifndef _WIN32
+	if(ring_fd >= 0) {
+		::munmap((void*)ring, size_t(ring_size) * sizeof(ring_entry_t));
+		::close(ring_fd);
+		ring_fd = -1;
+	}
+#endif
+	ring = nullptr;
+	std::vector<ring_entry_t>().swap(ring_buf);
+}
+
+
+} // mmx
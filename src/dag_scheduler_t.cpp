@@ -0,0 +1,146 @@
+/*
+ * dag_scheduler_t.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <mmx/dag_scheduler_t.h>
+#include <mmx/utils.h>
+
+#include <stdexcept>
+
+
+namespace mmx {
+
+size_t dag_scheduler_t::add_task(const std::function<void()>& func)
+{
+	task_t task;
+	task.func = func;
+	tasks.push_back(std::move(task));
+	return tasks.size() - 1;
+}
+
+void dag_scheduler_t::add_depend(const size_t task, const size_t prev)
+{
+	if(task >= tasks.size() || prev >= task) {
+		throw std::logic_error("dag_scheduler_t: invalid dependency");
+	}
+	tasks[prev].next.push_back(task);
+	tasks[task].num_pending++;
+}
+
+dag_scheduler_t::stats_t dag_scheduler_t::run(vnx::ThreadPool& pool, const size_t num_workers)
+{
+	stats = stats_t();
+	stats.num_tasks = tasks.size();
+	if(tasks.empty()) {
+		return stats;
+	}
+	stats.num_workers = std::max<size_t>(std::min(num_workers, tasks.size()), 1);
+
+	// back of each queue is popped first, so earlier tasks go last
+	queues.clear();
+	queues.resize(stats.num_workers);
+	for(size_t i = tasks.size(), k = 0; i-- > 0;) {
+		if(!tasks[i].num_pending) {
+			queues[(k++) % queues.size()].push_back(i);
+		}
+	}
+	const auto time_begin = get_time_us();
+
+	num_done = 0;
+	num_running = queues.size();
+	for(size_t i = 0; i < queues.size(); ++i) {
+		pool.add_task([this, i]() {
+			worker(i);
+		});
+	}
+	{
+		std::unique_lock lock(mutex);
+		while(num_running) {
+			signal.wait(lock);
+		}
+	}
+	stats.wall_time_us = get_time_us() - time_begin;
+
+	if(error) {
+		std::rethrow_exception(error);
+	}
+	return stats;
+}
+
+bool dag_scheduler_t::pop_task(const size_t index, size_t& task)
+{
+	auto& own = queues[index];
+	if(!own.empty()) {
+		task = own.back();
+		own.pop_back();
+		return true;
+	}
+	for(size_t i = 1; i < queues.size(); ++i) {
+		auto& other = queues[(index + i) % queues.size()];
+		if(!other.empty()) {
+			task = other.front();
+			other.pop_front();
+			stats.num_steals++;
+			return true;
+		}
+	}
+	return false;
+}
+
+void dag_scheduler_t::worker(const size_t index)
+{
+	std::unique_lock lock(mutex);
+
+	while(num_done < tasks.size())
+	{
+		size_t i = 0;
+		if(!pop_task(index, i)) {
+			signal.wait(lock);
+			continue;
+		}
+		lock.unlock();
+
+		const auto time_begin = get_time_us();
+		try {
+			tasks[i].func();
+		} catch(...) {
+			std::lock_guard<std::mutex> lock(mutex);
+			if(!error) {
+				error = std::current_exception();
+			}
+		}
+		const auto elapsed = get_time_us() - time_begin;
+
+		lock.lock();
+
+		auto& task = tasks[i];
+		task.path_us += elapsed;
+		stats.total_time_us += elapsed;
+		stats.max_depth = std::max(stats.max_depth, task.depth + 1);
+		stats.critical_path_us = std::max(stats.critical_path_us, task.path_us);
+
+		size_t num_ready = 0;
+		for(const auto k : task.next) {
+			auto& next = tasks[k];
+			next.depth = std::max(next.depth, task.depth + 1);
+			next.path_us = std::max(next.path_us, task.path_us);
+			if(--next.num_pending == 0) {
+				queues[index].push_back(k);
+				num_ready++;
+			}
+		}
+		num_done++;
+
+		// a single ready task is continued by this worker
+		if(num_ready > 1 || num_done == tasks.size()) {
+			signal.notify_all();
+		}
+	}
+	num_running--;
+	signal.notify_all();
+}
+
+
+} // mmx
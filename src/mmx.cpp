@@ -17,6 +17,7 @@
 #include <mmx/operation/Deposit.hxx>
 #include <mmx/KeyFile.hxx>
 #include <mmx/secp256k1.hpp>
+#include <mmx/tree_hash.h>
 #include <mmx/hash_t.hpp>
 #include <mmx/fixed128.hpp>
 #include <mmx/mnemonic.h>
@@ -1971,6 +1972,8 @@ failed:
 exit:
 	vnx::close();
 
+	mmx::signature_t::shutdown();
+	mmx::tree_hash_shutdown();
 	mmx::secp256k1_free();
 
 	return did_fail ? -1 : 0;
@@ -8,6 +8,7 @@
 #include <mmx/Farmer.h>
 #include <mmx/Wallet.h>
 #include <mmx/Harvester.h>
+#include <mmx/tree_hash.h>
 
 #include <vnx/vnx.h>
 #include <vnx/Proxy.h>
@@ -132,10 +133,14 @@ int main(int argc, char** argv)
 
 	vnx::wait();
 
+	mmx::pos::Prover::shutdown();
+
 #ifdef WITH_CUDA
 	mmx::pos::cuda_recompute_shutdown();
 #endif
 
+	mmx::signature_t::shutdown();
+	mmx::tree_hash_shutdown();
 	mmx::secp256k1_free();
 
 	return 0;
@@ -105,6 +105,8 @@ int main(int argc, char** argv)
 
 	vnx::wait();
 
+	mmx::pos::Prover::shutdown();
+
 #ifdef WITH_CUDA
 	mmx::pos::cuda_recompute_shutdown();
 #endif
@@ -15,11 +15,13 @@
 #include <mmx/Qt_GUI.h>
 #include <mmx/WalletClient.hxx>
 #include <mmx/secp256k1.hpp>
+#include <mmx/tree_hash.h>
 #include <mmx/utils.h>
 
 #include <sha256_ni.h>
 #include <sha256_arm.h>
 #include <sha256_avx2.h>
+#include <sha256_avx512.h>
 
 #include <vnx/vnx.h>
 #include <vnx/Server.h>
@@ -95,6 +97,7 @@ int main(int argc, char** argv)
 	wapi_threads = std::max(std::min(wapi_threads, 256u), 1u);
 
 	vnx::log_info() << "AVX2 support:   " << (avx2_available() ? "yes" : "no");
+	vnx::log_info() << "AVX512 support: " << (avx512_available() ? "yes" : "no");
 	vnx::log_info() << "SHA-NI support: " << (sha256_ni_available() ? "yes" : "no");
 #ifdef __aarch64__
 	vnx::log_info() << "ARM-SHA2 support: " << (sha256_arm_available() ? "yes" : "no");
@@ -235,10 +238,14 @@ int main(int argc, char** argv)
 
 	vnx::close();
 
+	mmx::pos::Prover::shutdown();
+
 #ifdef WITH_CUDA
 	mmx::pos::cuda_recompute_shutdown();
 #endif
 
+	mmx::signature_t::shutdown();
+	mmx::tree_hash_shutdown();
 	mmx::secp256k1_free();
 
 	return 0;
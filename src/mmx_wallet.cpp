@@ -8,6 +8,7 @@
 #include <mmx/Wallet.h>
 #include <mmx/WebAPI.h>
 #include <mmx/Qt_GUI.h>
+#include <mmx/tree_hash.h>
 
 #include <vnx/addons/FileServer.h>
 #include <vnx/addons/HttpServer.h>
@@ -136,6 +137,8 @@ int main(int argc, char** argv)
 
 	vnx::close();
 
+	mmx::signature_t::shutdown();
+	mmx::tree_hash_shutdown();
 	mmx::secp256k1_free();
 
 	return 0;
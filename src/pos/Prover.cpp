@@ -10,10 +10,201 @@
 #include <mmx/pos/verify.h>
 #include <mmx/pos/util.h>
 
+#include <vnx/ThreadPool.h>
+
+#include <mutex>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+#ifdef _WIN32
+#include <cstdio>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#endif
+
 
 namespace mmx {
 namespace pos {
 
+// read-only plot file, positional reads are thread safe
+class Prover::file_t {
+public:
+	file_t(const std::string& file_path)
+	{
+#ifdef _WIN32
+		file = ::fopen(file_path.c_str(), "rb");
+		if(!file) {
+			throw std::runtime_error("failed to open file");
+		}
+#else
+		fd = ::open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+		if(fd < 0) {
+			throw std::runtime_error("failed to open file");
+		}
+#endif
+	}
+
+	~file_t()
+	{
+#ifdef _WIN32
+		::fclose(file);
+#else
+		::close(fd);
+#endif
+	}
+
+	file_t(const file_t&) = delete;
+	file_t& operator=(const file_t&) = delete;
+
+	bool read(void* dst, const uint64_t num_bytes, const uint64_t offset) const
+	{
+#ifdef _WIN32
+		std::lock_guard<std::mutex> lock(mutex);
+		if(::_fseeki64(file, offset, SEEK_SET)) {
+			return false;
+		}
+		return ::fread(dst, 1, num_bytes, file) == num_bytes;
+#else
+		uint64_t total = 0;
+		while(total < num_bytes) {
+			const auto ret = ::pread(fd, ((char*)dst) + total, num_bytes - total, offset + total);
+			if(ret < 0 && errno == EINTR) {
+				continue;
+			}
+			if(ret <= 0) {
+				return false;
+			}
+			total += ret;
+		}
+		return true;
+#endif
+	}
+
+private:
+#ifdef _WIN32
+	FILE* file = nullptr;
+	mutable std::mutex mutex;
+#else
+	int fd = -1;
+#endif
+};
+
+// open plot files, least recently used are closed when over the limit
+struct file_pool_t {
+	struct entry_t {
+		uint64_t last_used = 0;
+		std::shared_ptr<const Prover::file_t> file;
+	};
+	std::mutex mutex;
+	size_t max_open = 0;
+	uint64_t counter = 0;
+	std::unordered_map<std::string, entry_t> files;
+
+	file_pool_t()
+	{
+#ifdef _WIN32
+		max_open = 256;
+#else
+		// keep half of the descriptor limit for everything else
+		struct rlimit limit = {};
+		if(::getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY) {
+			max_open = limit.rlim_cur / 2;
+		} else {
+			max_open = 4096;
+		}
+		max_open = std::max<size_t>(max_open, 16);
+#endif
+	}
+
+	std::shared_ptr<const Prover::file_t> get(const std::string& file_path)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		{
+			auto iter = files.find(file_path);
+			if(iter != files.end()) {
+				iter->second.last_used = counter++;
+				return iter->second.file;
+			}
+		}
+		while(files.size() && files.size() >= max_open) {
+			auto oldest = files.begin();
+			for(auto iter = files.begin(); iter != files.end(); ++iter) {
+				if(iter->second.last_used < oldest->second.last_used) {
+					oldest = iter;
+				}
+			}
+			files.erase(oldest);		// closed when last reader is done
+		}
+		auto& entry = files[file_path];
+		try {
+			entry.file = std::make_shared<const Prover::file_t>(file_path);
+		} catch(...) {
+			files.erase(file_path);
+			throw;
+		}
+		entry.last_used = counter++;
+		return entry.file;
+	}
+
+	void close(const std::string& file_path)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		files.erase(file_path);
+	}
+};
+
+static file_pool_t g_file_pool;
+
+static std::mutex g_io_mutex;
+static std::shared_ptr<vnx::ThreadPool> g_io_threads;
+
+static std::shared_ptr<vnx::ThreadPool> get_io_threads()
+{
+	std::lock_guard<std::mutex> lock(g_io_mutex);
+	if(!g_io_threads) {
+		g_io_threads = std::make_shared<vnx::ThreadPool>(64, 4096);
+	}
+	return g_io_threads;
+}
+
+// reads one park per offset into out[i], parallel if more than one
+static bool read_parks(	std::shared_ptr<const Prover::file_t> file, std::vector<std::vector<uint64_t>>& out,
+						const std::vector<uint64_t>& offsets, const uint64_t park_bytes, const bool parallel)
+{
+	out.resize(offsets.size());
+	for(auto& park : out) {
+		park.resize(cdiv(park_bytes, 8));
+		park.back() = 0;
+	}
+	if(!parallel || offsets.size() < 2) {
+		for(size_t i = 0; i < offsets.size(); ++i) {
+			if(!file->read(out[i].data(), park_bytes, offsets[i])) {
+				return false;
+			}
+		}
+		return true;
+	}
+	const auto threads = get_io_threads();
+
+	std::atomic<bool> failed {false};
+	std::vector<int64_t> jobs;
+	for(size_t i = 0; i < offsets.size(); ++i) {
+		auto* park = &out[i];
+		const auto offset = offsets[i];
+		jobs.push_back(threads->add_task([file, park, offset, park_bytes, &failed]() {
+			if(!file->read(park->data(), park_bytes, offset)) {
+				failed = true;
+			}
+		}));
+	}
+	threads->sync(jobs);
+	return !failed;
+}
+
 Prover::Prover(const std::string& file_path)
 	:	file_path(file_path)
 {
@@ -26,12 +217,143 @@ Prover::Prover(const std::string& file_path)
 	}
 }
 
-std::vector<proof_data_t> Prover::get_qualities(const hash_t& challenge, const int plot_filter) const
+Prover::~Prover()
+{
+	g_file_pool.close(file_path);
+}
+
+std::shared_ptr<const Prover::file_t> Prover::get_file() const
+{
+	return g_file_pool.get(file_path);
+}
+
+void Prover::set_max_open_files(const size_t count)
+{
+	std::lock_guard<std::mutex> lock(g_file_pool.mutex);
+	g_file_pool.max_open = std::max<size_t>(count, 1);
+}
+
+void Prover::shutdown()
 {
-	std::ifstream file(file_path, std::ios_base::binary);
+	std::lock_guard<std::mutex> lock(g_io_mutex);
+	if(g_io_threads) {
+		g_io_threads->close();
+		g_io_threads = nullptr;
+	}
+}
+
+static constexpr uint32_t Y_INDEX_MAGIC = 0x58444959;		// "YIDX"
+static constexpr uint32_t Y_INDEX_VERSION = 1;
+
+bool Prover::have_y_index() const
+{
+	return get_y_index() != nullptr;
+}
+
+std::shared_ptr<const Prover::y_index_t> Prover::get_y_index() const
+{
+	std::lock_guard<std::mutex> lock(index_mutex);
+	return y_index;
+}
+
+void Prover::load_y_index(const std::string& cache_file)
+{
+	if(have_y_index()) {
+		return;
+	}
+	std::shared_ptr<const y_index_t> index;
+	if(!cache_file.empty()) {
+		index = read_y_index(cache_file);
+	}
+	if(!index) {
+		const uint64_t num_parks_y = cdiv<uint64_t>(header->num_entries_y, header->park_size_y);
+
+		auto out = std::make_shared<y_index_t>();
+		out->stride = std::max<uint64_t>(cdiv<uint64_t>(num_parks_y, std::max<uint32_t>(max_y_index, 1)), 1);
+
+		std::vector<uint64_t> offsets;
+		for(uint64_t i = 0; i < num_parks_y; i += out->stride) {
+			offsets.push_back(header->table_offset_y + i * header->park_bytes_y);
+		}
+		// only the 4 byte park header is needed
+		std::vector<std::vector<uint64_t>> parks;
+		if(!read_parks(get_file(), parks, offsets, 4, true)) {
+			throw std::runtime_error("failed to read Y park headers");
+		}
+		for(const auto& park : parks) {
+			out->first_y.push_back(read_bits(park.data(), 0, header->ksize));
+		}
+		index = out;
+
+		if(!cache_file.empty()) {
+			write_y_index(cache_file, index);
+		}
+	}
+	std::lock_guard<std::mutex> lock(index_mutex);
+	y_index = index;
+}
+
+std::shared_ptr<const Prover::y_index_t> Prover::read_y_index(const std::string& cache_file) const
+{
+	std::ifstream file(cache_file, std::ios_base::binary);
+	if(!file.good()) {
+		return nullptr;
+	}
+	uint32_t magic = 0;
+	uint32_t version = 0;
+	uint64_t num_parks_y = 0;
+	uint32_t count = 0;
+	uint8_t plot_id[32] = {};
+	auto out = std::make_shared<y_index_t>();
+
+	file.read((char*)&magic, 4);
+	file.read((char*)&version, 4);
+	file.read((char*)plot_id, 32);
+	file.read((char*)&num_parks_y, 8);
+	file.read((char*)&out->stride, 4);
+	file.read((char*)&count, 4);
+
+	if(!file.good() || magic != Y_INDEX_MAGIC || version != Y_INDEX_VERSION
+		|| ::memcmp(plot_id, header->plot_id.data(), 32)
+		|| num_parks_y != cdiv<uint64_t>(header->num_entries_y, header->park_size_y)
+		|| out->stride == 0 || count != cdiv<uint64_t>(num_parks_y, out->stride))
+	{
+		return nullptr;
+	}
+	out->first_y.resize(count);
+	file.read((char*)out->first_y.data(), uint64_t(count) * 4);
 	if(!file.good()) {
-		throw std::runtime_error("failed to open file");
+		return nullptr;
+	}
+	return out;
+}
+
+void Prover::write_y_index(const std::string& cache_file, std::shared_ptr<const y_index_t> index) const
+{
+	const uint64_t num_parks_y = cdiv<uint64_t>(header->num_entries_y, header->park_size_y);
+	const uint32_t count = index->first_y.size();
+	const std::string tmp_file = cache_file + ".tmp";
+	{
+		std::ofstream file(tmp_file, std::ios_base::binary | std::ios_base::trunc);
+		file.write((const char*)&Y_INDEX_MAGIC, 4);
+		file.write((const char*)&Y_INDEX_VERSION, 4);
+		file.write((const char*)header->plot_id.data(), 32);
+		file.write((const char*)&num_parks_y, 8);
+		file.write((const char*)&index->stride, 4);
+		file.write((const char*)&count, 4);
+		file.write((const char*)index->first_y.data(), uint64_t(count) * 4);
+		if(!file.good()) {
+			std::remove(tmp_file.c_str());
+			return;		// index is just not cached
+		}
 	}
+	std::rename(tmp_file.c_str(), cache_file.c_str());
+}
+
+std::vector<proof_data_t> Prover::get_qualities(const hash_t& challenge, const int plot_filter) const
+{
+	const auto file = get_file();
+
 	const uint32_t kmask = ((uint64_t(1) << header->ksize) - 1);
 
 	const uint32_t Y_begin = bytes_t<4>(challenge.data(), 4).to_uint<uint32_t>() & kmask;
@@ -46,12 +368,38 @@ std::vector<proof_data_t> Prover::get_qualities(const hash_t& challenge, const i
 	{
 		const int32_t num_parks_y = cdiv<uint64_t>(header->num_entries_y, header->park_size_y);
 
-		const uint32_t Y_try_first = std::max<int64_t>(int64_t(Y_begin) + initial_y_shift, 0);
-		int32_t park_index = ((uint64_t(Y_try_first >> 1) * header->num_entries_y) >> (header->ksize - 1)) / header->park_size_y;
+		int32_t park_index = 0;
+		int32_t min_park_index = 0;		// park with first Y < Y_begin (or zero)
+
+		const auto index = get_y_index();
+		const bool use_index = index && index->first_y.size();
+		if(use_index) {
+			const auto& first_y = index->first_y;
+			const auto iter = std::lower_bound(first_y.begin(), first_y.end(), Y_begin);
+			if(iter != first_y.begin()) {
+				const uint64_t j = (iter - first_y.begin()) - 1;
+				const uint64_t lo = j * index->stride;
+				const uint64_t hi = std::min<uint64_t>(lo + index->stride, num_parks_y);
+				const uint64_t Y_lo = first_y[j];
+				const uint64_t Y_hi = (j + 1 < first_y.size()) ? first_y[j + 1] : uint64_t(kmask) + 1;
 
+				// interpolate within [lo, hi), steps back below if guess is too far
+				const uint64_t guess = lo + ((Y_begin - Y_lo) * (hi - lo)) / std::max<uint64_t>(Y_hi - Y_lo, 1);
+				park_index = std::min<uint64_t>(guess, hi - 1);
+				min_park_index = lo;
+			}
+		} else {
+			const uint32_t Y_try_first = std::max<int64_t>(int64_t(Y_begin) + initial_y_shift, 0);
+			park_index = ((uint64_t(Y_try_first >> 1) * header->num_entries_y) >> (header->ksize - 1)) / header->park_size_y;
+		}
 		park_index = std::min<int32_t>(park_index, num_parks_y - 1);
 
-		std::vector<uint64_t> bit_stream(cdiv(header->park_bytes_y - 4, 8));
+		// reused per thread, park header + bit stream
+		thread_local std::vector<uint8_t> park_y;
+		thread_local std::vector<uint64_t> bit_stream;
+		park_y.resize(header->park_bytes_y);
+		bit_stream.resize(cdiv(header->park_bytes_y - 4, 8));
+		bit_stream.back() = 0;
 
 		bool have_begin = false;
 		for(size_t i = 0; park_index >= 0 && park_index < num_parks_y; i++)
@@ -59,20 +407,22 @@ std::vector<proof_data_t> Prover::get_qualities(const hash_t& challenge, const i
 			if(i > 100) {
 				throw std::runtime_error("failed to find Y park");
 			}
-			file.seekg(header->table_offset_y + uint64_t(park_index) * header->park_bytes_y);
-
+			if(!file->read(park_y.data(), park_y.size(), header->table_offset_y + uint64_t(park_index) * header->park_bytes_y)) {
+				throw std::runtime_error("failed to read Y park " + std::to_string(park_index));
+			}
 			uint32_t Y_i = 0;
 			{
 				uint64_t tmp = 0;
-				file.read((char*)&tmp, 4);
+				::memcpy(&tmp, park_y.data(), 4);
 				Y_i = read_bits(&tmp, 0, header->ksize);
 			}
-			if(!file.good()) {
-				throw std::runtime_error("failed to read Y park header " + std::to_string(park_index));
-			}
 			if(debug) {
 				std::cout << "park_index = " << park_index << ", Y = " << Y_i << std::endl;
 			}
+			if(use_index && !have_begin && Y_i >= Y_begin && park_index > min_park_index) {
+				park_index--;		// matching entries might start in previous park
+				continue;
+			}
 			if(Y_i >= Y_end) {
 				if(have_begin || park_index == 0) {
 					break;
@@ -85,11 +435,8 @@ std::vector<proof_data_t> Prover::get_qualities(const hash_t& challenge, const i
 			}
 			have_begin = true;
 
-			file.read((char*)bit_stream.data(), header->park_bytes_y - 4);
+			::memcpy(bit_stream.data(), park_y.data() + 4, header->park_bytes_y - 4);
 
-			if(!file.good()) {
-				throw std::runtime_error("failed to read Y park " + std::to_string(park_index));
-			}
 			const auto deltas = decode(bit_stream, header->park_size_y - 1);
 
 			std::vector<uint32_t> Y_list;
@@ -125,11 +472,10 @@ std::vector<proof_data_t> Prover::get_qualities(const hash_t& challenge, const i
 	}
 	std::vector<proof_data_t> result;
 
-	std::vector<uint64_t> meta_park;
+	thread_local std::vector<uint64_t> meta_park;
 	if(header->has_meta) {
 		meta_park.resize(cdiv(header->park_bytes_meta, 8));
-	} else {
-		file.close();
+		meta_park.back() = 0;
 	}
 
 	for(const auto final_index : final_entries)
@@ -138,9 +484,7 @@ std::vector<proof_data_t> Prover::get_qualities(const hash_t& challenge, const i
 		if(header->has_meta) {
 			const uint64_t park_index =  final_index / header->park_size_meta;
 			const uint32_t park_offset = final_index % header->park_size_meta;
-			file.seekg(header->table_offset_meta + park_index * header->park_bytes_meta);
-			file.read((char*)meta_park.data(), header->park_bytes_meta);
-			if(!file.good()) {
+			if(!file->read(meta_park.data(), header->park_bytes_meta, header->table_offset_meta + park_index * header->park_bytes_meta)) {
 				throw std::runtime_error("failed to read meta park " + std::to_string(park_index));
 			}
 			uint32_t meta[N_META_OUT] = {};
@@ -164,29 +508,31 @@ std::vector<proof_data_t> Prover::get_qualities(const hash_t& challenge, const i
 
 proof_data_t Prover::get_full_proof(const uint64_t final_index) const
 {
-	std::ifstream file(file_path, std::ios_base::binary);
-	if(!file.good()) {
-		throw std::runtime_error("failed to open file");
-	}
+	const auto file = get_file();
+
 	std::vector<uint32_t> X_values;
 	std::vector<uint64_t> pointers;
 	pointers.push_back(final_index);
 
-	std::vector<uint64_t> pd_park(cdiv(header->park_bytes_pd, 8));
+	// reused per thread, one park per pointer
+	thread_local std::vector<std::vector<uint64_t>> parks;
 
 	int table = N_TABLE;
 	for(const auto pd_offset : header->table_offset_pd)
 	{
+		// issue all park reads of this level at once
+		std::vector<uint64_t> park_offsets;
+		for(const auto index : pointers) {
+			park_offsets.push_back(pd_offset + (index / header->park_size_pd) * header->park_bytes_pd);
+		}
+		if(!read_parks(file, parks, park_offsets, header->park_bytes_pd, parallel_io)) {
+			throw std::runtime_error("failed to read PD park at table " + std::to_string(table));
+		}
 		std::vector<uint64_t> new_pointers;
-		for(const auto index : pointers)
+		for(size_t i = 0; i < pointers.size(); ++i)
 		{
-			const uint64_t park_index =  index / header->park_size_pd;
-			const uint32_t park_offset = index % header->park_size_pd;
-			file.seekg(pd_offset + park_index * header->park_bytes_pd);
-			file.read((char*)pd_park.data(), header->park_bytes_pd);
-			if(!file.good()) {
-				throw std::runtime_error("failed to read PD park " + std::to_string(park_index) + " at table " + std::to_string(table)); 
-			}
+			const auto& pd_park = parks[i];
+			const uint32_t park_offset = pointers[i] % header->park_size_pd;
 			const uint64_t position = read_bits(pd_park.data(), park_offset * header->ksize, header->ksize);
 			new_pointers.push_back(position);
 
@@ -206,17 +552,17 @@ proof_data_t Prover::get_full_proof(const uint64_t final_index) const
 	proof_data_t out;
 	out.index = final_index;
 
-	std::vector<uint64_t> x_park(cdiv(header->park_bytes_x, 8));
-
-	for(const auto index : pointers)
+	std::vector<uint64_t> park_offsets;
+	for(const auto index : pointers) {
+		park_offsets.push_back(header->table_offset_x + (index / header->park_size_x) * header->park_bytes_x);
+	}
+	if(!read_parks(file, parks, park_offsets, header->park_bytes_x, parallel_io)) {
+		throw std::runtime_error("failed to read X park");
+	}
+	for(size_t i = 0; i < pointers.size(); ++i)
 	{
-		const uint64_t park_index =  index / header->park_size_x;
-		const uint32_t park_offset = index % header->park_size_x;
-		file.seekg(header->table_offset_x + park_index * header->park_bytes_x);
-		file.read((char*)x_park.data(), header->park_bytes_x);
-		if(!file.good()) {
-			throw std::runtime_error("failed to read X park " + std::to_string(park_index));
-		}
+		const auto& x_park = parks[i];
+		const uint32_t park_offset = pointers[i] % header->park_size_x;
 		const uint64_t line_point = read_bits(x_park.data(), park_offset * header->entry_bits_x, header->entry_bits_x);
 
 		if(table == 2) {
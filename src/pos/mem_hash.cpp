@@ -6,8 +6,11 @@
  */
 
 #include <mmx/pos/mem_hash.h>
+#include <sha256_avx2.h>
+#include <sha256_avx512.h>
 
 #include <map>
+#include <vector>
 #include <cstring>
 #include <iostream>
 #include <stdexcept>
@@ -16,7 +19,7 @@
 namespace mmx {
 namespace pos {
 
-static const uint32_t MEM_HASH_INIT[16] = {
+const uint32_t MEM_HASH_INIT[16] = {
 	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
 	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174
 };
@@ -82,6 +85,39 @@ void calc_mem_hash(uint32_t* mem, uint8_t* hash, const int num_iter)
 	::memcpy(hash, state, N * 4);
 }
 
+bool mem_hash_avx2_available()
+{
+	static const bool value = avx2_available();
+	return value;
+}
+
+bool mem_hash_avx512_available()
+{
+	static const bool value = avx512_available();
+	return value;
+}
+
+void calc_mem_hash_batch(const uint8_t* key, uint8_t* hash, const uint32_t num_keys, const int num_iter)
+{
+	uint32_t i = 0;
+	if(mem_hash_avx512_available()) {
+		for(; i + 16 <= num_keys; i += 16) {
+			mem_hash_avx512_x16(key + i * 64, hash + i * 128, num_iter);
+		}
+	}
+	if(mem_hash_avx2_available()) {
+		for(; i + 8 <= num_keys; i += 8) {
+			mem_hash_avx2_x8(key + i * 64, hash + i * 128, num_iter);
+		}
+	}
+	if(i < num_keys) {
+		thread_local std::vector<uint32_t> mem(32 * 32);
+		for(; i < num_keys; ++i) {
+			gen_mem_array(mem.data(), key + i * 64, mem.size());
+			calc_mem_hash(mem.data(), hash + i * 128, num_iter);
+		}
+	}
+}
 
 } // pos
 } // mmx
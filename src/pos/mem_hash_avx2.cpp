@@ -0,0 +1,139 @@
+/*
+ * mem_hash_avx2.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+// gen_mem_array() + calc_mem_hash() for 8 keys in lockstep, one per 32-bit lane
+// mem is interleaved: word i of lane l at mem[i * 8 + l]
+
+#include <mmx/pos/mem_hash.h>
+
+#include <vector>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__AVX2__) || defined(_WIN32)
+
+#include <immintrin.h>
+
+
+namespace mmx {
+namespace pos {
+
+static constexpr int L = 8;
+static constexpr int N = 32;
+
+static inline __m256i rotl(const __m256i v, const int bits) {
+	return _mm256_or_si256(_mm256_slli_epi32(v, bits), _mm256_srli_epi32(v, 32 - bits));
+}
+
+static inline __m256i rotlv(const __m256i v, const __m256i bits) {
+	return _mm256_or_si256(_mm256_sllv_epi32(v, bits), _mm256_srlv_epi32(v, _mm256_sub_epi32(_mm256_set1_epi32(32), bits)));
+}
+
+#define HASHROUND_X8(a, b, c, d) \
+	a = _mm256_add_epi32(a, b); \
+	d = rotl(_mm256_xor_si256(d, a), 16); \
+	c = _mm256_add_epi32(c, d); \
+	b = rotl(_mm256_xor_si256(b, c), 12); \
+	a = _mm256_add_epi32(a, b); \
+	d = rotl(_mm256_xor_si256(d, a), 8); \
+	c = _mm256_add_epi32(c, d); \
+	b = rotl(_mm256_xor_si256(b, c), 7);
+
+void mem_hash_avx2_x8(const uint8_t* key, uint8_t* hash, const int num_iter)
+{
+	thread_local std::vector<uint32_t> mem_buf(N * N * L);
+
+	uint32_t* mem = mem_buf.data();
+	uint32_t tmp[L];
+	__m256i state[N];
+
+	// gen_mem_array()
+	for(int i = 0; i < 16; ++i) {
+		for(int l = 0; l < L; ++l) {
+			::memcpy(&tmp[l], key + l * 64 + i * 4, 4);
+		}
+		state[i] = _mm256_loadu_si256((const __m256i*)tmp);
+	}
+	for(int i = 0; i < 16; ++i) {
+		state[16 + i] = _mm256_set1_epi32(MEM_HASH_INIT[i]);
+	}
+	__m256i b = _mm256_setzero_si256();
+	__m256i c = _mm256_setzero_si256();
+
+	for(int i = 0; i < N * N; i += 32)
+	{
+		for(int j = 0; j < 4; ++j) {
+			for(int k = 0; k < 16; ++k) {
+				HASHROUND_X8(state[k], b, c, state[16 + k]);
+			}
+		}
+		for(int k = 0; k < 32; ++k) {
+			_mm256_storeu_si256((__m256i*)(mem + (i + k) * L), state[k]);
+		}
+	}
+
+	// calc_mem_hash()
+	for(int i = 0; i < N; ++i) {
+		state[i] = _mm256_loadu_si256((const __m256i*)(mem + ((N - 1) * N + i) * L));
+	}
+	const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+	for(int iter = 0; iter < num_iter; ++iter)
+	{
+		__m256i sum = _mm256_setzero_si256();
+		for(int i = 0; i < N; ++i) {
+			sum = _mm256_add_epi32(sum, rotl(state[i], i % 32));
+		}
+		const __m256i dir = _mm256_add_epi32(sum, _mm256_add_epi32(_mm256_slli_epi32(sum, 11), _mm256_slli_epi32(sum, 22)));
+
+		const __m256i bits = _mm256_and_si256(_mm256_srli_epi32(dir, 22), _mm256_set1_epi32(31));
+		const __m256i offset = _mm256_srli_epi32(dir, 27);
+
+		// index of (offset * N) for each lane
+		const __m256i row = _mm256_add_epi32(_mm256_slli_epi32(offset, 8), lane);
+
+		for(int i = 0; i < N; ++i) {
+			const __m256i index = _mm256_add_epi32(row, _mm256_set1_epi32(((iter + i) % N) * L));
+			const __m256i value = _mm256_i32gather_epi32((const int*)mem, index, 4);
+			state[i] = _mm256_add_epi32(state[i], _mm256_xor_si256(rotlv(value, bits), sum));
+		}
+
+		uint32_t row_index[L];
+		_mm256_storeu_si256((__m256i*)row_index, row);
+
+		for(int i = 0; i < N; ++i) {
+			_mm256_storeu_si256((__m256i*)tmp, state[i]);
+			for(int l = 0; l < L; ++l) {
+				mem[row_index[l] + i * L] ^= tmp[l];
+			}
+		}
+	}
+
+	for(int i = 0; i < N; ++i) {
+		_mm256_storeu_si256((__m256i*)tmp, state[i]);
+		for(int l = 0; l < L; ++l) {
+			::memcpy(hash + l * 128 + i * 4, &tmp[l], 4);
+		}
+	}
+}
+
+
+} // pos
+} // mmx
+
+#else
+
+namespace mmx {
+namespace pos {
+
+void mem_hash_avx2_x8(const uint8_t* key, uint8_t* hash, const int num_iter) {
+	throw std::logic_error("mem_hash_avx2_x8() not available");
+}
+
+} // pos
+} // mmx
+
+#endif // __AVX2__
@@ -0,0 +1,137 @@
+/*
+ * mem_hash_avx512.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+// gen_mem_array() + calc_mem_hash() for 16 keys in lockstep, one per 32-bit lane
+// mem is interleaved: word i of lane l at mem[i * 16 + l]
+
+#include <mmx/pos/mem_hash.h>
+
+#include <vector>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__AVX512F__) || defined(_WIN32)
+
+#include <immintrin.h>
+
+
+namespace mmx {
+namespace pos {
+
+static constexpr int L = 16;
+static constexpr int N = 32;
+
+// The unmasked forms of these intrinsics pass _mm512_undefined_epi32() as merge source,
+// which GCC 12 reports as uninitialized under -Wall. Full-mask maskz forms are the same instructions.
+static constexpr __mmask16 ALL_LANES = 0xFFFF;
+
+#define ROL_X16(a, n) _mm512_maskz_rol_epi32(ALL_LANES, a, n)
+#define ROLV_X16(a, n) _mm512_maskz_rolv_epi32(ALL_LANES, a, n)
+#define SLLI_X16(a, n) _mm512_maskz_slli_epi32(ALL_LANES, a, n)
+#define SRLI_X16(a, n) _mm512_maskz_srli_epi32(ALL_LANES, a, n)
+#define GATHER_X16(index, base) _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), ALL_LANES, index, base, 4)
+
+#define HASHROUND_X16(a, b, c, d) \
+	a = _mm512_add_epi32(a, b); \
+	d = ROL_X16(_mm512_xor_si512(d, a), 16); \
+	c = _mm512_add_epi32(c, d); \
+	b = ROL_X16(_mm512_xor_si512(b, c), 12); \
+	a = _mm512_add_epi32(a, b); \
+	d = ROL_X16(_mm512_xor_si512(d, a), 8); \
+	c = _mm512_add_epi32(c, d); \
+	b = ROL_X16(_mm512_xor_si512(b, c), 7);
+
+void mem_hash_avx512_x16(const uint8_t* key, uint8_t* hash, const int num_iter)
+{
+	thread_local std::vector<uint32_t> mem_buf(N * N * L);
+
+	uint32_t* mem = mem_buf.data();
+	uint32_t tmp[L];
+	__m512i state[N];
+
+	// gen_mem_array()
+	for(int i = 0; i < 16; ++i) {
+		for(int l = 0; l < L; ++l) {
+			::memcpy(&tmp[l], key + l * 64 + i * 4, 4);
+		}
+		state[i] = _mm512_loadu_si512(tmp);
+	}
+	for(int i = 0; i < 16; ++i) {
+		state[16 + i] = _mm512_set1_epi32(MEM_HASH_INIT[i]);
+	}
+	__m512i b = _mm512_setzero_si512();
+	__m512i c = _mm512_setzero_si512();
+
+	for(int i = 0; i < N * N; i += 32)
+	{
+		for(int j = 0; j < 4; ++j) {
+			for(int k = 0; k < 16; ++k) {
+				HASHROUND_X16(state[k], b, c, state[16 + k]);
+			}
+		}
+		for(int k = 0; k < 32; ++k) {
+			_mm512_storeu_si512(mem + (i + k) * L, state[k]);
+		}
+	}
+
+	// calc_mem_hash()
+	for(int i = 0; i < N; ++i) {
+		state[i] = _mm512_loadu_si512(mem + ((N - 1) * N + i) * L);
+	}
+	const __m512i lane = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+
+	for(int iter = 0; iter < num_iter; ++iter)
+	{
+		__m512i sum = _mm512_setzero_si512();
+		for(int i = 0; i < N; ++i) {
+			sum = _mm512_add_epi32(sum, ROLV_X16(state[i], _mm512_set1_epi32(i % 32)));
+		}
+		const __m512i dir = _mm512_add_epi32(sum, _mm512_add_epi32(SLLI_X16(sum, 11), SLLI_X16(sum, 22)));
+
+		const __m512i bits = _mm512_and_si512(SRLI_X16(dir, 22), _mm512_set1_epi32(31));
+		const __m512i offset = SRLI_X16(dir, 27);
+
+		// index of (offset * N) for each lane
+		const __m512i row = _mm512_add_epi32(SLLI_X16(offset, 9), lane);
+
+		for(int i = 0; i < N; ++i) {
+			const __m512i index = _mm512_add_epi32(row, _mm512_set1_epi32(((iter + i) % N) * L));
+			const __m512i value = GATHER_X16(index, mem);
+			state[i] = _mm512_add_epi32(state[i], _mm512_xor_si512(ROLV_X16(value, bits), sum));
+		}
+		// lanes never share an index, so scatter has no conflicts
+		for(int i = 0; i < N; ++i) {
+			const __m512i index = _mm512_add_epi32(row, _mm512_set1_epi32(i * L));
+			const __m512i value = GATHER_X16(index, mem);
+			_mm512_i32scatter_epi32(mem, index, _mm512_xor_si512(value, state[i]), 4);
+		}
+	}
+
+	for(int i = 0; i < N; ++i) {
+		_mm512_storeu_si512(tmp, state[i]);
+		for(int l = 0; l < L; ++l) {
+			::memcpy(hash + l * 128 + i * 4, &tmp[l], 4);
+		}
+	}
+}
+
+
+} // pos
+} // mmx
+
+#else
+
+namespace mmx {
+namespace pos {
+
+void mem_hash_avx512_x16(const uint8_t* key, uint8_t* hash, const int num_iter) {
+	throw std::logic_error("mem_hash_avx512_x16() not available");
+}
+
+} // pos
+} // mmx
+
+#endif // __AVX512F__
@@ -14,7 +14,6 @@
 #include <mmx/pos/cuda_recompute.h>
 #endif
 
-#include <set>
 #include <algorithm>
 #include <vnx/vnx.h>
 #include <vnx/ThreadPool.h>
@@ -23,63 +22,72 @@
 namespace mmx {
 namespace pos {
 
-static constexpr uint32_t MEM_SIZE = 32 * 32;
-
 static std::mutex g_mutex;
 static std::shared_ptr<vnx::ThreadPool> g_threads;
 
 
-void compute_f1(std::vector<uint32_t>* X_out,
-				std::vector<uint32_t>& Y_out,
-				std::vector<std::array<uint32_t, N_META>>& M_out,
-				std::mutex& mutex,
-				const uint32_t X,
-				const hash_t& id, const int ksize, const int xbits)
+/*
+ * Computes table 1 entries for X, writes (1 << xbits) entries to each output.
+ * Every call writes to its own range, so no locking is needed.
+ */
+void compute_f1(uint32_t* X_out, uint32_t* Y_out, std::array<uint32_t, N_META>* M_out,
+				const uint32_t X, const hash_t& id, const int ksize, const int xbits)
 {
 	const uint32_t kmask = ((uint64_t(1) << ksize) - 1);
 
-	std::vector<uint32_t> mem_buf(MEM_SIZE);
+	// keys are hashed in batches, see calc_mem_hash_batch()
+	static constexpr uint32_t BATCH_SIZE = 64;
 
-	for(uint32_t x_i = 0; x_i < (uint64_t(1) << xbits); ++x_i)
-	{
-		const uint32_t X_i = (X << xbits) | x_i;
+	std::vector<uint8_t> keys(BATCH_SIZE * 64);
+	std::vector<uint8_t> mem_hashes(BATCH_SIZE * 128);
 
-		uint32_t msg[9] = {};
-		msg[0] = X_i;
-		::memcpy(msg + 1, id.data(), id.size());
+	const uint64_t num_x = uint64_t(1) << xbits;
 
-		const hash_512_t key(&msg, sizeof(msg));
-		gen_mem_array(mem_buf.data(), key.data(), MEM_SIZE);
+	for(uint64_t x_begin = 0; x_begin < num_x; x_begin += BATCH_SIZE)
+	{
+		const uint32_t count = std::min<uint64_t>(num_x - x_begin, BATCH_SIZE);
 
-		uint8_t mem_hash[64 + 128] = {};
-		::memcpy(mem_hash, key.data(), key.size());
+		for(uint32_t j = 0; j < count; ++j)
+		{
+			uint32_t msg[9] = {};
+			msg[0] = (X << xbits) | (x_begin + j);
+			::memcpy(msg + 1, id.data(), id.size());
 
-		calc_mem_hash(mem_buf.data(), mem_hash + 64, MEM_HASH_ITER);
+			const hash_512_t key(&msg, sizeof(msg));
+			::memcpy(keys.data() + j * 64, key.data(), key.size());
+		}
+		calc_mem_hash_batch(keys.data(), mem_hashes.data(), count, MEM_HASH_ITER);
 
-		const hash_512_t mem_hash_hash(mem_hash, sizeof(mem_hash));
+		for(uint32_t j = 0; j < count; ++j)
+		{
+			uint8_t mem_hash[64 + 128] = {};
+			::memcpy(mem_hash, keys.data() + j * 64, 64);
+			::memcpy(mem_hash + 64, mem_hashes.data() + j * 128, 128);
 
-		uint32_t hash[16] = {};
-		::memcpy(hash, mem_hash_hash.data(), mem_hash_hash.size());
+			const hash_512_t mem_hash_hash(mem_hash, sizeof(mem_hash));
 
-		uint32_t Y_i = 0;
-		std::array<uint32_t, N_META> meta = {};
-		for(int i = 0; i < N_META; ++i) {
-			Y_i = Y_i ^ hash[i];
-			meta[i] = hash[i] & kmask;
-		}
-		Y_i &= kmask;
+			uint32_t hash[16] = {};
+			::memcpy(hash, mem_hash_hash.data(), mem_hash_hash.size());
 
-		std::lock_guard<std::mutex> lock(mutex);
-		if(X_out) {
-			X_out->push_back(X_i);
+			uint32_t Y_i = 0;
+			std::array<uint32_t, N_META> meta = {};
+			for(int i = 0; i < N_META; ++i) {
+				Y_i = Y_i ^ hash[i];
+				meta[i] = hash[i] & kmask;
+			}
+			const auto k = x_begin + j;
+			if(X_out) {
+				X_out[k] = (X << xbits) | k;
+			}
+			Y_out[k] = Y_i & kmask;
+			M_out[k] = meta;
 		}
-		Y_out.push_back(Y_i);
-		M_out.push_back(meta);
 	}
 }
 
 std::vector<std::pair<uint32_t, bytes_t<META_BYTES_OUT>>>
-compute(const std::vector<uint32_t>& X_values, std::vector<uint32_t>* X_out, const hash_t& id, const int ksize, const int xbits)
+compute(const std::vector<uint32_t>& X_values, std::vector<uint32_t>* X_out,
+		const hash_t& id, const int ksize, const int xbits, compute_stats_t* stats)
 {
 	if(ksize < 8 || ksize > 32) {
 		throw std::logic_error("invalid ksize");
@@ -114,35 +122,37 @@ compute(const std::vector<uint32_t>& X_values, std::vector<uint32_t>* X_out, con
 			vnx::log_info() << "Using " << num_threads << " CPU threads for proof recompute";
 		}
 	}
-	const auto X_set = std::set<uint32_t>(X_values.begin(), X_values.end());
+	// unique and sorted, same as std::set
+	auto X_list = X_values;
+	std::sort(X_list.begin(), X_list.end());
+	X_list.erase(std::unique(X_list.begin(), X_list.end()), X_list.end());
 
-	const uint64_t num_entries_1 = X_set.size() << xbits;
+	const uint64_t num_x = uint64_t(1) << xbits;
+	const uint64_t num_entries_1 = X_list.size() * num_x;
 
-	std::mutex mutex;
 	std::vector<int64_t> jobs;
-	std::vector<uint32_t> X_tmp;
-	std::vector<uint32_t> Y_tmp;
-	std::vector<uint32_t> mem_buf(MEM_SIZE);
-	std::vector<std::array<uint32_t, N_META>> M_tmp;
+	std::vector<uint32_t> X_tmp(X_out ? num_entries_1 : 0);
+	std::vector<uint32_t> Y_tmp(num_entries_1);
+	std::vector<std::array<uint32_t, N_META>> M_tmp(num_entries_1);
 
-//	const auto t1_begin = get_time_ms();
-
-	if(X_out) {
-		X_tmp.reserve(num_entries_1);
-	}
-	Y_tmp.reserve(num_entries_1);
-	M_tmp.reserve(num_entries_1);
+	const auto t1_begin = get_time_us();
 
-	for(const auto X : X_set)
+	for(size_t i = 0; i < X_list.size(); ++i)
 	{
+		const auto X = X_list[i];
+		const auto offset = i * num_x;
+		auto* X_ptr = X_out ? X_tmp.data() + offset : nullptr;
+		auto* Y_ptr = Y_tmp.data() + offset;
+		auto* M_ptr = M_tmp.data() + offset;
+
 		if(use_threads) {
 			const auto job = g_threads->add_task(
-				[X_out, &X_tmp, &Y_tmp, &M_tmp, &mutex, X, id, ksize, xbits]() {
-					compute_f1(X_out ? &X_tmp : nullptr, Y_tmp, M_tmp, mutex, X, id, ksize, xbits);
+				[X_ptr, Y_ptr, M_ptr, X, id, ksize, xbits]() {
+					compute_f1(X_ptr, Y_ptr, M_ptr, X, id, ksize, xbits);
 				});
 			jobs.push_back(job);
 		} else {
-			compute_f1(X_out ? &X_tmp : nullptr, Y_tmp, M_tmp, mutex, X, id, ksize, xbits);
+			compute_f1(X_ptr, Y_ptr, M_ptr, X, id, ksize, xbits);
 		}
 	}
 
@@ -150,9 +160,11 @@ compute(const std::vector<uint32_t>& X_values, std::vector<uint32_t>* X_out, con
 		g_threads->sync(jobs);
 		jobs.clear();
 	}
-//	std::cout << "Table 1 took " << (get_time_ms() - t1_begin) << " ms" << std::endl;
-
-	return compute_full(X_tmp, Y_tmp, M_tmp, X_out, id, ksize);
+	if(stats) {
+		stats->table_time_us[1] += get_time_us() - t1_begin;
+		stats->table_size[1] += num_entries_1;
+	}
+	return compute_full(X_tmp, Y_tmp, M_tmp, X_out, id, ksize, use_threads ? g_threads.get() : nullptr, stats);
 }
 
 hash_t calc_quality(const hash_t& challenge, const bytes_t<META_BYTES_OUT>& meta)
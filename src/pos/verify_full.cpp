@@ -9,16 +9,137 @@
 #include <mmx/hash_512_t.hpp>
 #include <mmx/utils.h>
 
+#include <set>
+#include <cstring>
+#include <algorithm>
+
 
 namespace mmx {
 namespace pos {
 
+typedef std::pair<uint32_t, uint32_t> entry_t;		// [Y, index]
+
+struct match_t {
+	uint32_t Y = 0;
+	uint32_t PL = 0;
+	uint32_t PR = 0;
+	std::array<uint32_t, N_META> meta = {};
+};
+
+// minimum number of entries per matching task
+static constexpr size_t MATCH_CHUNK_SIZE = 4096;
+
+/*
+ * Sort for proof ordering (enforce unique proofs): by Y, then by meta.
+ * Uses a stable LSD radix sort on Y, only runs of equal Y are sorted by meta.
+ */
+static void sort_entries(	std::vector<entry_t>& entries, std::vector<entry_t>& tmp,
+							const std::vector<std::array<uint32_t, N_META>>& M_tmp, const int ksize)
+{
+	const auto meta_less =
+		[&M_tmp](const entry_t& L, const entry_t& R) -> bool {
+			return M_tmp[L.second] < M_tmp[R.second];
+		};
+
+	if(entries.size() < 256) {
+		std::sort(entries.begin(), entries.end(),
+			[&meta_less](const entry_t& L, const entry_t& R) -> bool {
+				if(L.first == R.first) {
+					return meta_less(L, R);
+				}
+				return L.first < R.first;
+			});
+		return;
+	}
+	tmp.resize(entries.size());
+
+	for(int shift = 0; shift < ksize; shift += 8)
+	{
+		size_t offset[256] = {};
+		for(const auto& entry : entries) {
+			offset[(entry.first >> shift) & 0xFF]++;
+		}
+		size_t sum = 0;
+		for(auto& count : offset) {
+			const auto n = count;
+			count = sum;
+			sum += n;
+		}
+		for(const auto& entry : entries) {
+			tmp[offset[(entry.first >> shift) & 0xFF]++] = entry;
+		}
+		entries.swap(tmp);
+	}
+
+	for(size_t i = 0; i < entries.size();)
+	{
+		size_t k = i + 1;
+		while(k < entries.size() && entries[k].first == entries[i].first) {
+			k++;
+		}
+		if(k - i > 1) {
+			std::sort(entries.begin() + i, entries.begin() + k, meta_less);
+		}
+		i = k;
+	}
+}
+
+// matches for entries [begin, end), right side may be past end
+static void match_range(std::vector<match_t>& out,
+						const std::vector<entry_t>& entries,
+						const std::vector<std::array<uint32_t, N_META>>& M_tmp,
+						const size_t begin, const size_t end, const uint32_t kmask)
+{
+	for(size_t x = begin; x < end; ++x)
+	{
+		const auto YL = entries[x].first;
+
+		for(size_t y = x + 1; y < entries.size(); ++y)
+		{
+			const auto YR = entries[y].first;
+
+			if(YR == YL + 1) {
+				const auto PL = entries[x].second;
+				const auto PR = entries[y].second;
+				const auto& L_meta = M_tmp[PL];
+				const auto& R_meta = M_tmp[PR];
+
+				uint32_t hash[16] = {};
+				{
+					uint32_t msg[N_META * 2] = {};
+					for(int i = 0; i < N_META; ++i) {
+						msg[i] = L_meta[i];
+						msg[N_META + i] = R_meta[i];
+					}
+					const hash_512_t tmp(&msg, sizeof(msg));
+
+					::memcpy(hash, tmp.data(), tmp.size());
+				}
+				match_t match;
+				match.PL = PL;
+				match.PR = PR;
+				for(int i = 0; i < N_META; ++i) {
+					match.Y = match.Y ^ hash[i];
+					match.meta[i] = hash[i] & kmask;
+				}
+				match.Y &= kmask;
+
+				out.push_back(match);
+			}
+			else if(YR > YL) {
+				break;
+			}
+		}
+	}
+}
+
 std::vector<std::pair<uint32_t, bytes_t<META_BYTES_OUT>>>
 compute_full(	const std::vector<uint32_t>& X_in,
 				const std::vector<uint32_t>& Y_in,
 				std::vector<std::array<uint32_t, N_META>>& M_in,
 				std::vector<uint32_t>* X_out,
-				const hash_t& id, const int ksize)
+				const hash_t& id, const int ksize,
+				vnx::ThreadPool* threads, compute_stats_t* stats)
 {
 	if(M_in.size() != Y_in.size()) {
 		throw std::logic_error("input length mismatch");
@@ -26,7 +147,8 @@ compute_full(	const std::vector<uint32_t>& X_in,
 	const uint32_t kmask = ((uint64_t(1) << ksize) - 1);
 
 	std::vector<std::array<uint32_t, N_META>> M_tmp = std::move(M_in);
-	std::vector<std::pair<uint32_t, uint32_t>> entries;
+	std::vector<entry_t> entries;
+	std::vector<entry_t> sort_buf;
 	std::vector<std::vector<std::pair<uint32_t, uint32_t>>> LR_tmp(N_TABLE + 1);
 
 	entries.reserve(Y_in.size());
@@ -34,85 +156,70 @@ compute_full(	const std::vector<uint32_t>& X_in,
 		entries.emplace_back(Y_in[i], i);
 	}
 
-	// sort function for proof ordering (enforce unique proofs)
-	const auto sort_func =
-		[&M_tmp](const std::pair<uint32_t, uint32_t>& L, const std::pair<uint32_t, uint32_t>& R) -> bool {
-			if(L.first == R.first) {
-				return M_tmp[L.second] < M_tmp[R.second];
-			}
-			return L < R;
-		};
-
 	for(int t = 2; t <= N_TABLE; ++t)
 	{
-//		const auto time_begin = get_time_ms();
-
-		std::vector<std::array<uint32_t, N_META>> M_next;
-		std::vector<std::pair<uint32_t, uint32_t>> matches;
-
-		std::sort(entries.begin(), entries.end(), sort_func);
-
-//		std::cout << "Table " << t << " sort took " << (get_time_ms() - time_begin) << " ms" << std::endl;
-
-		for(size_t x = 0; x < entries.size(); ++x)
-		{
-			const auto YL = entries[x].first;
+		const auto time_begin = get_time_us();
 
-			for(size_t y = x + 1; y < entries.size(); ++y)
-			{
-				const auto YR = entries[y].first;
-
-				if(YR == YL + 1) {
-					const auto PL = entries[x].second;
-					const auto PR = entries[y].second;
-					const auto& L_meta = M_tmp[PL];
-					const auto& R_meta = M_tmp[PR];
-
-					uint32_t hash[16] = {};
-					{
-						uint32_t msg[N_META * 2] = {};
-						for(int i = 0; i < N_META; ++i) {
-							msg[i] = L_meta[i];
-							msg[N_META + i] = R_meta[i];
-						}
-						const hash_512_t tmp(&msg, sizeof(msg));
-
-						::memcpy(hash, tmp.data(), tmp.size());
-					}
-					uint32_t Y_i = 0;
-					std::array<uint32_t, N_META> meta = {};
-					for(int i = 0; i < N_META; ++i) {
-						Y_i = Y_i ^ hash[i];
-						meta[i] = hash[i] & kmask;
-					}
-					Y_i &= kmask;
+		sort_entries(entries, sort_buf, M_tmp, ksize);
 
-					matches.emplace_back(Y_i, M_next.size());
+		// chunks are matched in parallel, results are concatenated in order (same as serial)
+		const size_t num_chunks = threads ?
+				std::min<size_t>(std::max<size_t>(entries.size() / MATCH_CHUNK_SIZE, 1), 1024) : 1;
+		const size_t chunk_size = (entries.size() + num_chunks - 1) / num_chunks;
 
-					if(X_out) {
-						LR_tmp[t].emplace_back(PL, PR);
-					}
-					M_next.push_back(meta);
-				}
-				else if(YR > YL) {
-					break;
-				}
+		std::vector<std::vector<match_t>> chunks(num_chunks);
+		if(num_chunks > 1) {
+			std::vector<int64_t> jobs;
+			for(size_t i = 0; i < num_chunks; ++i) {
+				const auto begin = std::min(i * chunk_size, entries.size());
+				const auto end = std::min(begin + chunk_size, entries.size());
+				jobs.push_back(threads->add_task(
+					[&chunks, &entries, &M_tmp, i, begin, end, kmask]() {
+						match_range(chunks[i], entries, M_tmp, begin, end, kmask);
+					}));
 			}
+			threads->sync(jobs);
+		} else {
+			match_range(chunks[0], entries, M_tmp, 0, entries.size(), kmask);
 		}
 
-		if(matches.empty()) {
+		size_t num_matches = 0;
+		for(const auto& chunk : chunks) {
+			num_matches += chunk.size();
+		}
+		if(num_matches == 0) {
 			throw std::logic_error("zero matches at table " + std::to_string(t));
 		}
+		std::vector<std::array<uint32_t, N_META>> M_next;
+		M_next.reserve(num_matches);
+		entries.clear();
+
+		if(X_out) {
+			LR_tmp[t].reserve(num_matches);
+		}
+		for(const auto& chunk : chunks) {
+			for(const auto& match : chunk) {
+				entries.emplace_back(match.Y, M_next.size());
+				if(X_out) {
+					LR_tmp[t].emplace_back(match.PL, match.PR);
+				}
+				M_next.push_back(match.meta);
+			}
+		}
 		M_tmp = std::move(M_next);
-		entries = std::move(matches);
 
-//		std::cout << "Table " << t << " took " << (get_time_ms() - time_begin) << " ms, " << entries.size() << " entries" << std::endl;
+		if(stats) {
+			stats->table_time_us[t] += get_time_us() - time_begin;
+			stats->table_size[t] += entries.size();
+		}
 	}
 
+	const auto time_begin = get_time_us();
+
 	if(X_out) {
 		X_out->clear();
 	}
-	std::sort(entries.begin(), entries.end(), sort_func);
+	sort_entries(entries, sort_buf, M_tmp, ksize);
 
 	std::set<std::array<uint32_t, N_META>> M_set;
 	std::vector<std::pair<uint32_t, bytes_t<META_BYTES_OUT>>> out;
@@ -143,6 +250,9 @@ compute_full(	const std::vector<uint32_t>& X_in,
 			}
 		}
 	}
+	if(stats) {
+		stats->final_time_us += get_time_us() - time_begin;
+	}
 	return out;
 }
 
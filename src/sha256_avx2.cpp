@@ -11,6 +11,7 @@
 #include <mmx/hash_t.hpp>
 
 #include <cstring>
+#include <vector>
 #include <stdexcept>
 
 #if defined(__AVX2__) || defined(_WIN32)
@@ -22,7 +23,7 @@
 #define cpuid(info, x)    __cpuidex(info, x, 0)
 #else
 #include <cpuid.h>
-inline void cpuid(int info[4], int InfoType) {
+static inline void cpuid(int info[4], int InfoType) {
 	__cpuid_count(InfoType, 0, info[0], info[1], info[2], info[3]);
 }
 #endif
@@ -135,47 +136,15 @@ inline void transpose(u256 s[8])
     s[7] = _mm256_permute2x128_si256(tmp1[3], tmp1[7], 0x31);
 }
 
-void sha256_avx2_64_x8(uint8_t* out, uint8_t* in, const uint64_t length)
+// 64 rounds on 8 lanes, w[0..15] = message block (transposed), adds previous state
+inline void compress_x8(u256 s[8], u256 w[64])
 {
-	if(length >= 56) {
-		throw std::logic_error("length >= 56");
-	}
-	const uint8_t end_bit = 0x80;
-	const uint64_t num_bits = bswap_64(length * 8);
-	const __m128i MASK = _mm_set_epi64x(0x0c0d0e0f08090a0b, 0x0405060700010203);
-
+	u256 T0, T1;
+	u256 prev[8];
 	for(int i = 0; i < 8; ++i) {
-		::memset(in + i * 64 + length, 0, 64 - length);
-		::memcpy(in + i * 64 + length, &end_bit, 1);
-		::memcpy(in + i * 64 + 56, &num_bits, 8);
-
-		__m128i* input_mm = reinterpret_cast<__m128i*>(in + i * 64);
-		for(int k = 0; k < 4; ++k) {
-			input_mm[k] = _mm_shuffle_epi8(input_mm[k], MASK);
-		}
-	}
-
-	u256 s[8], w[64], T0, T1;
-
-	// Load words and transform data correctly
-	for(int i = 0; i < 8; i++) {
-		w[i] = LOAD(in + 64*i);
-		w[i + 8] = LOAD(in + 32 + 64*i);
+		prev[i] = s[i];
 	}
 
-	transpose(w);
-	transpose(w + 8);
-
-	// Initial State
-	s[0] = _mm256_set_epi32(0x6a09e667,0x6a09e667,0x6a09e667,0x6a09e667,0x6a09e667,0x6a09e667,0x6a09e667,0x6a09e667);
-	s[1] = _mm256_set_epi32(0xbb67ae85,0xbb67ae85,0xbb67ae85,0xbb67ae85,0xbb67ae85,0xbb67ae85,0xbb67ae85,0xbb67ae85);
-	s[2] = _mm256_set_epi32(0x3c6ef372,0x3c6ef372,0x3c6ef372,0x3c6ef372,0x3c6ef372,0x3c6ef372,0x3c6ef372,0x3c6ef372);
-	s[3] = _mm256_set_epi32(0xa54ff53a,0xa54ff53a,0xa54ff53a,0xa54ff53a,0xa54ff53a,0xa54ff53a,0xa54ff53a,0xa54ff53a);
-	s[4] = _mm256_set_epi32(0x510e527f,0x510e527f,0x510e527f,0x510e527f,0x510e527f,0x510e527f,0x510e527f,0x510e527f);
-	s[5] = _mm256_set_epi32(0x9b05688c,0x9b05688c,0x9b05688c,0x9b05688c,0x9b05688c,0x9b05688c,0x9b05688c,0x9b05688c);
-	s[6] = _mm256_set_epi32(0x1f83d9ab,0x1f83d9ab,0x1f83d9ab,0x1f83d9ab,0x1f83d9ab,0x1f83d9ab,0x1f83d9ab,0x1f83d9ab);
-	s[7] = _mm256_set_epi32(0x5be0cd19,0x5be0cd19,0x5be0cd19,0x5be0cd19,0x5be0cd19,0x5be0cd19,0x5be0cd19,0x5be0cd19);
-
 	SHA256ROUND_AVX(s[0], s[1], s[2], s[3], s[4], s[5], s[6], s[7], 0, w[0]);
 	SHA256ROUND_AVX(s[7], s[0], s[1], s[2], s[3], s[4], s[5], s[6], 1, w[1]);
 	SHA256ROUND_AVX(s[6], s[7], s[0], s[1], s[2], s[3], s[4], s[5], 2, w[2]);
@@ -289,16 +258,56 @@ void sha256_avx2_64_x8(uint8_t* out, uint8_t* in, const uint64_t length)
 	w[63] = ADD4_32(WSIGMA1_AVX(w[61]), w[47], w[56], WSIGMA0_AVX(w[48]));
 	SHA256ROUND_AVX(s[1], s[2], s[3], s[4], s[5], s[6], s[7], s[0], 63, w[63]);
 
+	for(int i = 0; i < 8; ++i) {
+		s[i] = ADD32(s[i], prev[i]);
+	}
+}
 
-	// Feed Forward
-	s[0] = ADD32(s[0], _mm256_set_epi32(0x6a09e667,0x6a09e667,0x6a09e667,0x6a09e667,0x6a09e667,0x6a09e667,0x6a09e667,0x6a09e667));
-	s[1] = ADD32(s[1], _mm256_set_epi32(0xbb67ae85,0xbb67ae85,0xbb67ae85,0xbb67ae85,0xbb67ae85,0xbb67ae85,0xbb67ae85,0xbb67ae85));
-	s[2] = ADD32(s[2], _mm256_set_epi32(0x3c6ef372,0x3c6ef372,0x3c6ef372,0x3c6ef372,0x3c6ef372,0x3c6ef372,0x3c6ef372,0x3c6ef372));
-	s[3] = ADD32(s[3], _mm256_set_epi32(0xa54ff53a,0xa54ff53a,0xa54ff53a,0xa54ff53a,0xa54ff53a,0xa54ff53a,0xa54ff53a,0xa54ff53a));
-	s[4] = ADD32(s[4], _mm256_set_epi32(0x510e527f,0x510e527f,0x510e527f,0x510e527f,0x510e527f,0x510e527f,0x510e527f,0x510e527f));
-	s[5] = ADD32(s[5], _mm256_set_epi32(0x9b05688c,0x9b05688c,0x9b05688c,0x9b05688c,0x9b05688c,0x9b05688c,0x9b05688c,0x9b05688c));
-	s[6] = ADD32(s[6], _mm256_set_epi32(0x1f83d9ab,0x1f83d9ab,0x1f83d9ab,0x1f83d9ab,0x1f83d9ab,0x1f83d9ab,0x1f83d9ab,0x1f83d9ab));
-	s[7] = ADD32(s[7], _mm256_set_epi32(0x5be0cd19,0x5be0cd19,0x5be0cd19,0x5be0cd19,0x5be0cd19,0x5be0cd19,0x5be0cd19,0x5be0cd19));
+static void init_state_x8(u256 s[8])
+{
+	s[0] = _mm256_set1_epi32(0x6a09e667);
+	s[1] = _mm256_set1_epi32(0xbb67ae85);
+	s[2] = _mm256_set1_epi32(0x3c6ef372);
+	s[3] = _mm256_set1_epi32(0xa54ff53a);
+	s[4] = _mm256_set1_epi32(0x510e527f);
+	s[5] = _mm256_set1_epi32(0x9b05688c);
+	s[6] = _mm256_set1_epi32(0x1f83d9ab);
+	s[7] = _mm256_set1_epi32(0x5be0cd19);
+}
+
+void sha256_avx2_64_x8(uint8_t* out, uint8_t* in, const uint64_t length)
+{
+	if(length >= 56) {
+		throw std::logic_error("length >= 56");
+	}
+	const uint8_t end_bit = 0x80;
+	const uint64_t num_bits = bswap_64(length * 8);
+	const __m128i MASK = _mm_set_epi64x(0x0c0d0e0f08090a0b, 0x0405060700010203);
+
+	for(int i = 0; i < 8; ++i) {
+		::memset(in + i * 64 + length, 0, 64 - length);
+		::memcpy(in + i * 64 + length, &end_bit, 1);
+		::memcpy(in + i * 64 + 56, &num_bits, 8);
+
+		__m128i* input_mm = reinterpret_cast<__m128i*>(in + i * 64);
+		for(int k = 0; k < 4; ++k) {
+			input_mm[k] = _mm_shuffle_epi8(input_mm[k], MASK);
+		}
+	}
+
+	u256 s[8], w[64];
+
+	// Load words and transform data correctly
+	for(int i = 0; i < 8; i++) {
+		w[i] = LOAD(in + 64*i);
+		w[i + 8] = LOAD(in + 32 + 64*i);
+	}
+
+	transpose(w);
+	transpose(w + 8);
+
+	init_state_x8(s);
+	compress_x8(s, w);
 
 	// Transpose data again to get correct output
 	transpose(s);
@@ -315,6 +324,54 @@ void sha256_avx2_64_x8(uint8_t* out, uint8_t* in, const uint64_t length)
 	}
 }
 
+void sha256_avx2_x8(uint8_t* out, const uint8_t* in, const uint64_t length)
+{
+	const uint64_t num_blocks = (length + 9 + 63) / 64;
+	const __m256i MASK = _mm256_set_epi64x(0x0c0d0e0f08090a0b, 0x0405060700010203, 0x0c0d0e0f08090a0b, 0x0405060700010203);
+
+	// padded messages, one after another
+	thread_local std::vector<uint8_t> buffer;
+	buffer.assign(8 * num_blocks * 64, 0);
+
+	const uint8_t end_bit = 0x80;
+	const uint64_t num_bits = bswap_64(length * 8);
+
+	for(int i = 0; i < 8; ++i) {
+		uint8_t* msg = buffer.data() + i * num_blocks * 64;
+		::memcpy(msg, in + i * length, length);
+		::memcpy(msg + length, &end_bit, 1);
+		::memcpy(msg + num_blocks * 64 - 8, &num_bits, 8);
+	}
+
+	u256 s[8], w[64];
+	init_state_x8(s);
+
+	for(uint64_t k = 0; k < num_blocks; ++k)
+	{
+		for(int i = 0; i < 8; i++) {
+			const uint8_t* block = buffer.data() + (i * num_blocks + k) * 64;
+			w[i] = _mm256_shuffle_epi8(LOAD(block), MASK);
+			w[i + 8] = _mm256_shuffle_epi8(LOAD(block + 32), MASK);
+		}
+		transpose(w);
+		transpose(w + 8);
+
+		compress_x8(s, w);
+	}
+
+	transpose(s);
+
+	for(int i = 0; i < 8; i++) {
+		STORE(out + 32*i, s[i]);
+	}
+	for(int i = 0; i < 8; ++i) {
+		for(int k = 0; k < 8; ++k) {
+			auto& val = ((uint32_t*)out)[i * 8 + k];
+			val = bswap_32(val);
+		}
+	}
+}
+
 bool avx2_available()
 {
 	bool HW_AVX2 = false;
@@ -345,6 +402,10 @@ void sha256_avx2_64_x8(uint8_t* out, uint8_t* in, const uint64_t length) {
 	throw std::logic_error("sha256_avx2() not available");
 }
 
+void sha256_avx2_x8(uint8_t* out, const uint8_t* in, const uint64_t length) {
+	throw std::logic_error("sha256_avx2() not available");
+}
+
 bool avx2_available() {
 	return false;
 }
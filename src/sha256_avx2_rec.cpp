@@ -0,0 +1,143 @@
+/*
+ * sha256_avx2_rec.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+// prerequisite: length is 32 bytes per lane (recursive sha256)
+// hash: 8 lanes x 32 bytes, state stays transposed in registers across all iterations
+
+#include <sha256_avx2.h>
+
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__AVX2__) || defined(_WIN32)
+
+#include <immintrin.h>
+
+static const uint32_t K64[64] = {
+	0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5,
+	0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+	0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3,
+	0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+	0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC,
+	0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+	0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7,
+	0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+	0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13,
+	0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+	0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3,
+	0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+	0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5,
+	0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+	0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208,
+	0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2
+};
+
+static const uint32_t H_INIT[8] = {
+	0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+#define ROTR(x, n) _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - n))
+#define XOR3(a, b, c) _mm256_xor_si256(_mm256_xor_si256(a, b), c)
+
+#define SIGMA0(x) XOR3(ROTR(x, 2), ROTR(x, 13), ROTR(x, 22))
+#define SIGMA1(x) XOR3(ROTR(x, 6), ROTR(x, 11), ROTR(x, 25))
+#define WSIGMA0(x) XOR3(ROTR(x, 7), ROTR(x, 18), _mm256_srli_epi32(x, 3))
+#define WSIGMA1(x) XOR3(ROTR(x, 17), ROTR(x, 19), _mm256_srli_epi32(x, 10))
+
+#define CH(e, f, g) _mm256_xor_si256(_mm256_and_si256(e, _mm256_xor_si256(f, g)), g)
+#define MAJ(a, b, c) _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)))
+
+static inline uint32_t load_be32(const uint8_t* src) {
+	return (uint32_t(src[0]) << 24) | (uint32_t(src[1]) << 16) | (uint32_t(src[2]) << 8) | uint32_t(src[3]);
+}
+
+static inline void store_be32(uint8_t* dst, const uint32_t val) {
+	dst[0] = val >> 24; dst[1] = val >> 16; dst[2] = val >> 8; dst[3] = val;
+}
+
+void recursive_sha256_avx2_x8(uint8_t* hash, const uint64_t num_iters)
+{
+	if(num_iters <= 0) {
+		return;
+	}
+	alignas(32) uint32_t tmp[8][8];
+
+	// transpose: state[i] holds word i of all lanes
+	for(int k = 0; k < 8; ++k) {
+		for(int i = 0; i < 8; ++i) {
+			tmp[i][k] = load_be32(hash + k * 32 + i * 4);
+		}
+	}
+	__m256i state[8];
+	for(int i = 0; i < 8; ++i) {
+		state[i] = _mm256_load_si256(reinterpret_cast<const __m256i*>(tmp[i]));
+	}
+
+	for(uint64_t iter = 0; iter < num_iters; ++iter)
+	{
+		// message is previous hash + constant padding for 32 bytes
+		__m256i w[16];
+		for(int i = 0; i < 8; ++i) {
+			w[i] = state[i];
+		}
+		w[8] = _mm256_set1_epi32(0x80000000);
+		for(int i = 9; i < 15; ++i) {
+			w[i] = _mm256_setzero_si256();
+		}
+		w[15] = _mm256_set1_epi32(256);
+
+		__m256i a = _mm256_set1_epi32(H_INIT[0]);
+		__m256i b = _mm256_set1_epi32(H_INIT[1]);
+		__m256i c = _mm256_set1_epi32(H_INIT[2]);
+		__m256i d = _mm256_set1_epi32(H_INIT[3]);
+		__m256i e = _mm256_set1_epi32(H_INIT[4]);
+		__m256i f = _mm256_set1_epi32(H_INIT[5]);
+		__m256i g = _mm256_set1_epi32(H_INIT[6]);
+		__m256i h = _mm256_set1_epi32(H_INIT[7]);
+
+		for(int r = 0; r < 64; ++r)
+		{
+			if(r >= 16) {
+				w[r & 15] = _mm256_add_epi32(
+						_mm256_add_epi32(WSIGMA1(w[(r - 2) & 15]), w[(r - 7) & 15]),
+						_mm256_add_epi32(WSIGMA0(w[(r - 15) & 15]), w[r & 15]));
+			}
+			const __m256i T0 = _mm256_add_epi32(
+					_mm256_add_epi32(_mm256_add_epi32(h, SIGMA1(e)), CH(e, f, g)),
+					_mm256_add_epi32(_mm256_set1_epi32(K64[r]), w[r & 15]));
+			const __m256i T1 = _mm256_add_epi32(SIGMA0(a), MAJ(a, b, c));
+			h = g; g = f; f = e;
+			e = _mm256_add_epi32(d, T0);
+			d = c; c = b; b = a;
+			a = _mm256_add_epi32(T0, T1);
+		}
+		state[0] = _mm256_add_epi32(a, _mm256_set1_epi32(H_INIT[0]));
+		state[1] = _mm256_add_epi32(b, _mm256_set1_epi32(H_INIT[1]));
+		state[2] = _mm256_add_epi32(c, _mm256_set1_epi32(H_INIT[2]));
+		state[3] = _mm256_add_epi32(d, _mm256_set1_epi32(H_INIT[3]));
+		state[4] = _mm256_add_epi32(e, _mm256_set1_epi32(H_INIT[4]));
+		state[5] = _mm256_add_epi32(f, _mm256_set1_epi32(H_INIT[5]));
+		state[6] = _mm256_add_epi32(g, _mm256_set1_epi32(H_INIT[6]));
+		state[7] = _mm256_add_epi32(h, _mm256_set1_epi32(H_INIT[7]));
+	}
+
+	for(int i = 0; i < 8; ++i) {
+		_mm256_store_si256(reinterpret_cast<__m256i*>(tmp[i]), state[i]);
+	}
+	for(int k = 0; k < 8; ++k) {
+		for(int i = 0; i < 8; ++i) {
+			store_be32(hash + k * 32 + i * 4, tmp[i][k]);
+		}
+	}
+}
+
+#else
+
+void recursive_sha256_avx2_x8(uint8_t* hash, const uint64_t num_iters) {
+	throw std::logic_error("recursive_sha256_avx2_x8() not available");
+}
+
+#endif // __AVX2__
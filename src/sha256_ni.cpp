@@ -19,7 +19,7 @@
 #define cpuid(info, x)    __cpuidex(info, x, 0)
 #else
 #include <cpuid.h>
-inline void cpuid(int info[4], int InfoType) {
+static inline void cpuid(int info[4], int InfoType) {
 	__cpuid_count(InfoType, 0, info[0], info[1], info[2], info[3]);
 }
 #endif
@@ -7,18 +7,64 @@
 
 #include <mmx/signature_t.hpp>
 
+#include <vnx/vnx.h>
+#include <vnx/ThreadPool.h>
+
 #include <tuple>
+#include <atomic>
+#include <thread>
 
 
 namespace mmx {
 
-std::mutex g_mutex;
-
 // prevent attacker from generating cache collisions on every node
 const auto hash_salt = vnx::Hash64::rand();
 
-std::array<std::tuple<hash_t, pubkey_t, signature_t>, 16384> g_sig_cache;
+// caches are split into shards with their own mutex, so parallel verify() don't contend
+static constexpr size_t CACHE_SHARDS = 64;
+
+struct sig_cache_shard_t {
+	std::mutex mutex;
+	std::array<std::tuple<hash_t, pubkey_t, signature_t>, 512> entries;
+	std::array<bool, 512> is_valid = {};
+};
+
+struct key_cache_shard_t {
+	std::mutex mutex;
+	std::array<std::pair<pubkey_t, secp256k1_pubkey>, 256> entries;
+	std::array<bool, 256> is_valid = {};
+};
+
+static std::array<sig_cache_shard_t, CACHE_SHARDS> g_sig_cache;
+static std::array<key_cache_shard_t, CACHE_SHARDS> g_key_cache;
+
+static std::mutex g_mutex;
+static std::shared_ptr<vnx::ThreadPool> g_threads;
+static std::atomic<uint64_t> g_cache_hits {0};
+
+
+// parsed pubkeys are cached, since the same keys sign over and over again
+static secp256k1_pubkey parse_pubkey(const pubkey_t& pubkey)
+{
+	const size_t key_hash = vnx::Hash64(pubkey.crc64(), hash_salt);
 
+	auto& shard = g_key_cache[key_hash % CACHE_SHARDS];
+	const auto index = (key_hash / CACHE_SHARDS) % shard.entries.size();
+	{
+		std::lock_guard lock(shard.mutex);
+		const auto& entry = shard.entries[index];
+		if(shard.is_valid[index] && entry.first == pubkey) {
+			return entry.second;
+		}
+	}
+	const auto key = pubkey.to_secp256k1();
+	{
+		std::lock_guard lock(shard.mutex);
+		shard.entries[index] = std::make_pair(pubkey, key);
+		shard.is_valid[index] = true;
+	}
+	return key;
+}
 
 signature_t::signature_t(const secp256k1_ecdsa_signature& sig)
 {
@@ -55,24 +101,81 @@ bool signature_t::verify(const pubkey_t& pubkey, const hash_t& hash) const
 {
 	const size_t sig_hash = vnx::Hash64(crc64(), hash_salt);
 
-	const auto entry = std::make_tuple(hash, pubkey, *this);
+	auto entry = std::make_tuple(hash, pubkey, *this);
 
-	auto& cache = g_sig_cache[sig_hash % g_sig_cache.size()];
+	auto& shard = g_sig_cache[sig_hash % CACHE_SHARDS];
+	const auto index = (sig_hash / CACHE_SHARDS) % shard.entries.size();
 	{
-		std::lock_guard lock(g_mutex);
-		if(entry == cache) {
+		std::lock_guard lock(shard.mutex);
+		if(shard.is_valid[index] && entry == shard.entries[index]) {
+			g_cache_hits++;
 			return true;
 		}
 	}
 	const auto sig = to_secp256k1();
-	const auto key = pubkey.to_secp256k1();
+	const auto key = parse_pubkey(pubkey);
 	const bool res = secp256k1_ecdsa_verify(g_secp256k1, &sig, hash.data(), &key);
 	if(res) {
-		std::lock_guard lock(g_mutex);
-		cache = entry;
+		std::lock_guard lock(shard.mutex);
+		shard.entries[index] = std::move(entry);
+		shard.is_valid[index] = true;
 	}
 	return res;
 }
 
+std::vector<bool> signature_t::verify_many(const std::vector<std::tuple<hash_t, pubkey_t, signature_t>>& list)
+{
+	const size_t chunk_size = 64;
+
+	std::vector<uint8_t> result(list.size());
+
+	const auto verify_range = [&list, &result](const size_t begin, const size_t end) {
+		for(size_t i = begin; i < end; ++i) {
+			const auto& entry = list[i];
+			try {
+				result[i] = std::get<2>(entry).verify(std::get<1>(entry), std::get<0>(entry));
+			} catch(...) {
+				// invalid pubkey or signature
+			}
+		}
+	};
+
+	if(list.size() <= chunk_size) {
+		verify_range(0, list.size());
+	} else {
+		std::shared_ptr<vnx::ThreadPool> threads;
+		{
+			std::lock_guard<std::mutex> lock(g_mutex);
+			if(!g_threads) {
+				const auto cpu_threads = std::thread::hardware_concurrency();
+				const auto num_threads = cpu_threads > 0 ? cpu_threads : 16;
+				g_threads = std::make_shared<vnx::ThreadPool>(num_threads, 1024);
+			}
+			threads = g_threads;
+		}
+		std::vector<int64_t> jobs;
+		for(size_t i = 0; i < list.size(); i += chunk_size) {
+			const auto end = std::min(i + chunk_size, list.size());
+			jobs.push_back(threads->add_task(std::bind(verify_range, i, end)));
+		}
+		threads->sync(jobs);
+	}
+	return std::vector<bool>(result.begin(), result.end());
+}
+
+uint64_t signature_t::get_cache_hits()
+{
+	return g_cache_hits;
+}
+
+void signature_t::shutdown()
+{
+	std::lock_guard<std::mutex> lock(g_mutex);
+	if(g_threads) {
+		g_threads->close();
+		g_threads = nullptr;
+	}
+}
+
 
 } // mmx
@@ -0,0 +1,103 @@
+/*
+ * tree_hash.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <mmx/tree_hash.h>
+
+#include <sha256_avx2.h>
+
+#include <vnx/ThreadPool.h>
+
+#include <mutex>
+#include <thread>
+#include <cstring>
+
+
+namespace mmx {
+
+static_assert(sizeof(hash_t) == 32, "sizeof(hash_t) != 32");
+
+static constexpr size_t PARALLEL_MIN_PAIRS = 16384;
+static constexpr size_t PARALLEL_CHUNK_SIZE = 4096;
+
+static std::mutex g_mutex;
+static std::shared_ptr<vnx::ThreadPool> g_threads;
+
+
+// out[i] = hash(in[2 * i] + in[2 * i + 1]) for i in [begin, end)
+static void hash_pairs(hash_t* out, const hash_t* in, const size_t begin, const size_t end)
+{
+	size_t i = begin;
+	for(; i + 8 <= end; i += 8) {
+		sha256_x8(out[i].data(), in[2 * i].data(), 64);
+	}
+	for(; i < end; ++i) {
+		out[i] = hash_t(in[2 * i].data(), 64);
+	}
+}
+
+hash_t calc_btree_hash(const std::vector<hash_t>& input)
+{
+	if(input.empty()) {
+		return hash_t();
+	}
+	if(input.size() == 1) {
+		return input[0];
+	}
+	// two buffers, levels are hashed back and forth
+	std::vector<hash_t> tmp((input.size() + 1) / 2);
+	std::vector<hash_t> next((tmp.size() + 1) / 2);
+
+	const hash_t* in = input.data();
+	hash_t* out = tmp.data();
+
+	size_t count = input.size();
+	while(count > 1)
+	{
+		const size_t num_pairs = count / 2;
+
+		if(num_pairs >= PARALLEL_MIN_PAIRS) {
+			std::shared_ptr<vnx::ThreadPool> threads;
+			{
+				std::lock_guard<std::mutex> lock(g_mutex);
+				if(!g_threads) {
+					const auto cpu_threads = std::thread::hardware_concurrency();
+					g_threads = std::make_shared<vnx::ThreadPool>(cpu_threads > 0 ? cpu_threads : 16, 1024);
+				}
+				threads = g_threads;
+			}
+			std::vector<int64_t> jobs;
+			for(size_t i = 0; i < num_pairs; i += PARALLEL_CHUNK_SIZE) {
+				const auto end = std::min(i + PARALLEL_CHUNK_SIZE, num_pairs);
+				jobs.push_back(threads->add_task([out, in, i, end]() {
+					hash_pairs(out, in, i, end);
+				}));
+			}
+			threads->sync(jobs);
+		} else {
+			hash_pairs(out, in, 0, num_pairs);
+		}
+		if(count % 2) {
+			out[num_pairs] = in[count - 1];
+		}
+		count = (count + 1) / 2;
+
+		in = out;
+		out = (out == tmp.data() ? next.data() : tmp.data());
+	}
+	return in[0];
+}
+
+void tree_hash_shutdown()
+{
+	std::lock_guard<std::mutex> lock(g_mutex);
+	if(g_threads) {
+		g_threads->close();
+		g_threads = nullptr;
+	}
+}
+
+
+} // mmx
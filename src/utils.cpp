@@ -6,6 +6,12 @@
  */
 
 #include <mmx/utils.h>
+#include <mmx/Block.hxx>
+#include <mmx/Transaction.hxx>
+#include <mmx/solution/PubKey.hxx>
+#include <mmx/solution/MultiSig.hxx>
+
+#include <sha256_avx2.h>
 
 #include <vnx/vnx.h>
 
@@ -125,5 +131,67 @@ uint64_t get_num_bytes(const vnx::Variant& var)
 	return var.size();
 }
 
+std::vector<bool> check_plot_filter(
+		std::shared_ptr<const ChainParams> params, const hash_t& challenge, const std::vector<hash_t>& plot_ids)
+{
+	static const std::string prefix = "plot_filter";
+	const size_t msg_size = prefix.size() + 32 + 32;
+
+	std::vector<bool> out(plot_ids.size());
+	std::vector<uint8_t> msg(8 * msg_size);
+	uint8_t hash[8 * 32];
+
+	for(size_t i = 0; i < plot_ids.size(); i += 8)
+	{
+		const size_t count = std::min<size_t>(plot_ids.size() - i, 8);
+		for(size_t k = 0; k < 8; ++k) {
+			auto* dst = msg.data() + k * msg_size;
+			::memcpy(dst, prefix.data(), prefix.size());
+			::memcpy(dst + prefix.size(), plot_ids[i + std::min(k, count - 1)].data(), 32);
+			::memcpy(dst + prefix.size() + 32, challenge.data(), 32);
+		}
+		sha256_x8(hash, msg.data(), msg_size);
+
+		for(size_t k = 0; k < count; ++k) {
+			out[i + k] = (hash_t::from_bytes(hash + k * 32).to_uint256() >> (256 - params->plot_filter)) == 0;
+		}
+	}
+	return out;
+}
+
+static void get_signatures(std::shared_ptr<const Solution> sol, const hash_t& txid, std::vector<std::tuple<hash_t, pubkey_t, signature_t>>& out)
+{
+	if(auto pubkey = std::dynamic_pointer_cast<const solution::PubKey>(sol)) {
+		out.emplace_back(txid, pubkey->pubkey, pubkey->signature);
+	}
+	else if(auto multi = std::dynamic_pointer_cast<const solution::MultiSig>(sol)) {
+		for(const auto& entry : multi->solutions) {
+			if(auto pubkey = std::dynamic_pointer_cast<const solution::PubKey>(entry.second)) {
+				out.emplace_back(txid, pubkey->pubkey, pubkey->signature);
+			}
+		}
+	}
+}
+
+std::vector<std::tuple<hash_t, pubkey_t, signature_t>> get_signatures(const std::vector<std::shared_ptr<const Transaction>>& tx_list)
+{
+	std::vector<std::tuple<hash_t, pubkey_t, signature_t>> out;
+	for(const auto& tx : tx_list) {
+		if(tx) {
+			for(const auto& sol : tx->solutions) {
+				get_signatures(sol, tx->id, out);
+			}
+		}
+	}
+	return out;
+}
+
+std::shared_ptr<Block> make_header_only(std::shared_ptr<const BlockHeader> header)
+{
+	auto block = Block::create();
+	block->BlockHeader::operator=(*header);
+	return block;
+}
+
 
 } // mmx
@@ -0,0 +1,244 @@
+/*
+ * vdf_verifier_t.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <mmx/vdf_verifier_t.h>
+#include <mmx/utils.h>
+
+#include <sha256_avx2.h>
+#include <sha256_avx512.h>
+#include <sha256_ni.h>
+#include <sha256_arm.h>
+
+#include <cstring>
+#include <stdexcept>
+
+
+namespace mmx {
+
+vdf_verifier_t::vdf_verifier_t(const size_t num_threads)
+{
+	const auto count = num_threads ? num_threads : std::max<size_t>(std::thread::hardware_concurrency(), 1);
+	for(size_t i = 0; i < count; ++i) {
+		threads.emplace_back(&vdf_verifier_t::worker, this);
+	}
+}
+
+vdf_verifier_t::~vdf_verifier_t()
+{
+	close();
+}
+
+std::future<void> vdf_verifier_t::verify_async(std::shared_ptr<const ProofOfTime> proof)
+{
+	auto job = std::make_shared<job_t>();
+	job->proof = proof;
+	auto future = job->result.get_future();
+
+	const auto& segments = proof->segments;
+	if(segments.empty()) {
+		job->result.set_exception(std::make_exception_ptr(std::logic_error("no segments")));
+		return future;
+	}
+	job->input = hash_t(proof->input + proof->prev);
+	job->input = hash_t(job->input + proof->reward_addr);
+	job->num_pending = segments.size();
+	{
+		std::lock_guard lock(mutex);
+		if(!do_run) {
+			throw std::logic_error("vdf_verifier_t: closed");
+		}
+		for(size_t i = 0; i < segments.size(); ++i) {
+			item_t item;
+			item.job = job;
+			item.index = i;
+			queue.push_back(std::move(item));
+		}
+	}
+	signal.notify_all();
+	return future;
+}
+
+void vdf_verifier_t::verify(std::shared_ptr<const ProofOfTime> proof)
+{
+	verify_async(proof).get();
+}
+
+void vdf_verifier_t::close()
+{
+	{
+		std::lock_guard lock(mutex);
+		do_run = false;
+	}
+	signal.notify_all();
+
+	for(auto& thread : threads) {
+		if(thread.joinable()) {
+			thread.join();
+		}
+	}
+	threads.clear();
+
+	std::lock_guard lock(mutex);
+	while(!queue.empty()) {
+		auto job = queue.front().job;
+		queue.pop_front();
+		if(job->num_pending) {
+			job->num_pending = 0;
+			job->result.set_exception(std::make_exception_ptr(std::logic_error("vdf_verifier_t: closed")));
+		}
+	}
+}
+
+vdf_verifier_t::stats_t vdf_verifier_t::get_stats() const
+{
+	std::lock_guard lock(mutex);
+	return stats;
+}
+
+void vdf_verifier_t::finish(std::shared_ptr<job_t> job, const size_t count)
+{
+	job->num_pending -= count;
+	if(job->num_pending) {
+		return;
+	}
+	stats.num_proofs++;
+
+	if(job->invalid_segment < job->proof->segments.size()) {
+		job->result.set_exception(std::make_exception_ptr(
+				std::logic_error("invalid output on segment " + std::to_string(job->invalid_segment))));
+	} else {
+		job->result.set_value();
+	}
+}
+
+void vdf_verifier_t::worker()
+{
+	static const bool have_sha_ni = sha256_ni_available();
+	static const bool have_sha_arm = sha256_arm_available();
+	static const bool have_avx512 = avx512_available();
+	static const bool have_avx2 = avx2_available();
+
+	std::vector<item_t> batch;
+	batch.reserve(batch_size);
+
+	while(true) {
+		uint32_t num_iters = 0;
+		batch.clear();
+		{
+			std::unique_lock lock(mutex);
+			while(do_run && queue.empty()) {
+				signal.wait(lock);
+			}
+			if(!do_run) {
+				break;
+			}
+			// fill lanes across proof boundaries, as long as the segment size matches
+			while(!queue.empty() && batch.size() < batch_size)
+			{
+				auto& item = queue.front();
+				if(item.job->invalid_segment != size_t(-1)) {
+					finish(item.job, 1);		// proof already failed
+					queue.pop_front();
+					continue;
+				}
+				const auto segment_size = item.job->proof->segment_size;
+				if(batch.empty()) {
+					num_iters = segment_size;
+				} else if(segment_size != num_iters) {
+					break;
+				}
+				batch.push_back(std::move(item));
+				queue.pop_front();
+			}
+		}
+		if(batch.empty()) {
+			continue;
+		}
+		const auto time_begin = get_time_us();
+		const uint32_t num_lanes = batch.size();
+
+		hash_t point[batch_size];
+		uint8_t hash[batch_size][32] = {};
+		uint8_t input[batch_size][64] = {};
+
+		for(uint32_t j = 0; j < num_lanes; ++j)
+		{
+			const auto& item = batch[j];
+			if(item.index > 0) {
+				point[j] = item.job->proof->segments[item.index - 1];
+			} else {
+				point[j] = item.job->input;
+			}
+		}
+		if(have_sha_ni || have_sha_arm) {
+			// odd lane count is padded with an unused lane
+			for(uint32_t j = 0; j < num_lanes; j += 2)
+			{
+				uint8_t hashx2[32 * 2];
+				::memcpy(hashx2, point[j].data(), 32);
+				::memcpy(hashx2 + 32, point[j + 1].data(), 32);
+				if(have_sha_ni) {
+					recursive_sha256_ni_x2(hashx2, num_iters);
+				} else {
+					recursive_sha256_arm_x2(hashx2, num_iters);
+				}
+				::memcpy(point[j].data(), hashx2, 32);
+				::memcpy(point[j + 1].data(), hashx2 + 32, 32);
+			}
+		} else if(have_avx512 || have_avx2) {
+			// state stays in registers across all iterations
+			for(uint32_t j = 0; j < batch_size; ++j) {
+				::memcpy(hash[j], point[j].data(), 32);
+			}
+			if(have_avx512 && num_lanes > 8) {
+				recursive_sha256_avx512_x16(hash[0], num_iters);
+			} else {
+				recursive_sha256_avx2_x8(hash[0], num_iters);
+				if(num_lanes > 8) {
+					recursive_sha256_avx2_x8(hash[8], num_iters);
+				}
+			}
+			for(uint32_t j = 0; j < num_lanes; ++j) {
+				::memcpy(point[j].data(), hash[j], 32);
+			}
+		} else {
+			const bool full = num_lanes > 8;
+			for(uint32_t k = 0; k < num_iters; ++k)
+			{
+				for(uint32_t j = 0; j < num_lanes; ++j) {
+					::memcpy(input[j], point[j].data(), 32);
+				}
+				sha256_64_x8(hash[0], input[0], 32);
+				if(full) {
+					sha256_64_x8(hash[8], input[8], 32);
+				}
+				for(uint32_t j = 0; j < num_lanes; ++j) {
+					::memcpy(point[j].data(), hash[j], 32);
+				}
+			}
+		}
+		const auto elapsed = get_time_us() - time_begin;
+
+		std::lock_guard lock(mutex);
+		for(uint32_t j = 0; j < num_lanes; ++j)
+		{
+			const auto& item = batch[j];
+			const auto& job = item.job;
+			if(point[j] != job->proof->segments[item.index]) {
+				job->invalid_segment = std::min<size_t>(job->invalid_segment, item.index);
+			}
+			finish(job, 1);
+		}
+		stats.num_segments += num_lanes;
+		stats.num_iters += uint64_t(num_lanes) * num_iters;
+		stats.num_batches++;
+		stats.num_lanes += num_lanes;
+		stats.busy_time_us += elapsed;
+	}
+}
+
+
+} // mmx
@@ -8,6 +8,7 @@
 #include <mmx/vm/Compiler.h>
 #include <mmx/vm/Engine.h>
 #include <mmx/vm/instr_t.h>
+#include <mmx/vm/optimizer.h>
 #include <mmx/vm/varptr_t.hpp>
 #include <mmx/vm_interface.h>
 #include <mmx/helpers.h>
@@ -495,7 +496,7 @@ private:
 
 };
 
-const std::string Compiler::version = "1.1.0";
+const std::string Compiler::version = "1.2.0";
 
 Compiler::Compiler(const compile_flags_t& flags)
 	:	flags(flags)
@@ -731,6 +732,37 @@ std::shared_ptr<const contract::Binary> Compiler::compile(const std::string& sou
 		}
 	}
 
+	if(flags.opt_level > 0)
+	{
+		program_t program;
+		program.code = std::move(code);
+		program.line_info = std::move(line_info);
+		for(const auto& var : const_vars) {
+			program.constants.push_back(var.value);
+		}
+		// static init at 0
+		program.entry_points.push_back(0);
+		for(const auto& entry : function_map) {
+			if(entry.second.root) {
+				program.entry_points.push_back(entry.second.address);
+			}
+		}
+		debug() << std::endl << "Optimizing (level " << flags.opt_level << ") ..." << std::endl;
+
+		optimize(program, flags.opt_level);
+
+		code = std::move(program.code);
+		line_info = std::move(program.line_info);
+		{
+			size_t i = 1;
+			for(auto& entry : function_map) {
+				if(entry.second.root) {
+					entry.second.address = program.entry_points[i++];
+				}
+			}
+		}
+	}
+
 	for(const auto& var : const_vars) {
 		if(!var.value) {
 			throw std::logic_error("missing constant value");
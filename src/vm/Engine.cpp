@@ -61,7 +61,7 @@ var_t* Engine::assign(const uint64_t dst, std::unique_ptr<var_t> value)
 		default:
 			break;
 	}
-	auto& var = memory[dst];
+	auto& var = get_slot(dst);
 	if(!var && dst >= MEM_STATIC && dst < new_heap_base) {
 		var = storage->read(contract, dst);
 	}
@@ -154,7 +154,7 @@ var_t* Engine::write(const uint64_t dst, const var_t& src)
 	if(have_init && dst < MEM_EXTERN) {
 		throw std::logic_error("already initialized");
 	}
-	auto& var = memory[dst];
+	auto& var = get_slot(dst);
 	if(!var && dst >= MEM_STATIC && dst < new_heap_base) {
 		var = storage->read(contract, dst);
 	}
@@ -404,9 +404,15 @@ void Engine::erase_entries(const uint64_t dst)
 
 void Engine::erase(const uint64_t dst)
 {
-	const auto iter = memory.find(dst);
-	if(iter != memory.end()) {
-		erase(iter->second);
+	const auto slot = find_slot(dst);
+	if(slot && *slot) {
+		erase(*slot);
+	}
+	else if(read_const(dst)) {
+		throw std::logic_error("erase() on read-only memory");
+	}
+	else if(slot) {
+		return;
 	}
 	else if(dst >= MEM_STATIC) {
 		if(auto var = storage->read(contract, dst)) {
@@ -475,6 +481,14 @@ void Engine::clear(var_t* var)
 
 var_t* Engine::read(const uint64_t src, const bool mem_only)
 {
+	if(src < MEM_STATIC) {
+		if(auto slot = find_slot(src)) {
+			if(auto var = slot->get()) {
+				return (var->flags & FLAG_DELETED) ? nullptr : var;
+			}
+		}
+		return read_const(src);
+	}
 	auto iter = memory.find(src);
 	if(iter != memory.end()) {
 		auto var = iter->second.get();
@@ -485,6 +499,9 @@ var_t* Engine::read(const uint64_t src, const bool mem_only)
 		}
 		return var;
 	}
+	if(auto var = read_const(src)) {
+		return var;
+	}
 	if(mem_only) {
 		return nullptr;
 	}
@@ -585,18 +602,124 @@ uint64_t Engine::alloc()
 	return offset->value++;
 }
 
+var_t* Engine::read_const(const uint64_t src) const
+{
+	if(const_image && src >= MEM_CONST && src < MEM_EXTERN) {
+		const auto index = src - MEM_CONST;
+		if(index < const_image->vars.size()) {
+			// never modified, FLAG_CONST prevents writes
+			return const_image->vars[index].get();
+		}
+	}
+	return nullptr;
+}
+
+std::unique_ptr<var_t>* Engine::find_flat(const uint64_t addr, const bool create)
+{
+	if(addr >= MEM_STATIC) {
+		return nullptr;
+	}
+	const int seg = addr < MEM_EXTERN ? 0 : (addr < MEM_STACK ? 1 : 2);
+	const uint64_t offset = addr - (seg == 0 ? MEM_CONST : (seg == 1 ? MEM_EXTERN : MEM_STACK));
+	if(offset >= FLAT_SIZE) {
+		return nullptr;
+	}
+	auto& slots = flat_memory[seg];
+	if(offset >= slots.size()) {
+		if(!create) {
+			return nullptr;
+		}
+		slots.resize(offset + 1);
+	}
+	return &slots[offset];
+}
+
+std::unique_ptr<var_t>* Engine::find_slot(const uint64_t addr)
+{
+	if(auto slot = find_flat(addr, false)) {
+		return slot;
+	}
+	const auto iter = memory.find(addr);
+	if(iter != memory.end()) {
+		return &iter->second;
+	}
+	return nullptr;
+}
+
+std::unique_ptr<var_t>& Engine::get_slot(const uint64_t addr)
+{
+	if(auto slot = find_flat(addr, true)) {
+		return *slot;
+	}
+	return memory[addr];
+}
+
+template<typename F>
+void Engine::for_each_slot(const uint64_t begin, const uint64_t end, const F& func)
+{
+	// in order of address
+	const uint64_t bases[] = {MEM_CONST, MEM_EXTERN, MEM_STACK};
+	for(int seg = 0; seg < 3; ++seg) {
+		const auto base = bases[seg];
+		auto& slots = flat_memory[seg];
+		for(uint64_t i = (begin > base ? begin - base : 0); i < slots.size() && base + i < end; ++i) {
+			func(base + i, slots[i]);
+		}
+		const auto seg_end = seg < 2 ? bases[seg + 1] : MEM_STATIC;
+		const auto lower = std::max(begin, base + FLAT_SIZE);
+		const auto upper = std::min(end, seg_end);
+		if(lower < upper) {
+			for(auto iter = memory.lower_bound(lower); iter != memory.lower_bound(upper); ++iter) {
+				func(iter->first, iter->second);
+			}
+		}
+	}
+	if(end > MEM_STATIC) {
+		for(auto iter = memory.lower_bound(std::max(begin, MEM_STATIC)); iter != memory.lower_bound(end); ++iter) {
+			func(iter->first, iter->second);
+		}
+	}
+}
+
+void Engine::map_constants(std::shared_ptr<const const_image_t> image)
+{
+	if(have_init) {
+		throw std::logic_error("map_constants(): already initialized");
+	}
+	bool have_const = false;
+	for_each_slot(MEM_CONST, MEM_EXTERN, [&have_const](const uint64_t, std::unique_ptr<var_t>& var) {
+		have_const = have_const || var;
+	});
+	if(const_image || have_const) {
+		throw std::logic_error("map_constants(): constants already loaded");
+	}
+	if(image->vars.size() >= MEM_EXTERN - MEM_CONST) {
+		throw std::runtime_error("constant memory overflow");
+	}
+	const_image = image;
+	gas_used += image->write_cost;
+}
+
 void Engine::init()
 {
 	if(have_init) {
 		throw std::logic_error("init(): already initialized");
 	}
 	// Note: address 0 is not a valid key (used to denote "key not found")
-	for(auto iter = memory.lower_bound(1); iter != memory.lower_bound(MEM_EXTERN); ++iter) {
-		const auto* key = iter->second.get();
-		if(num_bytes(key) <= MAX_KEY_BYTES) {
-			key_map.emplace(key, iter->first);
+	if(const_image) {
+		const auto& vars = const_image->vars;
+		for(size_t i = 1; i < vars.size(); ++i) {
+			const auto* key = vars[i].get();
+			if(num_bytes(key) <= MAX_KEY_BYTES) {
+				key_map.emplace(key, MEM_CONST + i);
+			}
 		}
 	}
+	for_each_slot(1, MEM_EXTERN, [this](const uint64_t addr, std::unique_ptr<var_t>& var) {
+		if(var && num_bytes(var.get()) <= MAX_KEY_BYTES) {
+			key_map.emplace(var.get(), addr);
+		}
+	});
 	have_init = true;
 }
 
@@ -608,12 +731,12 @@ void Engine::begin(const uint64_t instr_ptr)
 	if(!call_stack.empty()) {
 		throw std::logic_error("begin(): call stack not empty");
 	}
-	for(auto iter = memory.begin(); iter != memory.lower_bound(MEM_STACK); ++iter) {
-		if(auto var = iter->second.get()) {
+	for_each_slot(0, MEM_STACK, [](const uint64_t, std::unique_ptr<var_t>& var) {
+		if(var) {
 			var->flags |= FLAG_CONST;
 			var->flags &= ~FLAG_DIRTY;
 		}
-	}
+	});
 	frame_t frame;
 	frame.instr_ptr = instr_ptr;
 	call_stack.push_back(frame);
@@ -621,11 +744,185 @@ void Engine::begin(const uint64_t instr_ptr)
 
 void Engine::run()
 {
+	if(do_lower) {
+		run_lowered();
+		return;
+	}
 	while(!call_stack.empty()) {
 		step();
 	}
 }
 
+// Same semantics, gas and error_addr as step(), but with dispatch on pre-decoded handlers.
+void Engine::run_lowered()
+{
+	// program is set together with code by vm::load(), avoid hashing the code on every run
+	if(!program || program->ops.size() != code.size()) {
+		program = lower_program(code);
+	}
+	const op_t* const ops = program->ops.data();
+	const uint64_t num_ops = program->ops.size();
+
+	const op_t* op = nullptr;
+	uint64_t instr_ptr = 0;
+
+#if defined(__GNUC__)
+	static const void* const table[H_COUNT] = {
+		&&L_GENERIC, &&L_NOP, &&L_COPY, &&L_JUMP, &&L_JUMPI, &&L_JUMPN,
+		&&L_ADD, &&L_SUB, &&L_CMP, &&L_CMP_JUMP, &&L_ADD_JUMP
+	};
+#define VM_DISPATCH() goto *table[op->handler]
+#else
+#define VM_DISPATCH() goto dispatch
+#endif
+
+#define VM_NEXT() \
+	check_gas(); \
+	if(call_stack.empty()) { \
+		return; \
+	} \
+	instr_ptr = call_stack.back().instr_ptr; \
+	if(instr_ptr >= num_ops) { \
+		goto out_of_bounds; \
+	} \
+	op = ops + instr_ptr; \
+	VM_DISPATCH();
+
+	if(call_stack.empty()) {
+		return;
+	}
+	instr_ptr = call_stack.back().instr_ptr;
+	if(instr_ptr >= num_ops) {
+		goto out_of_bounds;
+	}
+	op = ops + instr_ptr;
+
+	try {
+		VM_DISPATCH();
+#if !defined(__GNUC__)
+	dispatch:
+		switch(op->handler) {
+			case H_GENERIC: goto L_GENERIC;
+			case H_NOP: goto L_NOP;
+			case H_COPY: goto L_COPY;
+			case H_JUMP: goto L_JUMP;
+			case H_JUMPI: goto L_JUMPI;
+			case H_JUMPN: goto L_JUMPN;
+			case H_ADD: goto L_ADD;
+			case H_SUB: goto L_SUB;
+			case H_CMP: goto L_CMP;
+			case H_CMP_JUMP: goto L_CMP_JUMP;
+			case H_ADD_JUMP: goto L_ADD_JUMP;
+			default: goto L_GENERIC;
+		}
+#endif
+	L_GENERIC:
+		exec(code[instr_ptr]);
+		VM_NEXT();
+	L_NOP:
+		gas_used += INSTR_COST;
+		call_stack.back().instr_ptr++;
+		VM_NEXT();
+	L_COPY:
+		gas_used += INSTR_COST;
+		copy(deref_addr(op->a, false), deref_addr(op->b, false));
+		call_stack.back().instr_ptr++;
+		VM_NEXT();
+	L_JUMP:
+		gas_used += INSTR_COST;
+		call_stack.back().instr_ptr = op->a;
+		VM_NEXT();
+	L_JUMPI:
+		gas_used += INSTR_COST;
+		if(is_true(deref_addr(op->b, false))) {
+			call_stack.back().instr_ptr = op->a;
+		} else {
+			call_stack.back().instr_ptr++;
+		}
+		VM_NEXT();
+	L_JUMPN:
+		gas_used += INSTR_COST;
+		if(!is_true(deref_addr(op->b, false))) {
+			call_stack.back().instr_ptr = op->a;
+		} else {
+			call_stack.back().instr_ptr++;
+		}
+		VM_NEXT();
+	L_ADD: {
+		gas_used += INSTR_COST;
+		const auto dst = deref_addr(op->a, false);
+		const auto lhs = deref_addr(op->b, false);
+		const auto rhs = deref_addr(op->c, false);
+		add(dst, lhs, rhs, op->flags);
+		call_stack.back().instr_ptr++;
+		VM_NEXT();
+	}
+	L_SUB: {
+		gas_used += INSTR_COST;
+		const auto dst = deref_addr(op->a, false);
+		const auto lhs = deref_addr(op->b, false);
+		const auto rhs = deref_addr(op->c, false);
+		sub(dst, lhs, rhs, op->flags);
+		call_stack.back().instr_ptr++;
+		VM_NEXT();
+	}
+	L_CMP: {
+		gas_used += INSTR_COST;
+		const auto dst = deref_addr(op->a, false);
+		const auto lhs = deref_addr(op->b, false);
+		const auto rhs = deref_addr(op->c, false);
+		cmp(op->code, dst, lhs, rhs);
+		call_stack.back().instr_ptr++;
+		VM_NEXT();
+	}
+	L_CMP_JUMP: {
+		gas_used += INSTR_COST;
+		const auto dst = deref_addr(op->a, false);
+		const auto lhs = deref_addr(op->b, false);
+		const auto rhs = deref_addr(op->c, false);
+		const bool res = cmp(op->code, dst, lhs, rhs);
+		call_stack.back().instr_ptr++;
+		check_gas();
+
+		// JUMPI / JUMPN on dst, which now holds res
+		instr_ptr++;
+		gas_used += INSTR_COST;
+		if(res == (op->code2 == OP_JUMPI)) {
+			call_stack.back().instr_ptr = op->a2;
+		} else {
+			call_stack.back().instr_ptr++;
+		}
+		VM_NEXT();
+	}
+	L_ADD_JUMP: {
+		gas_used += INSTR_COST;
+		const auto dst = deref_addr(op->a, false);
+		const auto lhs = deref_addr(op->b, false);
+		const auto rhs = deref_addr(op->c, false);
+		add(dst, lhs, rhs, op->flags);
+		call_stack.back().instr_ptr++;
+		check_gas();
+
+		instr_ptr++;
+		gas_used += INSTR_COST;
+		call_stack.back().instr_ptr = op->a2;
+		VM_NEXT();
+	}
+	} catch(...) {
+		if(is_debug) {
+			dump_memory();
+		}
+		error_addr = instr_ptr;
+		throw;
+	}
+
+out_of_bounds:
+	throw std::logic_error("instr_ptr out of bounds: " + to_hex(instr_ptr) + " > " + to_hex(code.size()));
+
+#undef VM_NEXT
+#undef VM_DISPATCH
+}
+
 void Engine::step()
 {
 	const auto instr_ptr = get_frame().instr_ptr;
@@ -1282,6 +1579,55 @@ uint64_t Engine::deref_value(uint32_t src, const bool flag)
 	return src;
 }
 
+void Engine::add(const uint64_t dst, const uint64_t lhs, const uint64_t rhs, const uint8_t flags)
+{
+	const auto& L = read_fail<uint_t>(lhs, TYPE_UINT).value;
+	const auto& R = read_fail<uint_t>(rhs, TYPE_UINT).value;
+	const uint256_t D = L + R;
+	if((flags & OPFLAG_CATCH_OVERFLOW) && D < L) {
+		throw std::runtime_error("integer overflow");
+	}
+	write(dst, uint_t(D));
+}
+
+void Engine::sub(const uint64_t dst, const uint64_t lhs, const uint64_t rhs, const uint8_t flags)
+{
+	const auto& L = read_fail<uint_t>(lhs, TYPE_UINT).value;
+	const auto& R = read_fail<uint_t>(rhs, TYPE_UINT).value;
+	const uint256_t D = L - R;
+	if((flags & OPFLAG_CATCH_OVERFLOW) && D > L) {
+		throw std::runtime_error("integer overflow");
+	}
+	write(dst, uint_t(D));
+}
+
+bool Engine::cmp(const opcode_e code, const uint64_t dst, const uint64_t lhs, const uint64_t rhs)
+{
+	const auto& L = read_fail(lhs);
+	const auto& R = read_fail(rhs);
+	switch(code) {
+		case OP_CMP_EQ:
+		case OP_CMP_NEQ: break;
+		default:
+			if(L.type != R.type) {
+				throw std::logic_error("compare type mismatch: " + std::to_string(int(L.type)) + " != " + std::to_string(int(R.type)));
+			}
+	}
+	const auto cmp = compare(L, R);
+	bool res = false;
+	switch(code) {
+		case OP_CMP_EQ: res = (cmp == 0); break;
+		case OP_CMP_NEQ: res = (cmp != 0); break;
+		case OP_CMP_LT: res = (cmp < 0); break;
+		case OP_CMP_GT: res = (cmp > 0); break;
+		case OP_CMP_LTE: res = (cmp <= 0); break;
+		case OP_CMP_GTE: res = (cmp >= 0); break;
+		default: break;
+	}
+	write(dst, var_t(res));
+	return res;
+}
+
 void Engine::exec(const instr_t& instr)
 {
 	gas_used += INSTR_COST;
@@ -1335,26 +1681,14 @@ void Engine::exec(const instr_t& instr)
 		const auto dst = deref_addr(instr.a, instr.flags & OPFLAG_REF_A);
 		const auto lhs = deref_addr(instr.b, instr.flags & OPFLAG_REF_B);
 		const auto rhs = deref_addr(instr.c, instr.flags & OPFLAG_REF_C);
-		const auto& L = read_fail<uint_t>(lhs, TYPE_UINT).value;
-		const auto& R = read_fail<uint_t>(rhs, TYPE_UINT).value;
-		const uint256_t D = L + R;
-		if((instr.flags & OPFLAG_CATCH_OVERFLOW) && D < L) {
-			throw std::runtime_error("integer overflow");
-		}
-		write(dst, uint_t(D));
+		add(dst, lhs, rhs, instr.flags);
 		break;
 	}
 	case OP_SUB: {
 		const auto dst = deref_addr(instr.a, instr.flags & OPFLAG_REF_A);
 		const auto lhs = deref_addr(instr.b, instr.flags & OPFLAG_REF_B);
 		const auto rhs = deref_addr(instr.c, instr.flags & OPFLAG_REF_C);
-		const auto& L = read_fail<uint_t>(lhs, TYPE_UINT).value;
-		const auto& R = read_fail<uint_t>(rhs, TYPE_UINT).value;
-		const uint256_t D = L - R;
-		if((instr.flags & OPFLAG_CATCH_OVERFLOW) && D > L) {
-			throw std::runtime_error("integer overflow");
-		}
-		write(dst, uint_t(D));
+		sub(dst, lhs, rhs, instr.flags);
 		break;
 	}
 	case OP_MUL: {
@@ -1586,28 +1920,7 @@ void Engine::exec(const instr_t& instr)
 		const auto dst = deref_addr(instr.a, instr.flags & OPFLAG_REF_A);
 		const auto lhs = deref_addr(instr.b, instr.flags & OPFLAG_REF_B);
 		const auto rhs = deref_addr(instr.c, instr.flags & OPFLAG_REF_C);
-		const auto& L = read_fail(lhs);
-		const auto& R = read_fail(rhs);
-		switch(instr.code) {
-			case OP_CMP_EQ:
-			case OP_CMP_NEQ: break;
-			default:
-				if(L.type != R.type) {
-					throw std::logic_error("compare type mismatch: " + std::to_string(int(L.type)) + " != " + std::to_string(int(R.type)));
-				}
-		}
-		const auto cmp = compare(L, R);
-		bool res = false;
-		switch(instr.code) {
-			case OP_CMP_EQ: res = (cmp == 0); break;
-			case OP_CMP_NEQ: res = (cmp != 0); break;
-			case OP_CMP_LT: res = (cmp < 0); break;
-			case OP_CMP_GT: res = (cmp > 0); break;
-			case OP_CMP_LTE: res = (cmp <= 0); break;
-			case OP_CMP_GTE: res = (cmp >= 0); break;
-			default: break;
-		}
-		write(dst, var_t(res));
+		cmp(instr.code, dst, lhs, rhs);
 		break;
 	}
 	case OP_TYPE: {
@@ -1729,7 +2042,18 @@ void Engine::exec(const instr_t& instr)
 
 void Engine::clear_stack(const uint64_t offset)
 {
-	for(auto iter = memory.lower_bound(MEM_STACK + offset); iter != memory.lower_bound(MEM_STATIC);) {
+	auto& stack = flat_memory[2];
+	for(auto i = offset; i < stack.size(); ++i) {
+		if(auto& var = stack[i]) {
+			clear(var.get());
+			var = nullptr;
+			check_gas();
+		}
+	}
+	if(offset < stack.size()) {
+		stack.resize(offset);
+	}
+	for(auto iter = memory.lower_bound(MEM_STACK + std::max(offset, FLAT_SIZE)); iter != memory.lower_bound(MEM_STATIC);) {
 		clear(iter->second.get());
 		iter = memory.erase(iter);
 		check_gas();
@@ -1778,13 +2102,19 @@ std::map<uint64_t, const var_t*> Engine::find_entries(const uint64_t dst) const
 void Engine::dump_memory(const uint64_t begin, const uint64_t end)
 {
 	std::cout << "-------------------------------------------" << std::endl;
-	for(auto iter = memory.lower_bound(begin); iter != memory.lower_bound(end); ++iter) {
-		std::cout << "[" << to_hex(iter->first) << "] " << to_string(iter->second.get());
-		if(auto var = iter->second.get()) {
+	if(const_image) {
+		const auto& vars = const_image->vars;
+		for(uint64_t i = std::max(begin, MEM_CONST) - MEM_CONST; i < vars.size() && MEM_CONST + i < end; ++i) {
+			std::cout << "[" << to_hex(MEM_CONST + i) << "] " << to_string(vars[i].get()) << "\t\t(mapped)" << std::endl;
+		}
+	}
+	for_each_slot(begin, end, [](const uint64_t addr, std::unique_ptr<var_t>& var) {
+		std::cout << "[" << to_hex(addr) << "] " << to_string(var.get());
+		if(var) {
 			std::cout << "\t\t(vf: " << to_bin(var->flags) << ") (rc: " << var->ref_count << ")";
 		}
 		std::cout << std::endl;
-	}
+	});
 	for(auto iter = entries.lower_bound(std::make_pair(begin, 0)); iter != entries.lower_bound(std::make_pair(end, 0)); ++iter) {
 		std::cout << "[" << to_hex(iter->first.first) << "]"
 				<< "[" << to_hex(iter->first.second) << "] " << to_string(iter->second.get());
@@ -56,13 +56,27 @@ void StorageCache::commit() const
 			backend->write(std::get<0>(entry.first), std::get<1>(entry.first), std::get<2>(entry.first), *var);
 		}
 	}
-	for(const auto& entry : balance_map) {
-		for(const auto& entry2 : entry.second) {
-			backend->set_balance(entry.first, entry2.first, entry2.second);
+	for(const auto& entry : get_balance_writes()) {
+		if(auto amount = Super::get_balance(entry.first, entry.second)) {
+			backend->set_balance(entry.first, entry.second, *amount);
 		}
 	}
 }
 
+void StorageCache::set_balance(const addr_t& contract, const addr_t& currency, const uint128& amount)
+{
+	Super::set_balance(contract, currency, amount);
+
+	std::lock_guard lock(mutex);
+	balance_writes.emplace(contract, currency);
+}
+
+std::set<std::pair<addr_t, addr_t>> StorageCache::get_balance_writes() const
+{
+	std::lock_guard lock(mutex);
+	return balance_writes;
+}
+
 std::unique_ptr<uint128> StorageCache::get_balance(const addr_t& contract, const addr_t& currency)
 {
 	if(auto value = Super::get_balance(contract, currency)) {
@@ -0,0 +1,108 @@
+/*
+ * StorageTracker.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <mmx/vm/StorageTracker.h>
+
+
+namespace mmx {
+namespace vm {
+
+template<typename T>
+bool intersects(const std::set<T>& lhs, const std::set<T>& rhs)
+{
+	if(lhs.size() > rhs.size()) {
+		return intersects(rhs, lhs);
+	}
+	for(const auto& entry : lhs) {
+		if(rhs.count(entry)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool access_set_t::intersects(const access_set_t& other) const
+{
+	return vm::intersects(memory, other.memory)
+		|| vm::intersects(entries, other.entries)
+		|| vm::intersects(balances, other.balances)
+		|| vm::intersects(keys, other.keys);
+}
+
+void access_set_t::insert(const access_set_t& other)
+{
+	memory.insert(other.memory.begin(), other.memory.end());
+	entries.insert(other.entries.begin(), other.entries.end());
+	balances.insert(other.balances.begin(), other.balances.end());
+	keys.insert(other.keys.begin(), other.keys.end());
+}
+
+void access_set_t::add_writes(const StorageCache& storage)
+{
+	for(const auto& entry : storage.get_memory()) {
+		if(const auto& var = entry.second) {
+			memory.insert(entry.first);
+			if(var->flags & FLAG_KEY) {
+				keys.insert(entry.first.first);
+			}
+		}
+	}
+	for(const auto& entry : storage.get_entries()) {
+		if(entry.second) {
+			entries.insert(entry.first);
+		}
+	}
+	const auto writes = storage.get_balance_writes();
+	balances.insert(writes.begin(), writes.end());
+}
+
+StorageTracker::StorageTracker(std::shared_ptr<Storage> backend)
+	:	backend(backend)
+{
+}
+
+std::unique_ptr<var_t> StorageTracker::read(const addr_t& contract, const uint64_t src) const
+{
+	read_set.memory.emplace(contract, src);
+	return backend->read(contract, src);
+}
+
+std::unique_ptr<var_t> StorageTracker::read(const addr_t& contract, const uint64_t src, const uint64_t key) const
+{
+	read_set.entries.emplace(contract, src, key);
+	return backend->read(contract, src, key);
+}
+
+void StorageTracker::write(const addr_t& contract, const uint64_t dst, const var_t& value)
+{
+	backend->write(contract, dst, value);
+}
+
+void StorageTracker::write(const addr_t& contract, const uint64_t dst, const uint64_t key, const var_t& value)
+{
+	backend->write(contract, dst, key, value);
+}
+
+uint64_t StorageTracker::lookup(const addr_t& contract, const var_t& value) const
+{
+	read_set.keys.insert(contract);
+	return backend->lookup(contract, value);
+}
+
+void StorageTracker::set_balance(const addr_t& contract, const addr_t& currency, const uint128& amount)
+{
+	backend->set_balance(contract, currency, amount);
+}
+
+std::unique_ptr<uint128> StorageTracker::get_balance(const addr_t& contract, const addr_t& currency)
+{
+	read_set.balances.emplace(contract, currency);
+	return backend->get_balance(contract, currency);
+}
+
+
+} // vm
+} // mmx
@@ -0,0 +1,110 @@
+/*
+ * op_t.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <mmx/vm/op_t.h>
+
+
+namespace mmx {
+namespace vm {
+
+static constexpr uint8_t OPFLAG_REF_ANY = OPFLAG_REF_A | OPFLAG_REF_B | OPFLAG_REF_C | OPFLAG_REF_D;
+
+static bool is_compare(const opcode_e code)
+{
+	switch(code) {
+		case OP_CMP_EQ:
+		case OP_CMP_NEQ:
+		case OP_CMP_LT:
+		case OP_CMP_GT:
+		case OP_CMP_LTE:
+		case OP_CMP_GTE:
+			return true;
+		default:
+			return false;
+	}
+}
+
+std::vector<op_t> lower(const std::vector<instr_t>& code)
+{
+	std::vector<op_t> out(code.size());
+
+	for(size_t i = 0; i < code.size(); ++i)
+	{
+		const auto& instr = code[i];
+		auto& op = out[i];
+		op.code = instr.code;
+		op.flags = instr.flags;
+		op.a = instr.a;
+		op.b = instr.b;
+		op.c = instr.c;
+
+		if(instr.flags & OPFLAG_REF_ANY) {
+			continue;
+		}
+		const instr_t* next = (i + 1 < code.size()) ? &code[i + 1] : nullptr;
+
+		switch(instr.code) {
+			case OP_NOP: op.handler = H_NOP; break;
+			case OP_COPY: op.handler = H_COPY; break;
+			case OP_JUMP: op.handler = H_JUMP; break;
+			case OP_JUMPI: op.handler = H_JUMPI; break;
+			case OP_JUMPN: op.handler = H_JUMPN; break;
+			case OP_SUB: op.handler = H_SUB; break;
+			case OP_ADD:
+				// loop increment: ADD + JUMP
+				if(next && next->code == OP_JUMP && !(next->flags & OPFLAG_REF_A)) {
+					op.handler = H_ADD_JUMP;
+					op.code2 = next->code;
+					op.a2 = next->a;
+				} else {
+					op.handler = H_ADD;
+				}
+				break;
+			default:
+				if(is_compare(instr.code)) {
+					// loop / if condition: CMP_* + JUMPI / JUMPN on the result
+					if(next && (next->code == OP_JUMPI || next->code == OP_JUMPN)
+						&& !(next->flags & (OPFLAG_REF_A | OPFLAG_REF_B)) && next->b == instr.a)
+					{
+						op.handler = H_CMP_JUMP;
+						op.code2 = next->code;
+						op.a2 = next->a;
+					} else {
+						op.handler = H_CMP;
+					}
+				}
+		}
+	}
+	return out;
+}
+
+std::shared_ptr<const program_ops_t> lower_program(const std::vector<instr_t>& code)
+{
+	auto out = std::make_shared<program_ops_t>();
+	out->ops = lower(code);
+	out->code_hash = hash_code(code);
+	return out;
+}
+
+uint64_t hash_code(const std::vector<instr_t>& code)
+{
+	uint64_t hash = 0xcbf29ce484222325ull;
+	const auto update = [&hash](const uint32_t value) {
+		hash = (hash ^ value) * 0x100000001b3ull;
+	};
+	for(const auto& instr : code) {
+		update(uint32_t(instr.code) | (uint32_t(instr.flags) << 16));
+		update(instr.a);
+		update(instr.b);
+		update(instr.c);
+		update(instr.d);
+	}
+	return hash;
+}
+
+
+} // vm
+} // mmx
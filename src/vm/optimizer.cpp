@@ -0,0 +1,938 @@
+/*
+ * optimizer.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <mmx/vm/optimizer.h>
+#include <mmx/vm/Engine.h>
+#include <mmx/vm_interface.h>
+
+#include <algorithm>
+
+
+namespace mmx {
+namespace vm {
+
+enum role_e : uint8_t {
+	ROLE_NONE,
+	ROLE_READ,		// deref_addr(), read only
+	ROLE_WRITE,		// deref_addr(), overwritten
+	ROLE_MODIFY,	// deref_addr(), modified in place
+	ROLE_VALUE,		// deref_value(), read if flag is set
+};
+
+struct roles_t {
+	bool known = true;
+	role_e arg[4] = {};
+};
+
+static constexpr uint8_t REF_FLAGS[4] = {OPFLAG_REF_A, OPFLAG_REF_B, OPFLAG_REF_C, OPFLAG_REF_D};
+
+static uint32_t get_arg(const instr_t& instr, const int i)
+{
+	switch(i) {
+		case 0: return instr.a;
+		case 1: return instr.b;
+		case 2: return instr.c;
+		default: return instr.d;
+	}
+}
+
+static void set_arg(instr_t& instr, const int i, const uint32_t value)
+{
+	switch(i) {
+		case 0: instr.a = value; break;
+		case 1: instr.b = value; break;
+		case 2: instr.c = value; break;
+		default: instr.d = value;
+	}
+}
+
+// same as Engine::exec()
+static roles_t get_roles(const opcode_e code)
+{
+	roles_t out;
+	auto& arg = out.arg;
+	switch(code) {
+		case OP_NOP:
+		case OP_RET:
+			break;
+		case OP_CLR:
+			arg[0] = ROLE_WRITE;
+			break;
+		case OP_COPY:
+		case OP_CLONE:
+		case OP_NOT:
+		case OP_TYPE:
+		case OP_SIZE:
+		case OP_SHA256:
+		case OP_BALANCE:
+			arg[0] = ROLE_WRITE; arg[1] = ROLE_READ;
+			break;
+		case OP_JUMP:
+			arg[0] = ROLE_VALUE;
+			break;
+		case OP_JUMPI:
+		case OP_JUMPN:
+			arg[0] = ROLE_VALUE; arg[1] = ROLE_READ;
+			break;
+		case OP_CALL:
+			arg[0] = ROLE_VALUE; arg[1] = ROLE_VALUE;
+			break;
+		case OP_ADD:
+		case OP_SUB:
+		case OP_MUL:
+		case OP_DIV:
+		case OP_MOD:
+		case OP_XOR:
+		case OP_AND:
+		case OP_OR:
+		case OP_MIN:
+		case OP_MAX:
+		case OP_CMP_EQ:
+		case OP_CMP_NEQ:
+		case OP_CMP_LT:
+		case OP_CMP_GT:
+		case OP_CMP_LTE:
+		case OP_CMP_GTE:
+		case OP_GET:
+		case OP_CONCAT:
+		case OP_CREAD:
+			arg[0] = ROLE_WRITE; arg[1] = ROLE_READ; arg[2] = ROLE_READ;
+			break;
+		case OP_SHL:
+		case OP_SHR:
+			arg[0] = ROLE_WRITE; arg[1] = ROLE_READ; arg[2] = ROLE_VALUE;
+			break;
+		case OP_SET:
+			arg[0] = ROLE_MODIFY; arg[1] = ROLE_READ; arg[2] = ROLE_READ;
+			break;
+		case OP_ERASE:
+		case OP_PUSH_BACK:
+			arg[0] = ROLE_MODIFY; arg[1] = ROLE_READ;
+			break;
+		case OP_POP_BACK:
+			arg[0] = ROLE_WRITE; arg[1] = ROLE_MODIFY;
+			break;
+		case OP_CONV:
+		case OP_MEMCPY:
+			arg[0] = ROLE_WRITE; arg[1] = ROLE_READ; arg[2] = ROLE_VALUE; arg[3] = ROLE_VALUE;
+			break;
+		case OP_VERIFY:
+			arg[0] = ROLE_WRITE; arg[1] = ROLE_READ; arg[2] = ROLE_READ; arg[3] = ROLE_READ;
+			break;
+		case OP_LOG:
+			arg[0] = ROLE_VALUE; arg[1] = ROLE_READ;
+			break;
+		case OP_SEND:
+			arg[0] = ROLE_READ; arg[1] = ROLE_READ; arg[2] = ROLE_READ; arg[3] = ROLE_READ;
+			break;
+		case OP_MINT:
+			arg[0] = ROLE_READ; arg[1] = ROLE_READ; arg[2] = ROLE_READ;
+			break;
+		case OP_EVENT:
+			arg[0] = ROLE_READ; arg[1] = ROLE_READ;
+			break;
+		case OP_FAIL:
+			arg[0] = ROLE_READ; arg[1] = ROLE_VALUE;
+			break;
+		case OP_RCALL:
+			arg[0] = ROLE_READ; arg[1] = ROLE_READ; arg[2] = ROLE_VALUE; arg[3] = ROLE_VALUE;
+			break;
+		default:
+			out.known = false;
+	}
+	return out;
+}
+
+static bool is_stack(const uint32_t addr) {
+	return addr >= MEM_STACK && addr < MEM_STATIC;
+}
+
+static bool is_const(const uint32_t addr) {
+	return addr < MEM_EXTERN;
+}
+
+static bool is_jump(const instr_t& instr) {
+	return instr.code == OP_JUMP || instr.code == OP_JUMPI || instr.code == OP_JUMPN;
+}
+
+// jump or call with a fixed target
+static bool has_target(const instr_t& instr) {
+	return (is_jump(instr) || instr.code == OP_CALL) && !(instr.flags & OPFLAG_REF_A);
+}
+
+// ops that compute a new value from their operands without side effects, except failure
+static bool is_compute(const instr_t& instr)
+{
+	if(instr.flags & (OPFLAG_REF_A | OPFLAG_REF_B | OPFLAG_REF_C | OPFLAG_REF_D)) {
+		return false;
+	}
+	switch(instr.code) {
+		case OP_ADD:
+		case OP_SUB:
+		case OP_MUL:
+		case OP_DIV:
+		case OP_MOD:
+		case OP_NOT:
+		case OP_XOR:
+		case OP_AND:
+		case OP_OR:
+		case OP_MIN:
+		case OP_MAX:
+		case OP_CMP_EQ:
+		case OP_CMP_NEQ:
+		case OP_CMP_LT:
+		case OP_CMP_GT:
+		case OP_CMP_LTE:
+		case OP_CMP_GTE:
+		case OP_TYPE:
+		case OP_SIZE:
+			return true;
+		default:
+			return false;
+	}
+}
+
+// same as Engine::is_true()
+static bool is_true(const var_t& var)
+{
+	switch(var.type) {
+		case TYPE_NIL:
+		case TYPE_FALSE:
+			return false;
+		case TYPE_UINT:
+			return ((const uint_t&)var).value != 0;
+		case TYPE_STRING:
+		case TYPE_BINARY:
+			return ((const binary_t&)var).size;
+		default:
+			return true;
+	}
+}
+
+// same as Engine::exec(), returns null if the result is not known or it would fail
+static varptr_t fold(const instr_t& instr, const var_t* L, const var_t* R)
+{
+	if(!L || !R) {
+		return nullptr;
+	}
+	switch(instr.code) {
+		case OP_ADD:
+		case OP_SUB:
+		case OP_MUL: {
+			if(L->type != TYPE_UINT || R->type != TYPE_UINT) {
+				return nullptr;
+			}
+			const auto& lhs = ((const uint_t*)L)->value;
+			const auto& rhs = ((const uint_t*)R)->value;
+			const bool catch_overflow = instr.flags & OPFLAG_CATCH_OVERFLOW;
+			uint256_t res = 0;
+			switch(instr.code) {
+				case OP_ADD:
+					res = lhs + rhs;
+					if(catch_overflow && res < lhs) {
+						return nullptr;
+					}
+					break;
+				case OP_SUB:
+					res = lhs - rhs;
+					if(catch_overflow && res > lhs) {
+						return nullptr;
+					}
+					break;
+				default:
+					res = lhs * rhs;
+					if(catch_overflow && (res < lhs && res < rhs)) {
+						return nullptr;
+					}
+			}
+			return std::make_unique<uint_t>(res);
+		}
+		case OP_CMP_EQ:
+		case OP_CMP_NEQ:
+		case OP_CMP_LT:
+		case OP_CMP_GT:
+		case OP_CMP_LTE:
+		case OP_CMP_GTE: {
+			switch(instr.code) {
+				case OP_CMP_EQ:
+				case OP_CMP_NEQ: break;
+				default:
+					if(L->type != R->type) {
+						return nullptr;
+					}
+			}
+			const auto cmp = compare(*L, *R);
+			bool res = false;
+			switch(instr.code) {
+				case OP_CMP_EQ: res = (cmp == 0); break;
+				case OP_CMP_NEQ: res = (cmp != 0); break;
+				case OP_CMP_LT: res = (cmp < 0); break;
+				case OP_CMP_GT: res = (cmp > 0); break;
+				case OP_CMP_LTE: res = (cmp <= 0); break;
+				case OP_CMP_GTE: res = (cmp >= 0); break;
+				default: break;
+			}
+			return std::make_unique<var_t>(res);
+		}
+		default:
+			return nullptr;
+	}
+}
+
+class Optimizer {
+public:
+	Optimizer(program_t& program) : program(program), code(program.code)
+	{
+		for(size_t i = 0; i < program.constants.size(); ++i) {
+			if(const auto& value = program.constants[i]) {
+				const_table.emplace(value, MEM_CONST + i);
+			}
+		}
+		for(const auto& instr : code) {
+			const auto roles = get_roles(instr.code);
+			for(int i = 0; i < 4; ++i) {
+				const auto addr = get_arg(instr, i);
+				const bool is_addr = roles.arg[i] != ROLE_NONE && (roles.arg[i] != ROLE_VALUE || (instr.flags & REF_FLAGS[i]));
+				if(is_addr && is_stack(addr)) {
+					num_slots = std::max<size_t>(num_slots, addr - MEM_STACK + 1);
+				}
+			}
+			switch(instr.code) {
+				case OP_CALL: num_slots = std::max<size_t>(num_slots, size_t(instr.b) + 1); break;
+				case OP_RCALL: num_slots = std::max<size_t>(num_slots, size_t(instr.c) + 1); break;
+				default: break;
+			}
+		}
+		num_slots = std::max<size_t>(num_slots, 1);
+	}
+
+	bool check() const;
+
+	bool thread_jumps();
+	bool remove_unreachable();
+	bool propagate();
+	bool forward_stores();
+	bool remove_dead_stores();
+
+private:
+	typedef std::vector<bool> slot_set_t;		// by stack offset
+
+	const var_t* get_const(const uint32_t addr) const;
+
+	void compact();
+
+	std::vector<uint32_t> get_successors(const size_t i, const bool with_calls) const;
+
+	std::vector<bool> get_leaders() const;
+
+	void get_use_def(const instr_t& instr, slot_set_t& use, slot_set_t& def) const;
+
+	std::vector<slot_set_t> get_live_out() const;
+
+	std::vector<slot_set_t> get_init_in() const;
+
+	program_t& program;
+	std::vector<instr_t>& code;
+	std::vector<bool> removed;
+	std::map<varptr_t, uint32_t> const_table;
+	size_t num_slots = 0;
+
+};
+
+bool Optimizer::check() const
+{
+	for(const auto& instr : code) {
+		if((is_jump(instr) || instr.code == OP_CALL) && (instr.flags & OPFLAG_REF_A)) {
+			return false;		// computed jump
+		}
+		if(!get_roles(instr.code).known) {
+			return false;
+		}
+	}
+	return true;
+}
+
+const var_t* Optimizer::get_const(const uint32_t addr) const
+{
+	if(is_const(addr) && addr - MEM_CONST < program.constants.size()) {
+		return program.constants[addr - MEM_CONST].get();
+	}
+	return nullptr;
+}
+
+// removed instructions map to the next one that is kept
+void Optimizer::compact()
+{
+	if(removed.empty()) {
+		return;
+	}
+	std::vector<uint32_t> new_index(code.size() + 1);
+	uint32_t count = 0;
+	for(size_t i = 0; i < code.size(); ++i) {
+		new_index[i] = count;
+		if(!removed[i]) {
+			count++;
+		}
+	}
+	new_index[code.size()] = count;
+
+	const auto remap = [&new_index, this](const uint32_t addr) -> uint32_t {
+		return new_index[std::min<size_t>(addr, code.size())];
+	};
+	std::vector<instr_t> out;
+	out.reserve(count);
+	for(size_t i = 0; i < code.size(); ++i) {
+		if(!removed[i]) {
+			auto instr = code[i];
+			if(has_target(instr)) {
+				instr.a = remap(instr.a);
+			}
+			out.push_back(instr);
+		}
+	}
+	for(auto& addr : program.entry_points) {
+		addr = remap(addr);
+	}
+	std::map<uint32_t, uint32_t> line_info;
+	for(const auto& entry : program.line_info) {
+		if(entry.first < code.size() && !removed[entry.first]) {
+			line_info[new_index[entry.first]] = entry.second;
+		}
+	}
+	program.line_info = std::move(line_info);
+	code = std::move(out);
+	removed.clear();
+}
+
+std::vector<uint32_t> Optimizer::get_successors(const size_t i, const bool with_calls) const
+{
+	std::vector<uint32_t> out;
+	const auto& instr = code[i];
+	switch(instr.code) {
+		case OP_RET:
+		case OP_FAIL:
+			break;
+		case OP_JUMP:
+			out.push_back(instr.a);
+			break;
+		case OP_JUMPI:
+		case OP_JUMPN:
+			out.push_back(instr.a);
+			out.push_back(i + 1);
+			break;
+		case OP_CALL:
+			if(with_calls) {
+				out.push_back(instr.a);
+			}
+			out.push_back(i + 1);
+			break;
+		default:
+			out.push_back(i + 1);
+	}
+	out.erase(std::remove_if(out.begin(), out.end(),
+			[this](const uint32_t addr) { return addr >= code.size(); }), out.end());
+	return out;
+}
+
+// first instruction of each basic block
+std::vector<bool> Optimizer::get_leaders() const
+{
+	std::vector<bool> out(code.size());
+	for(const auto addr : program.entry_points) {
+		if(addr < code.size()) {
+			out[addr] = true;
+		}
+	}
+	for(size_t i = 0; i < code.size(); ++i) {
+		const auto& instr = code[i];
+		if(has_target(instr) && instr.a < code.size()) {
+			out[instr.a] = true;
+		}
+		switch(instr.code) {
+			case OP_JUMP:
+			case OP_JUMPI:
+			case OP_JUMPN:
+			case OP_CALL:
+			case OP_RCALL:
+			case OP_RET:
+			case OP_FAIL:
+				if(i + 1 < code.size()) {
+					out[i + 1] = true;
+				}
+				break;
+			default:
+				break;
+		}
+	}
+	if(!out.empty()) {
+		out[0] = true;
+	}
+	return out;
+}
+
+// stack slots read and overwritten by an instruction, relative to the current frame
+void Optimizer::get_use_def(const instr_t& instr, slot_set_t& use, slot_set_t& def) const
+{
+	use.assign(num_slots, false);
+	def.assign(num_slots, false);
+
+	const auto use_from = [&use](const uint32_t offset) {
+		for(size_t k = offset; k < use.size(); ++k) {
+			use[k] = true;
+		}
+	};
+	const auto roles = get_roles(instr.code);
+	for(int i = 0; i < 4; ++i) {
+		const auto addr = get_arg(instr, i);
+		const bool flag = instr.flags & REF_FLAGS[i];
+		switch(roles.arg[i]) {
+			case ROLE_READ:
+			case ROLE_MODIFY:
+				if(is_stack(addr)) {
+					use[addr - MEM_STACK] = true;
+				}
+				break;
+			case ROLE_WRITE:
+				if(is_stack(addr)) {
+					(flag ? use : def)[addr - MEM_STACK] = true;
+				}
+				break;
+			case ROLE_VALUE:
+				if(flag && is_stack(addr)) {
+					use[addr - MEM_STACK] = true;
+				}
+				break;
+			default:
+				break;
+		}
+	}
+	switch(instr.code) {
+		case OP_CALL:
+			// callee frame starts at offset, arguments above it
+			use_from(instr.b);
+			break;
+		case OP_RCALL:
+			use_from(instr.c);
+			break;
+		case OP_RET:
+			use[0] = true;		// return value
+			break;
+		default:
+			break;
+	}
+	if(!roles.known) {
+		use_from(0);
+	}
+}
+
+std::vector<Optimizer::slot_set_t> Optimizer::get_live_out() const
+{
+	std::vector<slot_set_t> use(code.size());
+	std::vector<slot_set_t> def(code.size());
+	std::vector<std::vector<uint32_t>> succ(code.size());
+	for(size_t i = 0; i < code.size(); ++i) {
+		get_use_def(code[i], use[i], def[i]);
+		succ[i] = get_successors(i, false);
+	}
+	std::vector<slot_set_t> live_in(code.size(), slot_set_t(num_slots));
+	std::vector<slot_set_t> live_out(code.size(), slot_set_t(num_slots));
+
+	bool changed = true;
+	while(changed) {
+		changed = false;
+		for(size_t i = code.size(); i-- > 0;)
+		{
+			auto& out = live_out[i];
+			for(const auto next : succ[i]) {
+				const auto& in = live_in[next];
+				for(size_t k = 0; k < num_slots; ++k) {
+					if(in[k] && !out[k]) {
+						out[k] = true;
+					}
+				}
+			}
+			auto& in = live_in[i];
+			for(size_t k = 0; k < num_slots; ++k) {
+				const bool live = use[i][k] || (out[k] && !def[i][k]);
+				if(live && !in[k]) {
+					in[k] = true;
+					changed = true;
+				}
+			}
+		}
+	}
+	return live_out;
+}
+
+// stack slots that are written on every path to an instruction, so reading them cannot fail
+std::vector<Optimizer::slot_set_t> Optimizer::get_init_in() const
+{
+	std::vector<slot_set_t> init_in(code.size(), slot_set_t(num_slots, true));
+	for(const auto addr : program.entry_points) {
+		if(addr < code.size()) {
+			init_in[addr].assign(num_slots, false);
+		}
+	}
+	for(const auto& instr : code) {
+		if(instr.code == OP_CALL && instr.a < code.size()) {
+			init_in[instr.a].assign(num_slots, false);
+		}
+	}
+	bool changed = true;
+	while(changed) {
+		changed = false;
+		for(size_t i = 0; i < code.size(); ++i)
+		{
+			const auto& instr = code[i];
+			auto out = init_in[i];
+			switch(instr.code) {
+				case OP_CLR:
+					if(is_stack(instr.a)) {
+						out[instr.a - MEM_STACK] = false;
+					}
+					break;
+				case OP_CALL:
+					// callee clears its frame on return
+					for(size_t k = instr.b; k < num_slots; ++k) {
+						out[k] = false;
+					}
+					break;
+				case OP_RCALL:
+					for(size_t k = instr.c; k < num_slots; ++k) {
+						out[k] = false;
+					}
+					break;
+				default:
+					if(get_roles(instr.code).arg[0] == ROLE_WRITE && !(instr.flags & OPFLAG_REF_A)
+						&& is_stack(instr.a) && !(instr.code == OP_COPY && instr.a == instr.b))
+					{
+						out[instr.a - MEM_STACK] = true;
+					}
+			}
+			for(const auto next : get_successors(i, false)) {
+				auto& in = init_in[next];
+				for(size_t k = 0; k < num_slots; ++k) {
+					if(in[k] && !out[k]) {
+						in[k] = false;
+						changed = true;
+					}
+				}
+			}
+		}
+	}
+	return init_in;
+}
+
+bool Optimizer::thread_jumps()
+{
+	bool changed = false;
+	removed.assign(code.size(), false);
+
+	for(size_t i = 0; i < code.size(); ++i)
+	{
+		auto& instr = code[i];
+		if(instr.code == OP_COPY && !instr.flags && instr.a == instr.b) {
+			removed[i] = true;		// Engine::copy() does nothing
+			changed = true;
+			continue;
+		}
+		if(!is_jump(instr)) {
+			continue;
+		}
+		// follow chains of unconditional jumps
+		auto target = instr.a;
+		for(size_t k = 0; k < code.size() && target < code.size() && target != i; ++k) {
+			const auto& next = code[target];
+			if(next.code != OP_JUMP || target == next.a) {
+				break;
+			}
+			target = next.a;
+		}
+		if(target != instr.a) {
+			instr.a = target;
+			changed = true;
+		}
+		if(instr.code == OP_JUMP && instr.a == i + 1) {
+			removed[i] = true;
+			changed = true;
+		}
+	}
+	compact();
+	return changed;
+}
+
+bool Optimizer::remove_unreachable()
+{
+	std::vector<bool> reached(code.size());
+	std::vector<uint32_t> queue;
+	for(const auto addr : program.entry_points) {
+		if(addr < code.size() && !reached[addr]) {
+			reached[addr] = true;
+			queue.push_back(addr);
+		}
+	}
+	while(!queue.empty()) {
+		const auto i = queue.back();
+		queue.pop_back();
+		for(const auto next : get_successors(i, true)) {
+			if(!reached[next]) {
+				reached[next] = true;
+				queue.push_back(next);
+			}
+		}
+	}
+	bool changed = false;
+	removed.assign(code.size(), false);
+	for(size_t i = 0; i < code.size(); ++i) {
+		if(!reached[i]) {
+			removed[i] = true;
+			changed = true;
+		}
+	}
+	compact();
+	return changed;
+}
+
+// constant / copy propagation within basic blocks, plus folding of the result
+bool Optimizer::propagate()
+{
+	bool changed = false;
+	removed.assign(code.size(), false);
+	const auto leaders = get_leaders();
+
+	std::map<uint32_t, uint32_t> alias;			// stack slot => const or stack address with the same value
+	std::map<uint32_t, varptr_t> known;			// stack slot => value
+
+	const auto kill = [&alias, &known](const uint32_t addr) {
+		alias.erase(addr);
+		known.erase(addr);
+		for(auto iter = alias.begin(); iter != alias.end();) {
+			if(iter->second == addr) {
+				iter = alias.erase(iter);
+			} else {
+				iter++;
+			}
+		}
+	};
+	const auto get_value = [this, &known](const uint32_t addr) -> const var_t* {
+		if(auto var = get_const(addr)) {
+			return var;
+		}
+		auto iter = known.find(addr);
+		return iter != known.end() ? iter->second.get() : nullptr;
+	};
+
+	for(size_t i = 0; i < code.size(); ++i)
+	{
+		if(leaders[i]) {
+			alias.clear();
+			known.clear();
+		}
+		auto& instr = code[i];
+		const auto roles = get_roles(instr.code);
+
+		// substitute plain reads
+		if(instr.code == OP_COPY || instr.code == OP_JUMPI || instr.code == OP_JUMPN || is_compute(instr)) {
+			for(int k = 0; k < 4; ++k) {
+				if(roles.arg[k] == ROLE_READ && !(instr.flags & REF_FLAGS[k])) {
+					auto iter = alias.find(get_arg(instr, k));
+					if(iter != alias.end()) {
+						set_arg(instr, k, iter->second);
+						changed = true;
+					}
+				}
+			}
+		}
+		if(instr.code == OP_COPY && !instr.flags && instr.a == instr.b) {
+			removed[i] = true;
+			changed = true;
+			continue;
+		}
+		if((instr.code == OP_JUMPI || instr.code == OP_JUMPN) && !instr.flags) {
+			if(auto var = get_value(instr.b)) {
+				if(is_true(*var) == (instr.code == OP_JUMPI)) {
+					instr = instr_t(OP_JUMP, 0, instr.a);
+				} else {
+					removed[i] = true;
+				}
+				changed = true;
+			}
+			continue;
+		}
+		varptr_t result;
+		if(is_compute(instr)) {
+			result = fold(instr, get_value(instr.b), get_value(instr.c));
+			if(result) {
+				auto iter = const_table.find(result);
+				if(iter != const_table.end()) {
+					instr = instr_t(OP_COPY, 0, instr.a, iter->second);
+					changed = true;
+				}
+			}
+		}
+		switch(instr.code) {
+			case OP_CALL:
+			case OP_RCALL:
+				alias.clear();
+				known.clear();
+				continue;
+			default:
+				break;
+		}
+		for(int k = 0; k < 4; ++k) {
+			switch(roles.arg[k]) {
+				case ROLE_WRITE:
+				case ROLE_MODIFY: {
+					const auto addr = get_arg(instr, k);
+					if(is_stack(addr)) {
+						kill(addr);
+					}
+					break;
+				}
+				default:
+					break;
+			}
+		}
+		if(is_stack(instr.a) && !(instr.flags & OPFLAG_REF_A)) {
+			if(instr.code == OP_COPY && !instr.flags && (is_const(instr.b) || is_stack(instr.b))) {
+				alias[instr.a] = instr.b;
+			} else if(result) {
+				known[instr.a] = result;
+			}
+		}
+	}
+	compact();
+	return changed;
+}
+
+// OP tmp, ...; COPY dst, tmp => OP dst, ... (if tmp is dead)
+bool Optimizer::forward_stores()
+{
+	bool changed = false;
+	removed.assign(code.size(), false);
+	const auto leaders = get_leaders();
+	const auto live_out = get_live_out();
+
+	for(size_t i = 0; i + 1 < code.size(); ++i)
+	{
+		auto& instr = code[i];
+		const auto& next = code[i + 1];
+		if(leaders[i + 1] || removed[i] || !is_compute(instr) || !is_stack(instr.a)) {
+			continue;
+		}
+		if(next.code != OP_COPY || next.flags || next.b != instr.a || next.a == instr.a) {
+			continue;
+		}
+		if(live_out[i + 1][instr.a - MEM_STACK]) {
+			continue;
+		}
+		instr.a = next.a;
+		removed[i + 1] = true;
+		changed = true;
+	}
+	compact();
+	return changed;
+}
+
+// remove writes to dead stack slots, if they cannot fail
+bool Optimizer::remove_dead_stores()
+{
+	bool changed = false;
+	removed.assign(code.size(), false);
+	const auto live_out = get_live_out();
+	const auto init_in = get_init_in();
+
+	for(size_t i = 0; i < code.size(); ++i)
+	{
+		const auto& instr = code[i];
+		if(instr.flags & OPFLAG_REF_A || !is_stack(instr.a) || live_out[i][instr.a - MEM_STACK]) {
+			continue;
+		}
+		bool is_pure = false;
+		if(instr.code == OP_COPY) {
+			is_pure = !instr.flags && (is_const(instr.b) || (is_stack(instr.b) && init_in[i][instr.b - MEM_STACK]));
+		} else if(is_compute(instr)) {
+			is_pure = bool(fold(instr, get_const(instr.b), get_const(instr.c)));
+		}
+		if(is_pure) {
+			removed[i] = true;
+			changed = true;
+		}
+	}
+	compact();
+	return changed;
+}
+
+void optimize(program_t& program, const int level)
+{
+	if(level <= 0 || program.code.empty()) {
+		return;
+	}
+	Optimizer opt(program);
+	if(!opt.check()) {
+		return;
+	}
+	for(int iter = 0; iter < 100; ++iter)
+	{
+		bool changed = false;
+		changed |= opt.thread_jumps();
+		changed |= opt.remove_unreachable();
+		if(level >= 2) {
+			changed |= opt.propagate();
+		}
+		if(level >= 3) {
+			changed |= opt.forward_stores();
+			changed |= opt.remove_dead_stores();
+		}
+		if(!changed) {
+			break;
+		}
+	}
+}
+
+code_stats_t get_code_stats(const std::vector<instr_t>& code, const std::vector<varptr_t>& constants)
+{
+	code_stats_t out;
+	out.num_instr = code.size();
+	out.num_const = constants.size();
+	for(const auto& var : constants) {
+		out.load_cost += WRITE_COST + (num_bytes(var.get()) * WRITE_32_BYTE_COST) / 32;
+	}
+	for(const auto& instr : code) {
+		out.exec_cost += INSTR_COST;
+		if(get_roles(instr.code).arg[0] == ROLE_WRITE) {
+			out.exec_cost += WRITE_COST;
+		}
+		switch(instr.code) {
+			case OP_CALL:
+			case OP_RCALL:
+				out.exec_cost += INSTR_CALL_COST;
+				break;
+			case OP_MUL:
+				out.exec_cost += INSTR_MUL_128_COST;
+				break;
+			default:
+				break;
+		}
+	}
+	return out;
+}
+
+code_stats_t get_code_stats(std::shared_ptr<const contract::Binary> binary)
+{
+	std::vector<instr_t> code;
+	deserialize(code, binary->binary.data(), binary->binary.size());
+
+	std::vector<varptr_t> constants;
+	for(auto& var : read_constants(binary)) {
+		constants.emplace_back(std::move(var));
+	}
+	return get_code_stats(code, constants);
+}
+
+
+} // vm
+} // mmx
@@ -12,6 +12,9 @@
 
 #include <vnx/vnx.h>
 
+#include <mutex>
+#include <unordered_map>
+
 
 namespace mmx {
 namespace vm {
@@ -63,11 +66,90 @@ void load(	std::shared_ptr<vm::Engine> engine,
 		throw std::runtime_error("constant memory overflow");
 	}
 	vm::deserialize(engine->code, binary->binary.data(), binary->binary.size());
+	engine->program = nullptr;
 
 	engine->init();
 	engine->check_gas();
 }
 
+static std::shared_ptr<const binary_image_t> create_binary_image(std::shared_ptr<const contract::Binary> binary)
+{
+	try {
+		auto constants = std::make_shared<const_image_t>();
+		for(auto& var : read_constants(binary)) {
+			switch(var->type) {
+				case TYPE_NIL:
+				case TYPE_TRUE:
+				case TYPE_FALSE:
+				case TYPE_UINT:
+				case TYPE_STRING:
+				case TYPE_BINARY:
+					break;
+				default:
+					return nullptr;		// needs Engine::assign()
+			}
+			const auto size = num_bytes(var.get());
+			if(size > MAX_VALUE_BYTES) {
+				return nullptr;
+			}
+			// same cost as Engine::assign()
+			constants->write_cost += WRITE_COST + (size * WRITE_32_BYTE_COST) / 32;
+
+			// same state as after Engine::begin()
+			var->flags = FLAG_CONST;
+			constants->vars.push_back(std::move(var));
+		}
+		if(constants->vars.size() >= MEM_EXTERN - MEM_CONST) {
+			return nullptr;
+		}
+		auto image = std::make_shared<binary_image_t>();
+		vm::deserialize(image->code, binary->binary.data(), binary->binary.size());
+		image->program = lower_program(image->code);
+		image->constants = constants;
+		return image;
+	}
+	catch(...) {
+		return nullptr;		// plain load() will throw the same
+	}
+}
+
+std::shared_ptr<const binary_image_t> get_binary_image(std::shared_ptr<const contract::Binary> binary, const addr_t& address)
+{
+	static std::mutex mutex;
+	static std::unordered_map<addr_t, std::shared_ptr<const binary_image_t>> cache;
+	{
+		std::lock_guard lock(mutex);
+		auto iter = cache.find(address);
+		if(iter != cache.end()) {
+			return iter->second;
+		}
+	}
+	const auto image = create_binary_image(binary);
+	{
+		std::lock_guard lock(mutex);
+		if((cache.size() + 1) >> 12) {
+			cache.clear();
+		}
+		cache[address] = image;
+	}
+	return image;
+}
+
+void load(	std::shared_ptr<vm::Engine> engine,
+			std::shared_ptr<const contract::Binary> binary, const addr_t& address)
+{
+	if(auto image = get_binary_image(binary, address)) {
+		engine->map_constants(image->constants);
+		engine->code = image->code;
+		engine->program = image->program;
+
+		engine->init();
+		engine->check_gas();
+	} else {
+		load(engine, binary);
+	}
+}
+
 void copy(std::shared_ptr<vm::Engine> dst, std::shared_ptr<vm::Engine> src, const uint64_t dst_addr, const uint64_t src_addr, size_t call_depth);
 
 void copy(	std::shared_ptr<vm::Engine> dst, std::shared_ptr<vm::Engine> src,
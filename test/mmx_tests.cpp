@@ -10,10 +10,12 @@
 #include <mmx/uint128.hpp>
 #include <mmx/fixed128.hpp>
 #include <mmx/tree_hash.h>
+#include <mmx/hash_512_t.hpp>
 #include <mmx/write_bytes.h>
 #include <mmx/mnemonic.h>
 #include <mmx/utils.h>
 
+#include <mmx/Block.hxx>
 #include <mmx/ChainParams.hxx>
 #include <mmx/contract/Data.hxx>
 #include <mmx/contract/Binary.hxx>
@@ -27,10 +29,14 @@
 #include <mmx/ProofOfSpaceOG.hxx>
 #include <mmx/pos/verify.h>
 
+#include <sha256_avx2.h>
+#include <sha256_avx512.h>
+
 #include <vnx/vnx.h>
 #include <vnx/test/Test.h>
 
 #include <map>
+#include <set>
 #include <iostream>
 #include <random>
 
@@ -49,6 +55,106 @@ void expect_throw(const std::function<void()>& code)
 
 using namespace mmx;
 
+// reference for compute_full(): previous implementation with std::sort on (Y, meta)
+std::vector<std::pair<uint32_t, bytes_t<pos::META_BYTES_OUT>>>
+compute_full_ref(	const std::vector<uint32_t>& X_in,
+					const std::vector<uint32_t>& Y_in,
+					std::vector<std::array<uint32_t, pos::N_META>> M_tmp,
+					std::vector<uint32_t>* X_out, const int ksize)
+{
+	using namespace pos;
+	const uint32_t kmask = ((uint64_t(1) << ksize) - 1);
+
+	std::vector<std::pair<uint32_t, uint32_t>> entries;
+	std::vector<std::vector<std::pair<uint32_t, uint32_t>>> LR_tmp(N_TABLE + 1);
+
+	for(size_t i = 0; i < Y_in.size(); ++i) {
+		entries.emplace_back(Y_in[i], i);
+	}
+	const auto sort_func =
+		[&M_tmp](const std::pair<uint32_t, uint32_t>& L, const std::pair<uint32_t, uint32_t>& R) -> bool {
+			if(L.first == R.first) {
+				return M_tmp[L.second] < M_tmp[R.second];
+			}
+			return L < R;
+		};
+
+	for(int t = 2; t <= N_TABLE; ++t)
+	{
+		std::vector<std::array<uint32_t, N_META>> M_next;
+		std::vector<std::pair<uint32_t, uint32_t>> matches;
+
+		std::sort(entries.begin(), entries.end(), sort_func);
+
+		for(size_t x = 0; x < entries.size(); ++x)
+		{
+			const auto YL = entries[x].first;
+			for(size_t y = x + 1; y < entries.size(); ++y)
+			{
+				const auto YR = entries[y].first;
+				if(YR == YL + 1) {
+					const auto PL = entries[x].second;
+					const auto PR = entries[y].second;
+					uint32_t hash[16] = {};
+					{
+						uint32_t msg[N_META * 2] = {};
+						for(int i = 0; i < N_META; ++i) {
+							msg[i] = M_tmp[PL][i];
+							msg[N_META + i] = M_tmp[PR][i];
+						}
+						const hash_512_t tmp(&msg, sizeof(msg));
+						::memcpy(hash, tmp.data(), tmp.size());
+					}
+					uint32_t Y_i = 0;
+					std::array<uint32_t, N_META> meta = {};
+					for(int i = 0; i < N_META; ++i) {
+						Y_i = Y_i ^ hash[i];
+						meta[i] = hash[i] & kmask;
+					}
+					matches.emplace_back(Y_i & kmask, M_next.size());
+					LR_tmp[t].emplace_back(PL, PR);
+					M_next.push_back(meta);
+				}
+				else if(YR > YL) {
+					break;
+				}
+			}
+		}
+		if(matches.empty()) {
+			throw std::logic_error("zero matches at table " + std::to_string(t));
+		}
+		M_tmp = std::move(M_next);
+		entries = std::move(matches);
+	}
+	X_out->clear();
+	std::sort(entries.begin(), entries.end(), sort_func);
+
+	std::set<std::array<uint32_t, N_META>> M_set;
+	std::vector<std::pair<uint32_t, bytes_t<META_BYTES_OUT>>> out;
+	for(const auto& entry : entries)
+	{
+		const auto& meta = M_tmp[entry.second];
+		if(!M_set.insert(meta).second) {
+			continue;
+		}
+		out.emplace_back(entry.first, bytes_t<META_BYTES_OUT>(meta.data(), META_BYTES_OUT));
+
+		std::vector<uint32_t> I_tmp = {entry.second};
+		for(int t = N_TABLE; t >= 2; --t) {
+			std::vector<uint32_t> I_next;
+			for(const auto i : I_tmp) {
+				I_next.push_back(LR_tmp[t][i].first);
+				I_next.push_back(LR_tmp[t][i].second);
+			}
+			I_tmp = std::move(I_next);
+		}
+		for(const auto i : I_tmp) {
+			X_out->push_back(X_in[i]);
+		}
+	}
+	return out;
+}
+
 
 int main(int argc, char** argv)
 {
@@ -156,6 +262,62 @@ int main(int argc, char** argv)
 			vnx::test::expect(next != hash, true);
 			hash = next;
 		}
+		const auto& a = list[0];
+		const auto& b = list[1];
+		const auto& c = list[2];
+		vnx::test::expect(mmx::calc_btree_hash({a}), a);
+		vnx::test::expect(mmx::calc_btree_hash({a, b, c}), hash_t(hash_t(a + b) + c));
+
+		for(int i = list.size(); i < 100000; ++i) {
+			list.push_back(hash_t(std::to_string(i)));
+		}
+		auto level = list;
+		while(level.size() > 1) {
+			std::vector<hash_t> next;
+			for(size_t i = 0; i < level.size(); i += 2) {
+				next.push_back(i + 1 < level.size() ? hash_t(level[i] + level[i + 1]) : level[i]);
+			}
+			level = next;
+		}
+		vnx::test::expect(mmx::calc_btree_hash(list), level[0]);
+	}
+	VNX_TEST_END()
+
+	VNX_TEST_BEGIN("recursive_sha256_x8_x16")
+	{
+		const int num_lanes = 16;
+		std::vector<hash_t> input;
+		for(int k = 0; k < num_lanes; ++k) {
+			input.push_back(hash_t("recursive_sha256_" + std::to_string(k)));
+		}
+		for(const uint64_t num_iters : {1, 2, 3, 64, 1000}) {
+			std::vector<hash_t> expected = input;
+			for(auto& hash : expected) {
+				for(uint64_t i = 0; i < num_iters; ++i) {
+					hash = hash_t(hash.bytes);
+				}
+			}
+			uint8_t buf[num_lanes * 32];
+			if(avx2_available()) {
+				for(int k = 0; k < num_lanes; ++k) {
+					::memcpy(buf + k * 32, input[k].data(), 32);
+				}
+				recursive_sha256_avx2_x8(buf, num_iters);
+				recursive_sha256_avx2_x8(buf + 8 * 32, num_iters);
+				for(int k = 0; k < num_lanes; ++k) {
+					vnx::test::expect(hash_t::from_bytes(buf + k * 32), expected[k]);
+				}
+			}
+			if(avx512_available()) {
+				for(int k = 0; k < num_lanes; ++k) {
+					::memcpy(buf + k * 32, input[k].data(), 32);
+				}
+				recursive_sha256_avx512_x16(buf, num_iters);
+				for(int k = 0; k < num_lanes; ++k) {
+					vnx::test::expect(hash_t::from_bytes(buf + k * 32), expected[k]);
+				}
+			}
+		}
 	}
 	VNX_TEST_END()
 
@@ -376,6 +538,64 @@ int main(int argc, char** argv)
 	}
 	VNX_TEST_END()
 
+	VNX_TEST_BEGIN("signature_t::verify_many")
+	{
+		std::vector<std::tuple<hash_t, pubkey_t, signature_t>> list;
+		for(int i = 0; i < 200; ++i) {
+			const auto skey = skey_t(hash_t("skey_" + std::to_string(i % 10)));
+			const auto msg = hash_t("msg_" + std::to_string(i));
+			list.emplace_back(msg, pubkey_t(skey), signature_t::sign(skey, msg));
+		}
+		// valid batch, single entry: verify() is answered from cache
+		{
+			const auto& entry = list[0];
+			const auto res = signature_t::verify_many({entry});
+			vnx::test::expect(res.size(), 1u);
+			vnx::test::expect(bool(res[0]), true);
+
+			const auto hits = signature_t::get_cache_hits();
+			vnx::test::expect(std::get<2>(entry).verify(std::get<1>(entry), std::get<0>(entry)), true);
+			vnx::test::expect(signature_t::get_cache_hits(), hits + 1);
+		}
+		// larger than one chunk, uses thread pool
+		{
+			const auto res = signature_t::verify_many(list);
+			vnx::test::expect(res.size(), list.size());
+			for(const auto ok : res) {
+				vnx::test::expect(bool(ok), true);
+			}
+			const auto hits = signature_t::get_cache_hits();
+			for(const auto& entry : list) {
+				vnx::test::expect(std::get<2>(entry).verify(std::get<1>(entry), std::get<0>(entry)), true);
+			}
+			vnx::test::expect(signature_t::get_cache_hits() > hits, true);
+		}
+		// bad signature and bad pubkey: false and not cached
+		{
+			auto bad_list = list;
+			std::get<2>(bad_list[10]) = std::get<2>(list[11]);
+			std::get<1>(bad_list[100]) = pubkey_t();
+			const auto res = signature_t::verify_many(bad_list);
+			vnx::test::expect(res.size(), bad_list.size());
+			for(size_t i = 0; i < res.size(); ++i) {
+				vnx::test::expect(bool(res[i]), i != 10 && i != 100);
+			}
+			for(const size_t i : {10, 100}) {
+				const auto& entry = bad_list[i];
+				const auto hits = signature_t::get_cache_hits();
+				bool valid = false;
+				try {
+					valid = std::get<2>(entry).verify(std::get<1>(entry), std::get<0>(entry));
+				} catch(...) {
+					// invalid pubkey
+				}
+				vnx::test::expect(valid, false);
+				vnx::test::expect(signature_t::get_cache_hits(), hits);
+			}
+		}
+	}
+	VNX_TEST_END()
+
 	VNX_TEST_BEGIN("proof_verify")
 	{
 		mmx::hash_t plot_id;
@@ -417,6 +637,69 @@ int main(int argc, char** argv)
 	}
 	VNX_TEST_END()
 
+	VNX_TEST_BEGIN("compute_full_order")
+	{
+		// small ksize for many runs of equal Y, enough entries for radix sort and parallel matching
+		const int ksize = 14;
+		const uint32_t num_entries = 1 << ksize;
+
+		std::mt19937 generator(1337);
+		std::uniform_int_distribution<uint32_t> dist(0, (1 << ksize) - 1);
+
+		std::vector<uint32_t> X_in, Y_in;
+		std::vector<std::array<uint32_t, pos::N_META>> M_in(num_entries);
+		for(uint32_t i = 0; i < num_entries; ++i) {
+			X_in.push_back(i);
+			Y_in.push_back(dist(generator));
+			for(auto& meta : M_in[i]) {
+				meta = dist(generator);
+			}
+		}
+		std::vector<uint32_t> X_ref;
+		const auto ref = compute_full_ref(X_in, Y_in, M_in, &X_ref, ksize);
+		vnx::test::expect(ref.empty(), false);
+
+		vnx::ThreadPool threads(4);
+		for(auto* pool : {(vnx::ThreadPool*)nullptr, &threads})
+		{
+			auto M_tmp = M_in;
+			std::vector<uint32_t> X_out;
+			const auto res = pos::compute_full(X_in, Y_in, M_tmp, &X_out, hash_t(), ksize, pool);
+			vnx::test::expect(res.size(), ref.size());
+			for(size_t i = 0; i < res.size(); ++i) {
+				vnx::test::expect(res[i].first, ref[i].first);
+				vnx::test::expect(res[i].second, ref[i].second);
+			}
+			vnx::test::expect(X_out == X_ref, true);
+		}
+		threads.close();
+	}
+	VNX_TEST_END()
+
+	VNX_TEST_BEGIN("make_header_only")
+	{
+		auto block = Block::create();
+		block->time_stamp = 1337;
+		block->finalize();
+		block->content_hash = block->calc_content_hash();
+		vnx::test::expect(block->is_valid(), true);
+
+		// same as Router does for Node::get_header() returns
+		const auto header = block->get_header();
+		vnx::test::expect(bool(std::dynamic_pointer_cast<const Block>(header)), false);
+
+		const auto copy = make_header_only(header);
+		vnx::test::expect(copy->BlockHeader::is_valid(), true);
+		vnx::test::expect(copy->hash, block->hash);
+		vnx::test::expect(copy->content_hash, block->content_hash);
+		vnx::test::expect(copy->calc_hash(), block->hash);
+
+		// header stored on disk / in history
+		const auto stored = vnx::clone(header);
+		vnx::test::expect(make_header_only(stored)->BlockHeader::is_valid(), true);
+	}
+	VNX_TEST_END()
+
 	VNX_TEST_BEGIN("mnemonic")
 	{
 		vnx::test::expect(
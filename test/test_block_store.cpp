@@ -0,0 +1,234 @@
+/*
+ * test_block_store.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <mmx/block_store_t.h>
+
+#include <vnx/vnx.h>
+#include <vnx/test/Test.h>
+
+#include <functional>
+
+using namespace mmx;
+
+
+void expect_throw(const std::function<void()>& code)
+{
+	bool did_throw = false;
+	try {
+		code();
+	} catch(...) {
+		did_throw = true;
+	}
+	if(!did_throw) {
+		throw std::logic_error("expected failure");
+	}
+}
+
+std::shared_ptr<Block> make_block(const uint32_t height, const size_t num_tx)
+{
+	auto block = Block::create();
+	block->height = height;
+	block->hash = hash_t("block_" + std::to_string(height));
+	for(size_t i = 0; i < num_tx; ++i) {
+		auto tx = Transaction::create();
+		tx->id = hash_t("tx_" + std::to_string(height) + "_" + std::to_string(i));
+		block->tx_list.push_back(tx);
+	}
+	return block;
+}
+
+void expect_block(std::shared_ptr<const BlockHeader> header, const uint32_t height, const size_t num_tx)
+{
+	vnx::test::expect(bool(header), true);
+	vnx::test::expect(header->height, height);
+	vnx::test::expect(header->hash, hash_t("block_" + std::to_string(height)));
+
+	if(num_tx) {
+		auto block = std::dynamic_pointer_cast<const Block>(header);
+		vnx::test::expect(bool(block), true);
+		vnx::test::expect(block->tx_list.size(), num_tx);
+		for(size_t i = 0; i < num_tx; ++i) {
+			vnx::test::expect(block->tx_list[i]->id, hash_t("tx_" + std::to_string(height) + "_" + std::to_string(i)));
+		}
+	}
+}
+
+
+int main(int argc, char** argv)
+{
+	vnx::test::init("mmx.block_store");
+
+	const std::string root_path = "tmp/test_block_store";
+	const std::string legacy_file = "tmp/test_block_store_legacy.dat";
+	const uint32_t segment_size = 10;
+	const uint32_t ring_size = 16;
+	const uint32_t num_blocks = 35;
+	const size_t num_tx = 3;
+
+	std::vector<int64_t> offsets;
+	std::vector<std::vector<int64_t>> tx_offsets;
+
+	VNX_TEST_BEGIN("write_read")
+	{
+		block_store_t store(root_path, legacy_file, segment_size, ring_size);
+		store.clear();
+
+		for(uint32_t height = 0; height < num_blocks; ++height) {
+			std::vector<int64_t> list;
+			offsets.push_back(store.write(make_block(height, num_tx), &list));
+			tx_offsets.push_back(list);
+			vnx::test::expect(list.size(), num_tx);
+		}
+		for(uint32_t height = 0; height < num_blocks; ++height) {
+			const auto offset = offsets[height];
+			vnx::test::expect(uint32_t(offset >> block_store_t::segment_shift), 1 + height / segment_size);
+
+			std::vector<int64_t> list;
+			expect_block(store.read(offset, true, &list), height, num_tx);
+			vnx::test::expect(list, tx_offsets[height]);
+
+			const auto header = store.read(offset, false);
+			expect_block(header, height, 0);
+			vnx::test::expect(bool(std::dynamic_pointer_cast<const Block>(header)), false);
+
+			for(size_t i = 0; i < num_tx; ++i) {
+				const auto tx = store.read_tx(tx_offsets[height][i]);
+				vnx::test::expect(bool(tx), true);
+				vnx::test::expect(tx->id, hash_t("tx_" + std::to_string(height) + "_" + std::to_string(i)));
+			}
+		}
+		// segment of a height that was never written
+		vnx::test::expect(bool(store.read(int64_t(100) << block_store_t::segment_shift, false)), false);
+	}
+	VNX_TEST_END()
+
+	VNX_TEST_BEGIN("header_ring")
+	{
+		block_store_t store(root_path, legacy_file, segment_size, ring_size);
+
+		for(uint32_t height = 0; height < num_blocks; ++height) {
+			store.set_main(height, hash_t("block_" + std::to_string(height)), offsets[height]);
+		}
+		for(uint32_t height = 0; height < num_blocks; ++height) {
+			hash_t hash;
+			int64_t offset = 0;
+			const bool found = store.find_main(height, hash, offset);
+			vnx::test::expect(found, height + ring_size >= num_blocks);		// older entries are overwritten
+			if(found) {
+				vnx::test::expect(hash, hash_t("block_" + std::to_string(height)));
+				vnx::test::expect(offset, offsets[height]);
+			}
+		}
+		hash_t hash;
+		int64_t offset = 0;
+
+		store.erase_main(30);
+		vnx::test::expect(store.find_main(30, hash, offset), false);
+		store.erase_main(30 - ring_size);		// different height in same slot
+		store.set_main(30, hash_t("block_30"), offsets[30]);
+		vnx::test::expect(store.find_main(30, hash, offset), true);
+
+		store.revert_main(32);
+		vnx::test::expect(store.find_main(31, hash, offset), true);
+		for(uint32_t height = 32; height < num_blocks; ++height) {
+			vnx::test::expect(store.find_main(height, hash, offset), false);
+		}
+		for(uint32_t height = 32; height < num_blocks; ++height) {
+			store.set_main(height, hash_t("block_" + std::to_string(height)), offsets[height]);
+		}
+		// gap at 25 stops a contiguous revert, but not a full scan
+		store.erase_main(25);
+		store.revert_main(24);
+		vnx::test::expect(store.find_main(24, hash, offset), false);
+		vnx::test::expect(store.find_main(26, hash, offset), true);
+
+		store.revert_main(24, true);
+		for(uint32_t height = 24; height < num_blocks; ++height) {
+			vnx::test::expect(store.find_main(height, hash, offset), false);
+		}
+		for(uint32_t height = 24; height < num_blocks; ++height) {
+			store.set_main(height, hash_t("block_" + std::to_string(height)), offsets[height]);
+		}
+	}
+	VNX_TEST_END()
+
+	VNX_TEST_BEGIN("reopen")
+	{
+		block_store_t store(root_path, legacy_file, segment_size, ring_size);
+		vnx::test::expect(store.get_prune_segment(), 1u);
+
+		for(uint32_t height = 0; height < num_blocks; ++height) {
+			expect_block(store.read(offsets[height], true), height, num_tx);
+		}
+#ifndef _WIN32
+		// ring is memory mapped
+		for(uint32_t height = 24; height < num_blocks; ++height) {
+			hash_t hash;
+			int64_t offset = 0;
+			vnx::test::expect(store.find_main(height, hash, offset), true);
+			vnx::test::expect(hash, hash_t("block_" + std::to_string(height)));
+			vnx::test::expect(offset, offsets[height]);
+		}
+#endif
+		// appending after reopen
+		std::vector<int64_t> list;
+		const auto offset = store.write(make_block(num_blocks, num_tx), &list);
+		expect_block(store.read(offset, true), num_blocks, num_tx);
+		expect_block(store.read(offsets[num_blocks - 1], true), num_blocks - 1, num_tx);
+	}
+	VNX_TEST_END()
+
+	VNX_TEST_BEGIN("prune")
+	{
+		block_store_t store(root_path, legacy_file, segment_size, ring_size);
+
+		vnx::test::expect(store.prune(5), 0u);		// segment 1 still needed
+		vnx::test::expect(store.is_pruned(offsets[0]), false);
+
+		vnx::test::expect(store.prune(25), 2u);
+		vnx::test::expect(store.get_prune_segment(), 3u);
+		vnx::test::expect(store.prune(25), 0u);
+
+		for(uint32_t height = 0; height < num_blocks; ++height) {
+			const bool pruned = height < 20;
+			vnx::test::expect(store.is_pruned(offsets[height]), pruned);
+			vnx::test::expect(store.is_pruned(tx_offsets[height][0]), pruned);
+			if(pruned) {
+				expect_throw([&]() { store.read(offsets[height], false); });
+				expect_throw([&]() { store.read_tx(tx_offsets[height][0]); });
+			} else {
+				expect_block(store.read(offsets[height], true), height, num_tx);
+			}
+		}
+		vnx::test::expect(vnx::File(root_path + "/000001.dat").exists(), false);
+		vnx::test::expect(vnx::File(root_path + "/000002.dat").exists(), false);
+		vnx::test::expect(vnx::File(root_path + "/000003.dat").exists(), true);
+
+		// legacy file is never pruned
+		vnx::test::expect(store.is_pruned(0), false);
+	}
+	VNX_TEST_END()
+
+	VNX_TEST_BEGIN("reopen_pruned")
+	{
+		block_store_t store(root_path, legacy_file, segment_size, ring_size);
+		vnx::test::expect(store.get_prune_segment(), 3u);
+		vnx::test::expect(store.is_pruned(offsets[19]), true);
+		vnx::test::expect(store.is_pruned(offsets[20]), false);
+		expect_block(store.read(offsets[20], true), 20, num_tx);
+
+		store.clear();
+		vnx::test::expect(store.get_prune_segment(), 1u);
+		vnx::test::expect(vnx::File(root_path + "/000003.dat").exists(), false);
+
+		hash_t hash;
+		int64_t offset = 0;
+		vnx::test::expect(store.find_main(num_blocks - 1, hash, offset), false);
+	}
+	VNX_TEST_END()
+
+	return vnx::test::done();
+}
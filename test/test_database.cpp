@@ -182,6 +182,36 @@ int main(int argc, char** argv)
 	}
 	VNX_TEST_END()
 
+	VNX_TEST_BEGIN("table_find_many")
+	{
+		mmx::uint_table<uint32_t, std::string> table;
+		auto db = table.open("tmp/table_find_many");
+		db->revert(0);
+		table.insert(1, "one");
+		table.insert(3, "three");
+		{
+			std::vector<std::pair<uint32_t, std::string>> result;
+			vnx::test::expect(table.find_many({3, 2, 1}, result), 2u);
+			vnx::test::expect(result[0].first, 3u);
+			vnx::test::expect(result[0].second, "three");
+			vnx::test::expect(result[1].first, 1u);
+			vnx::test::expect(result[1].second, "one");
+		}
+		// undecodable value: same error as find()
+		db->insert(db_write(uint32_t(5)), db_write(uint32_t(-1)));
+		{
+			bool did_throw = false;
+			try {
+				std::vector<std::pair<uint32_t, std::string>> result;
+				table.find_many({1, 5}, result);
+			} catch(...) {
+				did_throw = true;
+			}
+			vnx::test::expect(did_throw, true);
+		}
+	}
+	VNX_TEST_END()
+
 	VNX_TEST_BEGIN("uint_multi_table")
 	{
 		mmx::uint_multi_table<uint32_t, std::string> table("tmp/uint_multi_table");
@@ -298,6 +328,292 @@ int main(int argc, char** argv)
 	}
 	VNX_TEST_END()
 
+	VNX_TEST_BEGIN("db_val_view")
+	{
+		mmx::Table::options_t options;
+		options.max_block_size = 64 * 1024;
+		auto table = std::make_shared<mmx::Table>("tmp/test_table_view", options);
+		table->revert(0);
+
+		const uint32_t num_entries = 10000;
+
+		for(uint32_t i = 0; i < num_entries; ++i) {
+			const auto key = vnx::to_big_endian(i);
+			const uint64_t value = i;
+			table->insert(mmx::db_val_view(&key, sizeof(key)), mmx::db_val_view(&value, sizeof(value)));
+		}
+		table->commit(1);
+		table->insert(db_write(uint32_t(0)), db_write(uint64_t(-1)));
+		table->commit(2);
+
+		std::vector<uint8_t> value;
+		for(uint32_t i = 0; i < num_entries; ++i) {
+			const auto key = vnx::to_big_endian(i);
+			vnx::test::expect(table->find(mmx::db_val_view(&key, sizeof(key)), value, 1), true);
+			vnx::test::expect(mmx::db_val_view(value).to<uint64_t>(), uint64_t(i));
+		}
+		{
+			const auto key = vnx::to_big_endian(num_entries);
+			vnx::test::expect(table->find(mmx::db_val_view(&key, sizeof(key)), value), false);
+		}
+		vnx::test::expect(db_read<uint64_t>(table->find(db_write(uint32_t(0)))), uint64_t(-1));
+
+		table->revert(1);
+		vnx::test::expect(db_read<uint64_t>(table->find(db_write(uint32_t(0)))), uint64_t(0));
+	}
+	VNX_TEST_END()
+
+	VNX_TEST_BEGIN("mmap_read")
+	{
+		const uint32_t num_entries = 1000;
+
+		mmx::Table::options_t options;
+		options.use_mmap = false;
+		auto table = std::make_shared<mmx::Table>("tmp/test_table_mmap", options);
+		table->revert(0);
+
+		for(uint32_t i = 0; i < num_entries; ++i) {
+			table->insert(db_write(uint32_t(i * 2)), db_write(uint64_t(i)));
+		}
+		table->commit(1);
+		for(uint32_t i = 0; i < num_entries; ++i) {
+			table->insert(db_write(uint32_t(i * 2)), db_write(uint64_t(i + 1)));
+		}
+		table->commit(2);
+		table->flush();
+
+		for(const bool use_mmap : {false, true})
+		{
+			options.use_mmap = use_mmap;
+			table = nullptr;
+			table = std::make_shared<mmx::Table>("tmp/test_table_mmap", options);
+
+			for(uint32_t i = 0; i < num_entries; ++i) {
+				vnx::test::expect(db_read<uint64_t>(table->find(db_write(uint32_t(i * 2)))), i + 1);
+				vnx::test::expect(db_read<uint64_t>(table->find(db_write(uint32_t(i * 2)), 1)), i);
+				vnx::test::expect(bool(table->find(db_write(uint32_t(i * 2 + 1)))), false);
+			}
+			auto iter = std::make_shared<mmx::Table::Iterator>(table);
+			iter->seek_last();
+			uint32_t i = num_entries;
+			while(iter->is_valid()) {
+				i--;
+				vnx::test::expect(db_read<uint32_t>(iter->key()), i * 2);
+				vnx::test::expect(db_read<uint64_t>(iter->value()), i + 1);
+				iter->prev();
+			}
+			vnx::test::expect(i, 0u);
+		}
+	}
+	VNX_TEST_END()
+
+	VNX_TEST_BEGIN("background_compaction")
+	{
+		const uint32_t num_flush = 20;
+		const uint32_t num_entries = 100;
+
+		mmx::Table::options_t options;
+		options.level_factor = 2;
+		options.background_compaction = true;
+		auto table = std::make_shared<mmx::Table>("tmp/test_table_compaction", options);
+		table->revert(0);
+
+		for(uint32_t k = 0; k < num_flush; ++k) {
+			for(uint32_t i = 0; i < num_entries; ++i) {
+				table->insert(db_write(uint32_t(i)), db_write(uint64_t(k)));
+			}
+			table->commit(k + 1);
+			table->flush();
+		}
+		table->wait_compaction();
+
+		const auto stats = table->get_compaction_stats();
+		vnx::test::expect(stats.is_running, false);
+		vnx::test::expect(stats.num_rewrites > 0, true);
+
+		for(uint32_t k = 0; k < num_flush; ++k) {
+			for(uint32_t i = 0; i < num_entries; ++i) {
+				vnx::test::expect(db_read<uint64_t>(table->find(db_write(uint32_t(i)), k)), uint64_t(k));
+			}
+		}
+		table->revert(num_flush / 2);
+
+		for(uint32_t i = 0; i < num_entries; ++i) {
+			vnx::test::expect(db_read<uint64_t>(table->find(db_write(uint32_t(i)))), uint64_t(num_flush / 2 - 1));
+		}
+	}
+	VNX_TEST_END()
+
+	VNX_TEST_BEGIN("revert_during_compaction")
+	{
+		const uint32_t num_flush = 3;
+		const uint32_t num_entries = 50000;
+
+		mmx::Table::options_t options;
+		options.level_factor = 2;
+		options.background_compaction = true;
+		options.compaction_rate_limit = 100 * 1024;		// would take ~10 sec to finish
+		auto table = std::make_shared<mmx::Table>("tmp/test_table_revert_compaction", options);
+		table->revert(0);
+
+		for(uint32_t k = 0; k < num_flush; ++k) {
+			for(uint32_t i = 0; i < num_entries; ++i) {
+				table->insert(db_write(uint32_t(i)), db_write(uint64_t(k)));
+			}
+			table->commit(k + 1);
+			table->flush();
+		}
+		vnx::test::expect(table->get_compaction_stats().is_running, true);
+
+		const auto time_begin = vnx::get_wall_time_millis();
+		table->revert(1);
+		vnx::test::expect(vnx::get_wall_time_millis() - time_begin < 3000, true);
+
+		const auto stats = table->get_compaction_stats();
+		vnx::test::expect(stats.is_running, false);
+		vnx::test::expect(stats.num_aborted, 1u);
+		vnx::test::expect(stats.num_rewrites, 0u);
+		vnx::test::expect(vnx::File("tmp/test_table_revert_compaction/rewrite.tmp").exists(), false);
+
+		for(uint32_t i = 0; i < num_entries; ++i) {
+			vnx::test::expect(db_read<uint64_t>(table->find(db_write(uint32_t(i)))), uint64_t(0));
+		}
+		table = nullptr;
+		table = std::make_shared<mmx::Table>("tmp/test_table_revert_compaction", options);
+		vnx::test::expect(table->current_version(), 1u);
+	}
+	VNX_TEST_END()
+
+	VNX_TEST_BEGIN("bloom_filter")
+	{
+		const uint32_t num_entries = 10000;
+
+		mmx::Table::options_t options;
+		options.bloom_bits_per_key = 10;
+		options.background_compaction = false;
+		auto table = std::make_shared<mmx::Table>("tmp/test_table_bloom", options);
+		table->revert(0);
+
+		for(uint32_t i = 0; i < num_entries; ++i) {
+			table->insert(db_write(uint32_t(i * 2)), db_write(uint64_t(i)));
+		}
+		table->commit(1);
+		table->flush();
+
+		size_t prev_positives = 0;
+		for(const bool reopen : {false, true})
+		{
+			if(reopen) {
+				table = nullptr;
+				table = std::make_shared<mmx::Table>("tmp/test_table_bloom", options);
+			}
+			for(uint32_t i = 0; i < num_entries; ++i) {
+				vnx::test::expect(table->bloom_contains(*db_write(uint32_t(i * 2))), true);
+			}
+			size_t num_positives = 0;
+			for(uint32_t i = 0; i < num_entries; ++i) {
+				num_positives += table->bloom_contains(*db_write(uint32_t(i * 2 + 1)));
+			}
+			// ~1% expected for 10 bits per key
+			vnx::test::expect(num_positives < num_entries / 33, true);
+
+			// same filter after reopen
+			if(reopen) {
+				vnx::test::expect(num_positives, prev_positives);
+			}
+			prev_positives = num_positives;
+		}
+	}
+	VNX_TEST_END()
+
+	VNX_TEST_BEGIN("block_compression")
+	{
+		const uint32_t num_entries = 5000;
+
+		mmx::Table::options_t options;
+		options.compression = mmx::Table::compression_t::ZSTD;
+		options.compression_chunk_size = 1024;
+		auto table = std::make_shared<mmx::Table>("tmp/test_table_compression", options);
+		table->revert(0);
+
+		for(uint32_t k = 0; k < 3; ++k) {
+			for(uint32_t i = 0; i < num_entries; ++i) {
+				table->insert(db_write(uint32_t(i * 2)), std::make_shared<mmx::db_val_t>("value_" + std::to_string(i + k)));
+			}
+			table->commit(k + 1);
+		}
+		table->flush();
+		table->revert(2);
+
+		for(const bool use_mmap : {false, true})
+		{
+			options.use_mmap = use_mmap;
+			table = nullptr;
+			table = std::make_shared<mmx::Table>("tmp/test_table_compression", options);
+			vnx::test::expect(table->current_version(), 2u);
+
+			for(uint32_t i = 0; i < num_entries; ++i) {
+				vnx::test::expect(table->find(db_write(uint32_t(i * 2)))->to_string(), "value_" + std::to_string(i + 1));
+				vnx::test::expect(table->find(db_write(uint32_t(i * 2)), 0)->to_string(), "value_" + std::to_string(i));
+				vnx::test::expect(bool(table->find(db_write(uint32_t(i * 2 + 1)))), false);
+			}
+			auto iter = std::make_shared<mmx::Table::Iterator>(table);
+			iter->seek_begin();
+			uint32_t i = 0;
+			while(iter->is_valid()) {
+				vnx::test::expect(db_read<uint32_t>(iter->key()), i * 2);
+				vnx::test::expect(iter->value()->to_string(), "value_" + std::to_string(i + 1));
+				iter->next();
+				i++;
+			}
+			vnx::test::expect(i, num_entries);
+		}
+	}
+	VNX_TEST_END()
+
+	VNX_TEST_BEGIN("find_many")
+	{
+		const uint32_t num_entries = 1000;
+
+		auto table = std::make_shared<mmx::Table>("tmp/test_table_find_many");
+		table->revert(0);
+
+		for(uint32_t i = 0; i < num_entries; ++i) {
+			table->insert(db_write(uint32_t(i * 2)), db_write(uint64_t(i)));
+		}
+		table->commit(1);
+		table->flush();
+
+		for(uint32_t i = 0; i < num_entries; i += 2) {
+			table->insert(db_write(uint32_t(i * 2)), db_write(uint64_t(i + 1)));
+		}
+		table->commit(2);
+
+		std::vector<std::shared_ptr<mmx::db_val_t>> keys;
+		for(uint32_t i = 0; i < 2 * num_entries; ++i) {
+			keys.push_back(db_write(uint32_t((i * 7919) % (2 * num_entries))));
+		}
+		keys.push_back(nullptr);
+
+		for(const uint32_t max_version : {0u, 1u})
+		{
+			const auto values = table->find_many(keys, max_version);
+			vnx::test::expect(values.size(), keys.size());
+
+			for(size_t k = 0; k + 1 < keys.size(); ++k) {
+				const auto key = db_read<uint32_t>(keys[k]);
+				if(key % 2) {
+					vnx::test::expect(bool(values[k]), false);
+				} else {
+					const auto i = key / 2;
+					vnx::test::expect(db_read<uint64_t>(values[k]), (max_version && i % 2 == 0) ? i + 1 : i);
+				}
+			}
+			vnx::test::expect(bool(values.back()), false);
+		}
+	}
+	VNX_TEST_END()
+
 	VNX_TEST_BEGIN("write_log_corruption")
 	{
 		auto table = std::make_shared<mmx::Table>("tmp/write_log_corruption");
@@ -12,6 +12,7 @@
 #include <vnx/vnx.h>
 
 #include <map>
+#include <vector>
 #include <cmath>
 #include <cstring>
 #include <iostream>
@@ -99,6 +100,36 @@ int main(int argc, char** argv)
 	std::cout << "min_pop_count = " << min_pop_count << std::endl;
 	std::cout << "avg_pop_count = " << pop_sum / double(count) << std::endl;
 
+	// calc_mem_hash_batch() needs to match calc_mem_hash()
+	{
+		const uint32_t num_keys = 16 + 8 + 3;
+
+		std::vector<uint8_t> keys(num_keys * 64);
+		std::vector<uint8_t> hashes(num_keys * 128);
+
+		for(uint32_t i = 0; i < num_keys; ++i) {
+			uint32_t msg[9] = {};
+			msg[0] = i;
+			const mmx::hash_512_t key(&msg, sizeof(msg));
+			::memcpy(keys.data() + i * 64, key.data(), key.size());
+		}
+		calc_mem_hash_batch(keys.data(), hashes.data(), num_keys, num_iter);
+
+		for(uint32_t i = 0; i < num_keys; ++i) {
+			mmx::bytes_t<128> hash;
+			gen_mem_array(mem, keys.data() + i * 64, mem_size);
+			calc_mem_hash(mem, hash.data(), num_iter);
+
+			if(::memcmp(hash.data(), hashes.data() + i * 128, 128)) {
+				std::cout << "calc_mem_hash_batch() mismatch at [" << i << "]" << std::endl;
+				delete [] mem;
+				return 1;
+			}
+		}
+		std::cout << "calc_mem_hash_batch() OK (avx2 = " << mem_hash_avx2_available()
+				<< ", avx512 = " << mem_hash_avx512_available() << ")" << std::endl;
+	}
+
 	delete [] mem;
 
 	return 0;
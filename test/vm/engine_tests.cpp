@@ -333,6 +333,91 @@ int main(int argc, char** argv)
 	}
 	VNX_TEST_END()
 
+	VNX_TEST_BEGIN("stack_memory")
+	{
+		auto engine = std::make_shared<vm::Engine>(addr_t(), backend, true);
+		engine->gas_limit = 1000000;
+		engine->init();
+		for(const uint64_t offset : {0, 1, 100, 0x10000, 0x20000}) {
+			engine->write(vm::MEM_STACK + offset, vm::uint_t(offset + 1));
+		}
+		for(const uint64_t offset : {0, 1, 100, 0x10000, 0x20000}) {
+			expect(engine->read(vm::MEM_STACK + offset), vm::uint_t(offset + 1));
+		}
+		vnx::test::expect(engine->read(vm::MEM_STACK + 2) == nullptr, true);
+
+		engine->clear_stack(100);
+		expect(engine->read(vm::MEM_STACK + 1), vm::uint_t(2));
+		vnx::test::expect(engine->read(vm::MEM_STACK + 100) == nullptr, true);
+		vnx::test::expect(engine->read(vm::MEM_STACK + 0x20000) == nullptr, true);
+
+		engine->clear_stack();
+		vnx::test::expect(engine->read(vm::MEM_STACK) == nullptr, true);
+	}
+	VNX_TEST_END()
+
+	VNX_TEST_BEGIN("map_constants")
+	{
+		auto image = std::make_shared<vm::const_image_t>();
+		image->vars.push_back(std::make_unique<vm::var_t>());
+		image->vars.push_back(std::make_unique<vm::uint_t>(1337));
+		image->vars.push_back(vm::binary_t::alloc("test"));
+		for(auto& var : image->vars) {
+			var->flags = vm::FLAG_CONST;
+		}
+		image->write_cost = 1000;
+
+		for(int i = 0; i < 2; ++i) {
+			auto engine = std::make_shared<vm::Engine>(addr_t(), backend, true);
+			engine->gas_limit = 1000000;
+			engine->map_constants(image);
+			engine->init();
+			vnx::test::expect(engine->gas_used, image->write_cost);
+			expect(engine->read(1), vm::uint_t(1337));
+			expect(engine->read(2), vm::binary_t::alloc("test"));
+			vnx::test::expect(engine->read(3) == nullptr, true);
+			vnx::test::expect(engine->lookup(vm::uint_t(1337), true), 1u);
+			vnx::test::expect(engine->lookup(vm::binary_t::alloc("test"), true), 2u);
+
+			bool did_throw = false;
+			try {
+				engine->erase(1);
+			} catch(...) {
+				did_throw = true;
+			}
+			vnx::test::expect(did_throw, true);
+		}
+		expect(image->vars[1].get(), vm::uint_t(1337));
+	}
+	VNX_TEST_END()
+
+	VNX_TEST_BEGIN("run_lowered")
+	{
+		auto engine = std::make_shared<vm::Engine>(addr_t(), backend, true);
+		engine->gas_limit = 1000000;
+		engine->write(vm::MEM_STATIC + 1, vm::uint_t(1));
+		engine->write(vm::MEM_STATIC + 2, vm::uint_t(2));
+		engine->init();
+		engine->code.emplace_back(vm::OP_COPY, 0, vm::MEM_STATIC + 3, vm::MEM_STATIC + 1);
+		engine->code.emplace_back(vm::OP_RET);
+		engine->begin(0);
+		engine->run();
+		expect(engine->read(vm::MEM_STATIC + 3), vm::uint_t(1));
+
+		// same size, different code: program needs to be reset
+		const auto program = engine->program;
+		engine->code[0] = vm::instr_t(vm::OP_COPY, 0, vm::MEM_STATIC + 4, vm::MEM_STATIC + 2);
+		vnx::test::expect(program->matches(engine->code), false);
+		engine->program = nullptr;
+		engine->begin(0);
+		engine->run();
+		expect(engine->read(vm::MEM_STATIC + 4), vm::uint_t(2));
+		vnx::test::expect(engine->program != program, true);
+		vnx::test::expect(engine->program->matches(engine->code), true);
+		vnx::test::expect(program->matches(engine->code), false);
+	}
+	VNX_TEST_END()
+
 	return vnx::test::done();
 }
 
@@ -0,0 +1,300 @@
+/*
+ * optimizer_tests.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <mmx/vm/Engine.h>
+#include <mmx/vm/Compiler.h>
+#include <mmx/vm/optimizer.h>
+#include <mmx/vm/StorageRAM.h>
+#include <mmx/vm_interface.h>
+
+#include <vnx/vnx.h>
+#include <vnx/test/Test.h>
+
+#include <iostream>
+
+using namespace mmx;
+
+static const uint32_t STACK_1 = vm::MEM_STACK + 1;
+static const uint32_t STACK_2 = vm::MEM_STACK + 2;
+static const uint32_t STATIC_1 = vm::MEM_STATIC + 1;
+static const uint32_t STATIC_2 = vm::MEM_STATIC + 2;
+
+struct result_t {
+	bool failed = false;
+	uint32_t error_code = 0;
+	uint64_t gas_used = 0;
+	std::vector<std::string> log;
+	std::map<std::pair<addr_t, uint64_t>, std::unique_ptr<vm::var_t>> memory;		// committed
+};
+
+static void expect_same(const result_t& O0, const result_t& O3)
+{
+	vnx::test::expect(O3.failed, O0.failed);
+	vnx::test::expect(O3.error_code, O0.error_code);
+	vnx::test::expect(O3.log, O0.log);
+	if(!O0.failed) {
+		vnx::test::expect(O3.gas_used <= O0.gas_used, true);
+	}
+	vnx::test::expect(O3.memory.size(), O0.memory.size());
+	for(const auto& entry : O0.memory) {
+		auto iter = O3.memory.find(entry.first);
+		vnx::test::expect(iter != O3.memory.end(), true);
+		vnx::test::expect(compare(iter->second.get(), entry.second.get()), 0);
+	}
+}
+
+static result_t finish(std::shared_ptr<vm::Engine> engine, std::shared_ptr<vm::StorageRAM> storage)
+{
+	result_t out;
+	try {
+		engine->run();
+		engine->commit();
+	} catch(...) {
+		out.failed = true;
+	}
+	out.error_code = engine->error_code;
+	out.gas_used = engine->gas_used;
+	for(const auto& entry : storage->get_memory()) {
+		if(entry.second) {
+			out.memory[entry.first] = vm::clone(entry.second.get());
+		}
+	}
+	return out;
+}
+
+// runs hand written code from address 0, STATIC_1 = 5
+static result_t execute(const vm::program_t& program)
+{
+	auto storage = std::make_shared<vm::StorageRAM>();
+	auto engine = std::make_shared<vm::Engine>(addr_t(), storage, false);
+	engine->gas_limit = 1000000;
+	for(size_t i = 0; i < program.constants.size(); ++i) {
+		engine->assign(vm::MEM_CONST + i, vm::clone(program.constants[i].get()));
+	}
+	engine->write(STATIC_1, vm::uint_t(5));
+	engine->init();
+	engine->code = program.code;
+	engine->begin(0);
+	return finish(engine, storage);
+}
+
+static result_t execute(std::shared_ptr<const contract::Binary> binary, const uint64_t gas_limit)
+{
+	auto storage = std::make_shared<vm::StorageRAM>();
+	auto engine = std::make_shared<vm::Engine>(hash_t("__test"), storage, false);
+	engine->gas_limit = gas_limit;
+
+	result_t out;
+	engine->log_func = [&out](uint32_t level, const std::string& msg) {
+		out.log.push_back(std::to_string(level) + " " + msg);
+	};
+	engine->event_func = [&out, &engine](const std::string& name, const uint64_t data) {
+		out.log.push_back(name + " " + vm::read(engine, data).to_string());
+	};
+	vm::load(engine, binary);
+
+	engine->write(vm::MEM_EXTERN + vm::EXTERN_USER, vm::var_t());
+	engine->write(vm::MEM_EXTERN + vm::EXTERN_ADDRESS, vm::to_binary(engine->contract));
+	engine->write(vm::MEM_EXTERN + vm::EXTERN_NETWORK, vm::to_binary(std::string("mainnet")));
+	engine->begin(0);
+
+	auto res = finish(engine, storage);
+	res.log = std::move(out.log);
+	engine->event_func = nullptr;
+	return res;
+}
+
+static vm::program_t optimized(vm::program_t program, const int level)
+{
+	program.entry_points = {0};
+	vm::optimize(program, level);
+	return program;
+}
+
+static void expect_instr(const vm::instr_t& instr, const vm::opcode_e code, const uint32_t a, const uint32_t b = 0, const uint32_t c = 0)
+{
+	vnx::test::expect(int(instr.code), int(code));
+	vnx::test::expect(instr.a, a);
+	vnx::test::expect(instr.b, b);
+	vnx::test::expect(instr.c, c);
+}
+
+static void test_files(const std::vector<std::string>& files, const uint64_t gas_limit, const bool expect_fail)
+{
+	for(const auto& file : files)
+	{
+		compile_flags_t flags;
+		flags.opt_level = 0;
+		const auto bin_O0 = vm::compile_files({file}, flags);
+		flags.opt_level = 3;
+		const auto bin_O3 = vm::compile_files({file}, flags);
+
+		const auto O0 = execute(bin_O0, gas_limit);
+		const auto O3 = execute(bin_O3, gas_limit);
+		try {
+			vnx::test::expect(O0.failed, expect_fail);
+			expect_same(O0, O3);
+		} catch(...) {
+			std::cerr << "[" << file << "]" << std::endl;
+			throw;
+		}
+	}
+}
+
+
+int main(int argc, char** argv)
+{
+	vnx::test::init("mmx.vm.optimizer");
+
+	VNX_TEST_BEGIN("jump_threading")
+	{
+		vm::program_t program;
+		program.constants.push_back(std::make_unique<vm::uint_t>(7));
+		program.code.emplace_back(vm::OP_JUMP, 0, 2);
+		program.code.emplace_back(vm::OP_FAIL, 0, 0);
+		program.code.emplace_back(vm::OP_JUMP, 0, 4);
+		program.code.emplace_back(vm::OP_COPY, 0, STACK_1, STACK_1);
+		program.code.emplace_back(vm::OP_COPY, 0, STACK_1, STACK_1);
+		program.code.emplace_back(vm::OP_COPY, 0, STATIC_2, vm::MEM_CONST);
+		program.code.emplace_back(vm::OP_RET);
+
+		const auto opt = optimized(program, 1);
+		vnx::test::expect(opt.code.size(), 2u);
+		expect_instr(opt.code[0], vm::OP_COPY, STATIC_2, vm::MEM_CONST);
+		vnx::test::expect(int(opt.code[1].code), int(vm::OP_RET));
+		expect_same(execute(program), execute(opt));
+	}
+	VNX_TEST_END()
+
+	VNX_TEST_BEGIN("propagation")
+	{
+		vm::program_t program;
+		program.constants.push_back(std::make_unique<vm::uint_t>(5));
+		program.constants.push_back(std::make_unique<vm::uint_t>(7));
+		program.constants.push_back(std::make_unique<vm::var_t>(true));
+		program.code.emplace_back(vm::OP_COPY, 0, STACK_1, vm::MEM_CONST);
+		program.code.emplace_back(vm::OP_COPY, 0, STACK_2, STACK_1);
+		program.code.emplace_back(vm::OP_ADD, 0, STATIC_2, STACK_2, vm::MEM_CONST + 1);
+		program.code.emplace_back(vm::OP_COPY, 0, STACK_1, vm::MEM_CONST + 2);
+		program.code.emplace_back(vm::OP_JUMPN, 0, 6, STACK_1);
+		program.code.emplace_back(vm::OP_RET);
+		program.code.emplace_back(vm::OP_FAIL, 0, 0);
+
+		// copy propagation, but no folding since 12 is not a constant
+		const auto opt = optimized(program, 2);
+		vnx::test::expect(opt.code.size(), 5u);
+		expect_instr(opt.code[1], vm::OP_COPY, STACK_2, vm::MEM_CONST);
+		expect_instr(opt.code[2], vm::OP_ADD, STATIC_2, vm::MEM_CONST, vm::MEM_CONST + 1);
+		vnx::test::expect(int(opt.code[4].code), int(vm::OP_RET));
+		expect_same(execute(program), execute(opt));
+
+		// level 1 does not propagate
+		vnx::test::expect(optimized(program, 1).code.size(), program.code.size());
+	}
+	VNX_TEST_END()
+
+	VNX_TEST_BEGIN("folding")
+	{
+		vm::program_t program;
+		program.constants.push_back(std::make_unique<vm::uint_t>(5));
+		program.constants.push_back(std::make_unique<vm::uint_t>(7));
+		program.constants.push_back(std::make_unique<vm::uint_t>(12));
+		program.code.emplace_back(vm::OP_COPY, 0, STACK_1, vm::MEM_CONST);
+		program.code.emplace_back(vm::OP_ADD, 0, STATIC_2, STACK_1, vm::MEM_CONST + 1);
+		program.code.emplace_back(vm::OP_CMP_LT, 0, STACK_2, STACK_1, vm::MEM_CONST + 1);
+		program.code.emplace_back(vm::OP_JUMPI, 0, 5, STACK_2);
+		program.code.emplace_back(vm::OP_FAIL, 0, 0);
+		program.code.emplace_back(vm::OP_RET);
+
+		const auto opt = optimized(program, 2);
+		vnx::test::expect(opt.code.size(), 4u);
+		expect_instr(opt.code[1], vm::OP_COPY, STATIC_2, vm::MEM_CONST + 2);
+		vnx::test::expect(int(opt.code[3].code), int(vm::OP_RET));
+		expect_same(execute(program), execute(opt));
+
+		// overflow is never folded
+		vm::program_t overflow;
+		overflow.constants.push_back(std::make_unique<vm::uint_t>(uint256_t(0) - 1));
+		overflow.constants.push_back(std::make_unique<vm::uint_t>(1));
+		overflow.constants.push_back(std::make_unique<vm::uint_t>(0));
+		overflow.code.emplace_back(vm::OP_ADD, vm::OPFLAG_CATCH_OVERFLOW, STATIC_2, vm::MEM_CONST, vm::MEM_CONST + 1);
+		overflow.code.emplace_back(vm::OP_RET);
+		const auto opt_overflow = optimized(overflow, 3);
+		vnx::test::expect(opt_overflow.code.size(), 2u);
+		vnx::test::expect(int(opt_overflow.code[0].code), int(vm::OP_ADD));
+		const auto res = execute(opt_overflow);
+		vnx::test::expect(res.failed, true);
+		expect_same(execute(overflow), res);
+	}
+	VNX_TEST_END()
+
+	VNX_TEST_BEGIN("store_forwarding")
+	{
+		vm::program_t program;
+		program.constants.push_back(std::make_unique<vm::uint_t>(1));
+		program.code.emplace_back(vm::OP_ADD, 0, STACK_1, STATIC_1, vm::MEM_CONST);
+		program.code.emplace_back(vm::OP_COPY, 0, STATIC_2, STACK_1);
+		program.code.emplace_back(vm::OP_RET);
+
+		vnx::test::expect(optimized(program, 2).code.size(), 3u);
+
+		const auto opt = optimized(program, 3);
+		vnx::test::expect(opt.code.size(), 2u);
+		expect_instr(opt.code[0], vm::OP_ADD, STATIC_2, STATIC_1, vm::MEM_CONST);
+		expect_same(execute(program), execute(opt));
+
+		// not if tmp is still used
+		program.code.insert(program.code.begin() + 2, vm::instr_t(vm::OP_COPY, 0, vm::MEM_STATIC + 3, STACK_1));
+		const auto opt2 = optimized(program, 3);
+		vnx::test::expect(opt2.code.size(), 4u);
+		expect_same(execute(program), execute(opt2));
+	}
+	VNX_TEST_END()
+
+	VNX_TEST_BEGIN("dead_store_removal")
+	{
+		vm::program_t program;
+		program.constants.push_back(std::make_unique<vm::uint_t>(5));
+		program.constants.push_back(std::make_unique<vm::uint_t>(7));
+		program.code.emplace_back(vm::OP_COPY, 0, STACK_1, vm::MEM_CONST);
+		program.code.emplace_back(vm::OP_COPY, 0, STATIC_2, vm::MEM_CONST + 1);
+		program.code.emplace_back(vm::OP_RET);
+
+		vnx::test::expect(optimized(program, 2).code.size(), 3u);
+
+		const auto opt = optimized(program, 3);
+		vnx::test::expect(opt.code.size(), 2u);
+		expect_instr(opt.code[0], vm::OP_COPY, STATIC_2, vm::MEM_CONST + 1);
+		expect_same(execute(program), execute(opt));
+
+		// read of a slot that may be unset can fail, must stay
+		vm::program_t failing;
+		failing.code.emplace_back(vm::OP_COPY, 0, STACK_1, STACK_2);
+		failing.code.emplace_back(vm::OP_RET);
+		const auto opt_failing = optimized(failing, 3);
+		vnx::test::expect(opt_failing.code.size(), 2u);
+		expect_same(execute(failing), execute(opt_failing));
+	}
+	VNX_TEST_END()
+
+	VNX_TEST_BEGIN("differential")
+	{
+		test_files({"test/vm/compiler_tests.js", "test/vm/engine_tests.js"}, -1, false);
+
+		std::vector<std::string> fails;
+		for(const auto& file : vnx::Directory("test/vm/fails").files()) {
+			if(file->get_extension() == ".js") {
+				fails.push_back(file->get_path());
+			}
+		}
+		std::sort(fails.begin(), fails.end());
+		vnx::test::expect(fails.empty(), false);
+		test_files(fails, 10000000, true);
+	}
+	VNX_TEST_END()
+
+	return vnx::test::done();
+}
@@ -9,6 +9,7 @@
 #include <mmx/vm/StorageDB.h>
 #include <mmx/vm/StorageRAM.h>
 #include <mmx/vm/StorageCache.h>
+#include <mmx/vm/StorageTracker.h>
 #include <mmx/vm_interface.h>
 
 #include <vnx/vnx.h>
@@ -404,6 +405,45 @@ int main(int argc, char** argv)
 	}
 	VNX_TEST_END()
 
+	VNX_TEST_BEGIN("access_set")
+	{
+		const addr_t contract(hash_t("test"));
+		const addr_t currency;
+
+		auto backend = std::make_shared<vm::StorageRAM>();
+		backend->set_balance(contract, currency, 1000);
+
+		auto tracker_1 = std::make_shared<vm::StorageTracker>(backend);
+		auto tracker_2 = std::make_shared<vm::StorageTracker>(backend);
+		auto cache_1 = std::make_shared<vm::StorageCache>(tracker_1);
+		auto cache_2 = std::make_shared<vm::StorageCache>(tracker_2);
+
+		// both only read the same balance: no conflict
+		vnx::test::expect<uint128, uint128>(*cache_1->get_balance(contract, currency), 1000);
+		vnx::test::expect<uint128, uint128>(*cache_2->get_balance(contract, currency), 1000);
+		{
+			vm::access_set_t write_set;
+			write_set.add_writes(*cache_1);
+			vnx::test::expect(write_set.balances.size(), 0u);
+			vnx::test::expect(tracker_2->get_read_set().intersects(write_set), false);
+		}
+		// first writes what second read: conflict
+		cache_1->set_balance(contract, currency, 500);
+		{
+			vm::access_set_t write_set;
+			write_set.add_writes(*cache_1);
+			vnx::test::expect(write_set.balances.size(), 1u);
+			vnx::test::expect(tracker_2->get_read_set().intersects(write_set), true);
+		}
+		// read-only balance is not committed, written one is
+		backend->set_balance(contract, currency, 2000);
+		cache_2->commit();
+		vnx::test::expect<uint128, uint128>(*backend->get_balance(contract, currency), 2000);
+		cache_1->commit();
+		vnx::test::expect<uint128, uint128>(*backend->get_balance(contract, currency), 500);
+	}
+	VNX_TEST_END()
+
 	return vnx::test::done();
 }
 
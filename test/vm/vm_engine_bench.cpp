@@ -0,0 +1,156 @@
+/*
+ * vm_engine_bench.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <mmx/vm/Engine.h>
+#include <mmx/vm/Compiler.h>
+#include <mmx/vm/StorageRAM.h>
+#include <mmx/vm_interface.h>
+#include <mmx/utils.h>
+
+#include <vnx/vnx.h>
+
+#include <iostream>
+
+using namespace mmx;
+
+// tight loops dominated by CMP + JUMPN, ADD + JUMP, COPY and arithmetic
+static const std::string loop_source = R"(
+var sum = 0;
+for(var i = 0; i < 200000; ++i) {
+	var tmp = i;
+	if(tmp > 100) {
+		sum += tmp - 100;
+	} else {
+		sum += 1;
+	}
+}
+var count = 0;
+while(count < 100000) {
+	count += 1;
+}
+)";
+
+struct result_t {
+	uint64_t num_instr = 0;
+	uint64_t gas_used = 0;
+	int64_t time_us = 0;
+};
+
+static std::shared_ptr<vm::Engine> create_engine(std::shared_ptr<const contract::Binary> binary)
+{
+	auto storage = std::make_shared<vm::StorageRAM>();
+	auto engine = std::make_shared<vm::Engine>(hash_t("__bench"), storage, false);
+	engine->gas_limit = uint64_t(1) << 40;
+
+	vm::load(engine, binary);
+
+	engine->write(vm::MEM_EXTERN + vm::EXTERN_USER, vm::var_t());
+	engine->write(vm::MEM_EXTERN + vm::EXTERN_ADDRESS, vm::to_binary(engine->contract));
+	engine->write(vm::MEM_EXTERN + vm::EXTERN_NETWORK, vm::to_binary(std::string("mainnet")));
+	engine->write(vm::MEM_EXTERN + vm::EXTERN_HEIGHT, vm::uint_t(0));
+	engine->begin(0);
+	return engine;
+}
+
+static result_t run_step(std::shared_ptr<const contract::Binary> binary)
+{
+	result_t out;
+	auto engine = create_engine(binary);
+
+	const auto time_begin = get_time_us();
+	while(!engine->call_stack.empty()) {
+		engine->step();
+		out.num_instr++;
+	}
+	out.time_us = get_time_us() - time_begin;
+	out.gas_used = engine->gas_used;
+	return out;
+}
+
+static result_t run_lowered(std::shared_ptr<const contract::Binary> binary, const uint64_t num_instr)
+{
+	result_t out;
+	auto engine = create_engine(binary);
+	engine->program = vm::lower_program(engine->code);
+
+	const auto time_begin = get_time_us();
+	engine->run();
+	out.time_us = get_time_us() - time_begin;
+	out.num_instr = num_instr;
+	out.gas_used = engine->gas_used;
+	return out;
+}
+
+
+int main(int argc, char** argv)
+{
+	std::map<std::string, std::string> options;
+	options["f"] = "files";
+	options["n"] = "repeat";
+	options["files"] = "source files";
+	options["repeat"] = "number of runs";
+
+	vnx::write_config("log_level", 2);
+
+	vnx::init("vm_engine_bench", argc, argv, options);
+
+	int repeat = 3;
+	std::vector<std::string> files = {"test/vm/compiler_tests.js", "test/vm/engine_tests.js"};
+	vnx::read_config("files", files);
+	vnx::read_config("repeat", repeat);
+
+	std::vector<std::pair<std::string, std::shared_ptr<const contract::Binary>>> programs;
+	try {
+		programs.emplace_back("loops", vm::compile(loop_source));
+		for(const auto& file : files) {
+			programs.emplace_back(file, vm::compile_files({file}));
+		}
+	} catch(const std::exception& ex) {
+		std::cerr << "Compile failed with: " << ex.what() << std::endl;
+		vnx::close();
+		return -1;
+	}
+
+	int ret = 0;
+	for(const auto& entry : programs)
+	{
+		result_t best_step;
+		result_t best_lower;
+		try {
+			for(int i = 0; i < std::max(repeat, 1); ++i) {
+				const auto res = run_step(entry.second);
+				if(!best_step.time_us || res.time_us < best_step.time_us) {
+					best_step = res;
+				}
+			}
+			for(int i = 0; i < std::max(repeat, 1); ++i) {
+				const auto res = run_lowered(entry.second, best_step.num_instr);
+				if(!best_lower.time_us || res.time_us < best_lower.time_us) {
+					best_lower = res;
+				}
+			}
+		} catch(const std::exception& ex) {
+			std::cerr << "[" << entry.first << "] failed with: " << ex.what() << std::endl;
+			ret = -1;
+			continue;
+		}
+		const auto step_rate = best_step.num_instr * 1e6 / std::max<int64_t>(best_step.time_us, 1);
+		const auto lower_rate = best_lower.num_instr * 1e6 / std::max<int64_t>(best_lower.time_us, 1);
+
+		std::cout << "[" << entry.first << "] " << best_step.num_instr << " instr, gas " << best_step.gas_used << std::endl;
+		std::cout << "  step():  " << uint64_t(step_rate) << " instr/sec" << std::endl;
+		std::cout << "  run():   " << uint64_t(lower_rate) << " instr/sec (x" << lower_rate / step_rate << ")" << std::endl;
+
+		if(best_lower.gas_used != best_step.gas_used) {
+			std::cerr << "[" << entry.first << "] gas mismatch: " << best_lower.gas_used << " != " << best_step.gas_used << std::endl;
+			ret = -1;
+		}
+	}
+
+	vnx::close();
+
+	return ret;
+}
@@ -12,12 +12,18 @@ echo "Unit tests [mmx_tests]"
 echo "Unit tests [test_database]"
 ./build/test/test_database
 
+echo "Unit tests [test_block_store]"
+./build/test/test_block_store
+
 echo "Unit tests [vm_engine_tests]"
 ./build/test/vm_engine_tests
 
 echo "Unit tests [vm_storage_tests]"
 ./build/test/vm_storage_tests
 
+echo "Unit tests [vm_optimizer_tests]"
+./build/test/vm_optimizer_tests
+
 ./test/vm/engine_tests.sh
 
 ./test/vm/contract_tests.sh
@@ -10,6 +10,7 @@
 #include <mmx/contract/Executable.hxx>
 #include <mmx/vm/Compiler.h>
 #include <mmx/vm/Engine.h>
+#include <mmx/vm/optimizer.h>
 #include <mmx/vm/StorageRAM.h>
 #include <mmx/vm/StorageCache.h>
 #include <mmx/vm_interface.h>
@@ -41,6 +42,7 @@ int main(int argc, char** argv)
 	options["files"] = "source files";
 	options["output"] = "output name";
 	options["gas"] = "gas limit";
+	options["opt-report"] = "print optimizer stats";
 	options["assert-fail"] = "assert fail";
 
 	vnx::write_config("log_level", 2);
@@ -55,6 +57,7 @@ int main(int argc, char** argv)
 	bool execute = false;
 	bool commit = false;
 	bool assert_fail = false;
+	bool opt_report = false;
 	uint64_t gas_limit = -1;
 	std::string network = "mainnet";
 	std::string output;
@@ -69,6 +72,7 @@ int main(int argc, char** argv)
 	vnx::read_config("files", file_names);
 	vnx::read_config("gas", gas_limit);
 	vnx::read_config("assert-fail", assert_fail);
+	vnx::read_config("opt-report", opt_report);
 
 	flags.verbose = verbose;
 	flags.opt_level = opt_level;
@@ -76,9 +80,9 @@ int main(int argc, char** argv)
 	int ret_value = 0;
 	std::shared_ptr<const contract::Binary> binary;
 
+	std::string source;
 	try {
 		if(file_names.empty()) {
-			std::string source;
 			std::vector<char> buffer(4096);
 			while(std::cin.read(buffer.data(), buffer.size()) || std::cin.gcount() > 0) {
 				const auto bytes_read = std::cin.gcount();
@@ -95,6 +99,21 @@ int main(int argc, char** argv)
 		return 1;
 	}
 
+	if(opt_report) {
+		auto flags_O0 = flags;
+		flags_O0.verbose = 0;
+		flags_O0.opt_level = 0;
+		const auto before = vm::get_code_stats(file_names.empty() ?
+				vm::compile(source, flags_O0) : vm::compile_files(file_names, flags_O0));
+		const auto after = vm::get_code_stats(binary);
+
+		std::cerr << "Optimizer (-O" << opt_level << "):" << std::endl;
+		std::cerr << "  Instructions: " << before.num_instr << " => " << after.num_instr << std::endl;
+		std::cerr << "  Constants:    " << before.num_const << " => " << after.num_const << std::endl;
+		std::cerr << "  Load cost:    " << before.load_cost << " => " << after.load_cost << " (per call)" << std::endl;
+		std::cerr << "  Code cost:    " << before.exec_cost << " => " << after.exec_cost << " (each instruction once)" << std::endl;
+	}
+
 	if(!output.empty()) {
 		if(txmode) {
 			auto tx = Transaction::create();
@@ -8,6 +8,7 @@
 #include <mmx/utils.h>
 #include <mmx/pos/verify.h>
 #include <vnx/vnx.h>
+#include <mutex>
 #include <thread>
 
 #ifdef WITH_CUDA
@@ -81,6 +82,9 @@ int main(int argc, char** argv)
 		x >>= clevel;
 	}
 
+	std::mutex stats_mutex;
+	mmx::pos::compute_stats_t stats;
+
 	std::atomic<int64_t> progress {0};
 	const auto time_begin = mmx::get_time_ms();
 
@@ -91,10 +95,19 @@ int main(int argc, char** argv)
 				return;
 			}
 			std::vector<uint32_t> x_out;
-			const auto entries = mmx::pos::compute(x_values, &x_out, plot_id, 32, clevel);
+			mmx::pos::compute_stats_t tmp;
+			const auto entries = mmx::pos::compute(x_values, &x_out, plot_id, 32, clevel, &tmp);
 			if(entries.empty() || x_out.size() != entries.size() * 256) {
 				throw std::logic_error("invalid proof");
 			}
+			{
+				std::lock_guard<std::mutex> lock(stats_mutex);
+				for(int t = 1; t <= mmx::pos::N_TABLE; ++t) {
+					stats.table_time_us[t] += tmp.table_time_us[t];
+					stats.table_size[t] += tmp.table_size[t];
+				}
+				stats.final_time_us += tmp.final_time_us;
+			}
 			if((progress++) % std::max((num_iter / 100), 1) == 0) {
 				std::cout << ".";
 				std::cout.flush();
@@ -113,6 +126,15 @@ int main(int argc, char** argv)
 	const double proof_time = elapsed_sec / num_iter;
 	std::cout << "Proof time: " << proof_time << " sec (average)" << std::endl;
 
+	if(stats.table_size[1]) {
+		// not filled when using CUDA
+		for(int t = 1; t <= mmx::pos::N_TABLE; ++t) {
+			std::cout << "Table " << t << ": " << stats.table_time_us[t] / 1e3 / num_iter << " ms, "
+					<< stats.table_size[t] / num_iter << " entries (average)" << std::endl;
+		}
+		std::cout << "Final: " << stats.final_time_us / 1e3 / num_iter << " ms (average)" << std::endl;
+	}
+
 	const double max_plots_ssd = 8.0 / proof_time;
 	const double max_plots_hdd = max_plots_ssd * 1024;
 
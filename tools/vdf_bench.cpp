@@ -0,0 +1,120 @@
+/*
+ * vdf_bench.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <mmx/vdf_verifier_t.h>
+#include <mmx/ProofOfTime.hxx>
+#include <mmx/utils.h>
+
+#include <vnx/vnx.h>
+#include <thread>
+
+
+int main(int argc, char** argv)
+{
+	std::map<std::string, std::string> options;
+	options["n"] = "proofs";
+	options["s"] = "segments";
+	options["i"] = "iters";
+	options["r"] = "threads";
+	options["proofs"] = "number of proofs";
+	options["segments"] = "segments per proof";
+	options["iters"] = "iterations per segment";
+	options["threads"] = "number of threads";
+
+	vnx::write_config("log_level", 2);
+
+	vnx::init("vdf_bench", argc, argv, options);
+
+	int num_proofs = 8;
+	int num_segments = 100;
+	int segment_size = 10000;
+	int num_threads = 0;
+
+	vnx::read_config("proofs", num_proofs);
+	vnx::read_config("segments", num_segments);
+	vnx::read_config("iters", segment_size);
+	vnx::read_config("threads", num_threads);
+
+	if(num_threads <= 0) {
+		num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+	num_proofs = std::max(num_proofs, 1);
+	num_segments = std::max(num_segments, 1);
+	segment_size = std::max(segment_size, 1);
+
+	std::cout << "Threads: " << num_threads << std::endl;
+	std::cout << "Proofs: " << num_proofs << " x " << num_segments << " segments x " << segment_size << " iters" << std::endl;
+
+	std::vector<std::shared_ptr<const mmx::ProofOfTime>> proofs(num_proofs);
+	{
+		const auto time_begin = mmx::get_time_ms();
+
+		std::vector<std::thread> threads;
+		for(int i = 0; i < num_proofs; ++i) {
+			threads.emplace_back([&proofs, i, num_segments, segment_size]() {
+				auto proof = mmx::ProofOfTime::create();
+				proof->segment_size = segment_size;
+				proof->input = mmx::hash_t("vdf_bench_" + std::to_string(i));
+				proof->prev = mmx::hash_t("prev");
+
+				auto point = mmx::hash_t(proof->input + proof->prev);
+				point = mmx::hash_t(point + proof->reward_addr);
+				for(int k = 0; k < num_segments; ++k) {
+					for(int j = 0; j < segment_size; ++j) {
+						point = mmx::hash_t(point.bytes);
+					}
+					proof->segments.push_back(point);
+				}
+				proofs[i] = proof;
+			});
+		}
+		for(auto& thread : threads) {
+			thread.join();
+		}
+		std::cout << "Generating proofs took " << (mmx::get_time_ms() - time_begin) / 1e3 << " sec" << std::endl;
+	}
+
+	const auto total_segments = uint64_t(num_proofs) * num_segments;
+
+	for(const bool pipelined : {false, true})
+	{
+		mmx::vdf_verifier_t verifier(num_threads);
+
+		const auto time_begin = mmx::get_time_us();
+		try {
+			if(pipelined) {
+				std::vector<std::future<void>> results;
+				for(const auto& proof : proofs) {
+					results.push_back(verifier.verify_async(proof));
+				}
+				for(auto& result : results) {
+					result.get();
+				}
+			} else {
+				for(const auto& proof : proofs) {
+					verifier.verify(proof);
+				}
+			}
+		} catch(const std::exception& ex) {
+			std::cerr << "Verification failed with: " << ex.what() << std::endl;
+			vnx::close();
+			return -1;
+		}
+		const auto elapsed_us = mmx::get_time_us() - time_begin;
+		const auto stats = verifier.get_stats();
+		const auto rate = total_segments * 1e6 / elapsed_us;
+
+		std::cout << (pipelined ? "[pipelined] " : "[sequential] ")
+				<< "took " << elapsed_us / 1e6 << " sec, " << rate << " segments/sec, "
+				<< rate / num_threads << " segments/sec/core, "
+				<< uint64_t(stats.num_iters * 1e6 / elapsed_us / num_threads) << " iters/sec/core, lane usage "
+				<< stats.get_lane_usage() * 100 << " %" << std::endl;
+	}
+
+	vnx::close();
+
+	return 0;
+}